@@ -29,6 +29,12 @@
 extern "C" {
 #endif
 
+/**
+ * Callback function invoked by the codec thread whenever a new encoded frame
+ * is available.
+ */
+typedef void (*codecCallback_t)(void *arg);
+
 /**
  * Initialise audio codec manager, allocating data buffers.
  *
@@ -43,6 +49,19 @@ void codec_init();
  */
 void codec_terminate();
 
+/**
+ * Register a function to be called, from the codec thread, each time a new
+ * encoded frame is pushed to the internal queue. This allows to wait for the
+ * encoded frames without blocking on codec_popFrame(). The callback can be
+ * changed only when there is no encoding or decoding operation in progress
+ * and it is unregistered by the first call of codec_init().
+ *
+ * @param callback: function to be called, NULL to unregister the current one.
+ * @param arg: argument passed to the callback.
+ * @return true on success, false if an operation is in progress.
+ */
+bool codec_setFrameCallback(const codecCallback_t callback, void *arg);
+
 /**
  * Start encoding of audio data from a given audio source.
  * Only an encoding or decoding operation at a time is possible: in case there
@@ -71,7 +90,9 @@ void codec_stop();
 
 /**
  * Get a compressed audio frame from the internal queue. Each frame is composed
- * of 8 bytes.
+ * of 8 bytes. If the encoder got ahead of the reader, the oldest frames are
+ * discarded and only the latest four are kept; after a long stall the queue
+ * is emptied and the latest frames become available with the next encoded one.
  *
  * @param frame: pointer to a destination buffer where to put the encoded frame.
  * @param blocking: if true the execution flow will be blocked whenever the
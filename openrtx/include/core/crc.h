@@ -28,6 +28,13 @@
 extern "C" {
 #endif
 
+/**
+ * Initial values of the supported CRCs, to be used as starting value for the
+ * incremental computation through the crc_*_update() functions.
+ */
+#define CRC_CCITT_INIT  0x0000
+#define CRC_M17_INIT    0xFFFF
+
 /**
  * Compute the CCITT 16-bit CRC over a given block of data.
  *
@@ -37,6 +44,40 @@ extern "C" {
  */
 uint16_t crc_ccitt(const void *data, const size_t len);
 
+/**
+ * Update a CCITT 16-bit CRC with a new block of data, allowing to compute
+ * the CRC of a data stream incrementally. The CRC value has to be initialised
+ * to CRC_CCITT_INIT.
+ *
+ * @param crc: current CRC value.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return updated CCITT CRC.
+ */
+uint16_t crc_ccitt_update(const uint16_t crc, const void *data, const size_t len);
+
+/**
+ * Compute the M17 16-bit CRC over a given block of data, using the polynomial
+ * 0x5935 with an initial value set to 0xFFFF, as per M17 specification.
+ *
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return M17 CRC.
+ */
+uint16_t crc_m17(const void *data, const size_t len);
+
+/**
+ * Update an M17 16-bit CRC with a new block of data, allowing to compute the
+ * CRC of a data stream incrementally. The CRC value has to be initialised to
+ * CRC_M17_INIT.
+ *
+ * @param crc: current CRC value.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return updated M17 CRC.
+ */
+uint16_t crc_m17_update(const uint16_t crc, const void *data, const size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+
+#ifdef PLATFORM_LINUX
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Free running counter for the measurement of short execution times. On the
+ * Cortex-M targets it is the DWT cycle counter, on Linux it counts nanoseconds
+ * from the monotonic clock. The counter is 32 bit wide and wraps around:
+ * differences between two readings are valid as long as the measured interval
+ * is shorter than the wrap period (about 25s at 168MHz, 4.2s on Linux).
+ */
+
+#ifndef PLATFORM_LINUX
+#define CYCCNT_DEMCR     (*((volatile uint32_t *) 0xE000EDFC))
+#define CYCCNT_DWT_CTRL  (*((volatile uint32_t *) 0xE0001000))
+#define CYCCNT_DWT_CNT   (*((volatile uint32_t *) 0xE0001004))
+#endif
+
+/**
+ * Enable the cycle counter, can be safely called more than once.
+ */
+static inline void cycleCounter_init()
+{
+    #ifndef PLATFORM_LINUX
+    CYCCNT_DEMCR    |= (1 << 24);   // Enable DWT and ITM blocks
+    CYCCNT_DWT_CTRL |= 1;           // Enable cycle counter
+    #endif
+}
+
+/**
+ * Get the current value of the cycle counter.
+ *
+ * @return counter value, in CPU cycles or in nanoseconds on Linux.
+ */
+static inline uint32_t cycleCounter_get()
+{
+    #ifdef PLATFORM_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ((ts.tv_sec * 1000000000ULL) + ts.tv_nsec);
+    #else
+    return CYCCNT_DWT_CNT;
+    #endif
+}
+
+/**
+ * Execution time statistics, in cycle counter units.
+ */
+typedef struct
+{
+    uint32_t last;      ///< Last measure.
+    uint32_t min;       ///< Minimum.
+    uint32_t max;       ///< Maximum.
+    uint64_t total;     ///< Sum of all the measures.
+    uint32_t count;     ///< Number of measures.
+}
+cycleStats_t;
+
+/**
+ * Clear execution time statistics.
+ *
+ * @param stats: pointer to the statistics.
+ */
+static inline void cycleStats_reset(cycleStats_t *stats)
+{
+    stats->last  = 0;
+    stats->min   = UINT32_MAX;
+    stats->max   = 0;
+    stats->total = 0;
+    stats->count = 0;
+}
+
+/**
+ * Add a measure to execution time statistics.
+ *
+ * @param stats: pointer to the statistics.
+ * @param ticks: measured duration, in cycle counter units.
+ */
+static inline void cycleStats_update(cycleStats_t *stats, const uint32_t ticks)
+{
+    stats->last   = ticks;
+    stats->total += ticks;
+    stats->count += 1;
+    if(ticks < stats->min) stats->min = ticks;
+    if(ticks > stats->max) stats->max = ticks;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYCLE_COUNTER_H */
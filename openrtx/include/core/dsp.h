@@ -47,6 +47,17 @@ typedef struct
 }
 filter_state_t;
 
+/**
+ * Data structure holding the internal state of a fixed point filter.
+ */
+typedef struct
+{
+    int32_t u;          // previous input value u(k-1)
+    int32_t y;          // previous output value y(k-1), with 12 fractional bits
+    bool    initialised;  // state variables initialised
+}
+fixed_filter_state_t;
+
 
 /**
  * Reset the filter state variables.
@@ -65,6 +76,106 @@ void dsp_resetFilterState(filter_state_t *state);
  */
 void dsp_dcRemoval(filter_state_t *state, audio_sample_t *buffer, size_t length);
 
+/**
+ * Process a single sample with the DC removal filter of dsp_dcRemoval(), for
+ * the callers fusing it with other per-sample processing.
+ *
+ * @param state: pointer to the data structure containing the filter state.
+ * @param sample: input sample.
+ * @return filtered sample.
+ */
+static inline audio_sample_t dsp_dcRemovalStep(filter_state_t *state,
+                                               audio_sample_t sample)
+{
+    /*
+     * Removal of DC component performed using an high-pass filter with
+     * transfer function G(z) = (z - 1)/(z - 0.999).
+     * Recursive implementation of the filter is:
+     * y(k) = u(k) - u(k-1) + 0.999*y(k-1)
+     *
+     * The first sample after a reset only initialises the filter state.
+     */
+
+    float          u   = (float) sample;
+    float          y   = state->y[1];
+    audio_sample_t out = sample;
+
+    if(state->initialised)
+    {
+        y   = u - state->u[1] + 0.999f * y;
+        out = (audio_sample_t) (y + 0.5f);
+    }
+
+    // State updated unconditionally, allowing to keep it in registers when
+    // the function is called in a loop
+    state->u[1]        = u;
+    state->y[1]        = y;
+    state->initialised = true;
+
+    return out;
+}
+
+/**
+ * Reset the state variables of a fixed point filter.
+ *
+ * @param state: pointer to the data structure containing the filter state.
+ */
+void dsp_resetFixedFilterState(fixed_filter_state_t *state);
+
+/**
+ * Remove the DC offset from a collection of audio samples, processing data
+ * in-place. Fixed point version of dsp_dcRemoval(), using only integer
+ * operations.
+ *
+ * @param state: pointer to the data structure containing the filter state.
+ * @param buffer: buffer containing the audio samples.
+ * @param length: number of samples contained in the buffer.
+ */
+void dsp_dcRemovalFixed(fixed_filter_state_t *state, audio_sample_t *buffer,
+                        size_t length);
+
+/**
+ * Process a single sample with the fixed point DC removal filter of
+ * dsp_dcRemovalFixed(), for the callers fusing it with other per-sample
+ * processing.
+ *
+ * @param state: pointer to the data structure containing the filter state.
+ * @param sample: input sample.
+ * @return filtered sample.
+ */
+static inline audio_sample_t dsp_dcRemovalFixedStep(fixed_filter_state_t *state,
+                                                    audio_sample_t sample)
+{
+    /*
+     * Same high-pass filter of dsp_dcRemoval() with the pole placed at
+     * 1 - 2^-10 (0.99902) instead of 0.999, so that the multiplication by the
+     * feedback coefficient reduces to a shift and a subtraction:
+     * y(k) = u(k) - u(k-1) + y(k-1) - y(k-1)/1024
+     * The output is kept with 12 fractional bits to avoid the accumulation of
+     * rounding errors.
+     */
+
+    int32_t u   = sample;
+    int32_t y   = state->y;
+    int32_t out = sample;
+
+    if(state->initialised)
+    {
+        y   = ((u - state->u) * 4096) + y - (y >> 10);
+        out = (y + 2048) >> 12;
+        if(out > INT16_MAX) out = INT16_MAX;
+        if(out < INT16_MIN) out = INT16_MIN;
+    }
+
+    // State updated unconditionally, allowing to keep it in registers when
+    // the function is called in a loop
+    state->u           = u;
+    state->y           = y;
+    state->initialised = true;
+
+    return (audio_sample_t) out;
+}
+
 /*
  * Inverts the phase of the audio buffer passed as paramenter.
  * The buffer will be processed in place to save memory.
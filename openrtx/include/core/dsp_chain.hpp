@@ -0,0 +1,409 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef DSP_CHAIN_H
+#define DSP_CHAIN_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <interfaces/audio_stream.h>
+#include <cycle_counter.h>
+#include <type_traits>
+#include <fir_q15.hpp>
+#include <cstdint>
+#include <fir.hpp>
+#include <tuple>
+#include <dsp.h>
+
+/*
+ * In-place processing of audio sample blocks through an ordered chain of
+ * stages. Each stage is a stateful per-sample processor:
+ *
+ *  - audio_sample_t operator()(audio_sample_t): process one sample;
+ *  - void reset(): clear the stage state;
+ *  - static const char *name(): stage name, for the statistics.
+ *
+ * The stages are fused: the chain makes a single pass over the block, running
+ * each sample through all the stages. Since every stage only depends on its
+ * own past inputs, the result is the same obtained running the stages one at
+ * a time over the whole block.
+ *
+ * The execution time of each call is measured with the cycle counter. When
+ * DSP_CHAIN_STAGE_PROFILING is defined, the stages are run unfused, one pass
+ * per stage, and the time spent in each stage is measured too.
+ */
+
+/**
+ * Integer gain, with the same wrap-around of a plain multiplication of the
+ * 16 bit samples.
+ */
+class DspGain
+{
+public:
+
+    DspGain(const int16_t gain) : gain(gain) { }
+
+    audio_sample_t operator()(const audio_sample_t sample)
+    {
+        return static_cast< audio_sample_t >(sample * gain);
+    }
+
+    void reset() { }
+
+    static const char *name() { return "gain"; }
+
+private:
+
+    int16_t gain;
+};
+
+/**
+ * Phase inversion, saturating the negative full scale value. Can be enabled
+ * and disabled at runtime.
+ */
+class DspInvert
+{
+public:
+
+    DspInvert(const bool enabled = true) : enabled(enabled) { }
+
+    audio_sample_t operator()(const audio_sample_t sample)
+    {
+        if(enabled == false)
+            return sample;
+
+        return (sample == INT16_MIN) ? INT16_MAX : -sample;
+    }
+
+    void setEnabled(const bool enable) { enabled = enable; }
+
+    void reset() { }
+
+    static const char *name() { return "invert"; }
+
+private:
+
+    bool enabled;
+};
+
+/**
+ * DC removal filter, same as dsp_dcRemoval().
+ */
+class DspDcRemoval
+{
+public:
+
+    DspDcRemoval() { reset(); }
+
+    audio_sample_t operator()(const audio_sample_t sample)
+    {
+        return dsp_dcRemovalStep(&state, sample);
+    }
+
+    void reset() { dsp_resetFilterState(&state); }
+
+    static const char *name() { return "dc_removal"; }
+
+private:
+
+    filter_state_t state;
+};
+
+/**
+ * Fixed point DC removal filter, same as dsp_dcRemovalFixed().
+ */
+class DspDcRemovalFixed
+{
+public:
+
+    DspDcRemovalFixed() { reset(); }
+
+    audio_sample_t operator()(const audio_sample_t sample)
+    {
+        return dsp_dcRemovalFixedStep(&state, sample);
+    }
+
+    void reset() { dsp_resetFixedFilterState(&state); }
+
+    static const char *name() { return "dc_removal_fixed"; }
+
+private:
+
+    fixed_filter_state_t state;
+};
+
+/**
+ * Floating point FIR filter. The phase of the input can be inverted, with the
+ * same result of a -1 gain in the Fir block processing.
+ */
+template < size_t N >
+class DspFir
+{
+public:
+
+    DspFir(const std::array< float, N >& taps) : fir(taps), gain(1.0f) { }
+
+    audio_sample_t operator()(const audio_sample_t sample)
+    {
+        return static_cast< audio_sample_t >(fir(static_cast< float >(sample) * gain));
+    }
+
+    void setInvert(const bool invert) { gain = invert ? -1.0f : 1.0f; }
+
+    void reset() { fir.reset(); }
+
+    static const char *name() { return "fir"; }
+
+private:
+
+    Fir< N > fir;
+    float    gain;
+};
+
+/**
+ * Q15 fixed point FIR filter. The phase of the input can be inverted, with
+ * the same result of the FirQ15 block processing.
+ */
+template < size_t N >
+class DspFirQ15
+{
+public:
+
+    DspFirQ15(const std::array< int16_t, N >& taps) : fir(taps), invert(false) { }
+
+    audio_sample_t operator()(audio_sample_t sample)
+    {
+        return fir(invert(sample));
+    }
+
+    void setInvert(const bool enable) { invert.setEnabled(enable); }
+
+    void reset() { fir.reset(); }
+
+    static const char *name() { return "fir_q15"; }
+
+private:
+
+    FirQ15< N > fir;
+    DspInvert   invert;
+};
+
+/**
+ * Conversion from signed 16 bit to unsigned 12 bit samples, same as
+ * S16toU12().
+ */
+class DspS16toU12
+{
+public:
+
+    audio_sample_t operator()(const audio_sample_t sample)
+    {
+        return static_cast< audio_sample_t >(static_cast< uint16_t >(sample + 32768) >> 4);
+    }
+
+    void reset() { }
+
+    static const char *name() { return "s16_to_u12"; }
+};
+
+/**
+ * Conversion from signed 16 bit to unsigned 8 bit samples, same as S16toU8().
+ */
+class DspS16toU8
+{
+public:
+
+    audio_sample_t operator()(const audio_sample_t sample)
+    {
+        return static_cast< audio_sample_t >(static_cast< uint16_t >(sample + 32768) >> 8);
+    }
+
+    void reset() { }
+
+    static const char *name() { return "s16_to_u8"; }
+};
+
+
+/**
+ * Ordered chain of processing stages, run over the sample blocks provided by
+ * an audio stream.
+ */
+template < typename... Stages >
+class DspChain
+{
+public:
+
+    static constexpr size_t NUM_STAGES = sizeof...(Stages);
+
+    /**
+     * Constructor.
+     *
+     * @param stages: the processing stages, in order of execution.
+     */
+    DspChain(Stages... stages) : stages(stages...)
+    {
+        cycleCounter_init();
+        resetStats();
+    }
+
+    /**
+     * Process a block of samples in-place.
+     *
+     * @param block: block of samples.
+     */
+    void process(dataBlock_t block)
+    {
+        process(block.data, block.data, block.len);
+    }
+
+    /**
+     * Process a block of samples. Input and output buffers can be the same,
+     * in which case data is processed in-place.
+     *
+     * @param input: pointer to the input samples.
+     * @param output: pointer to the buffer where output samples are written.
+     * @param length: number of samples to be processed.
+     */
+    void process(const audio_sample_t *input, audio_sample_t *output,
+                 const size_t length)
+    {
+        uint32_t start = cycleCounter_get();
+
+        #ifdef DSP_CHAIN_STAGE_PROFILING
+        runStage< 0 >(input, output, length);
+        #else
+        for(size_t i = 0; i < length; i++)
+            output[i] = step< 0 >(input[i]);
+        #endif
+
+        cycleStats_update(&chainStats, cycleCounter_get() - start);
+    }
+
+    /**
+     * Access a stage of the chain, for instance to change its parameters.
+     *
+     * @return a reference to the I-th stage.
+     */
+    template < size_t I >
+    typename std::tuple_element< I, std::tuple< Stages... > >::type& stage()
+    {
+        return std::get< I >(stages);
+    }
+
+    /**
+     * Reset the state of all the stages.
+     */
+    void reset()
+    {
+        resetStage< 0 >();
+    }
+
+    /**
+     * @return execution time statistics of the whole chain.
+     */
+    const cycleStats_t& getStats()
+    {
+        return chainStats;
+    }
+
+    /**
+     * Get the execution time statistics of a stage, available only when
+     * DSP_CHAIN_STAGE_PROFILING is defined.
+     *
+     * @param index: stage index.
+     * @return execution time statistics of the stage.
+     */
+    const cycleStats_t& getStageStats(const size_t index)
+    {
+        return stageStats[index];
+    }
+
+    /**
+     * @param index: stage index.
+     * @return name of the stage.
+     */
+    static const char *stageName(const size_t index)
+    {
+        static const char *names[] = { Stages::name()... };
+        return names[index];
+    }
+
+    /**
+     * Clear the execution time statistics.
+     */
+    void resetStats()
+    {
+        cycleStats_reset(&chainStats);
+        for(auto& s : stageStats)
+            cycleStats_reset(&s);
+    }
+
+private:
+
+    template < size_t I >
+    typename std::enable_if< (I < NUM_STAGES), audio_sample_t >::type
+    step(const audio_sample_t sample)
+    {
+        return step< I + 1 >(std::get< I >(stages)(sample));
+    }
+
+    template < size_t I >
+    typename std::enable_if< (I == NUM_STAGES), audio_sample_t >::type
+    step(const audio_sample_t sample)
+    {
+        return sample;
+    }
+
+    template < size_t I >
+    typename std::enable_if< (I < NUM_STAGES) >::type
+    runStage(const audio_sample_t *input, audio_sample_t *output,
+             const size_t length)
+    {
+        uint32_t start = cycleCounter_get();
+
+        for(size_t i = 0; i < length; i++)
+            output[i] = std::get< I >(stages)(input[i]);
+
+        cycleStats_update(&stageStats[I], cycleCounter_get() - start);
+        runStage< I + 1 >(output, output, length);
+    }
+
+    template < size_t I >
+    typename std::enable_if< (I == NUM_STAGES) >::type
+    runStage(const audio_sample_t *, audio_sample_t *, const size_t) { }
+
+    template < size_t I >
+    typename std::enable_if< (I < NUM_STAGES) >::type resetStage()
+    {
+        std::get< I >(stages).reset();
+        resetStage< I + 1 >();
+    }
+
+    template < size_t I >
+    typename std::enable_if< (I == NUM_STAGES) >::type resetStage() { }
+
+    std::tuple< Stages... > stages;                  ///< Processing stages.
+    cycleStats_t            chainStats;              ///< Whole chain statistics.
+    cycleStats_t            stageStats[NUM_STAGES];  ///< Per stage statistics.
+};
+
+#endif /* DSP_CHAIN_H */
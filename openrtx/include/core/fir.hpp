@@ -32,6 +32,12 @@
 /**
  * Class for FIR filter with configurable coefficients.
  * Adapted from the original implementation by Rob Riggs, Mobilinkd LLC.
+ *
+ * The history of past inputs is kept in a mirrored buffer twice the length of
+ * the filter: each new sample is stored both at the current position and N
+ * elements after it. In this way the last N inputs are always available as a
+ * contiguous array, ordered from the newest to the oldest one, and the filter
+ * output is computed as a plain dot product without any index wrapping.
  */
 template < size_t N >
 class Fir
@@ -63,21 +69,39 @@ public:
      */
     float operator()(const float& input)
     {
-        hist[pos] = input;
-        pos = (pos + 1) % N;
+        pos = (pos != 0 ? pos - 1 : N - 1);
+        hist[pos]     = input;
+        hist[pos + N] = input;
 
-        float  result = 0.0;
-        size_t index  = pos;
+        const float *h = &hist[pos];
+        float result   = 0.0;
 
         for(size_t i = 0; i < N; i++)
-        {
-            index   = (index != 0 ? index - 1 : N - 1);
-            result += hist[index] * taps[i];
-        }
+            result += h[i] * taps[i];
 
         return result;
     }
 
+    /**
+     * Filter a block of samples. Input and output buffers can be the same, in
+     * which case data is processed in-place.
+     *
+     * @param input: pointer to the input samples.
+     * @param output: pointer to the buffer where output samples are written.
+     * @param length: number of samples to be processed.
+     * @param gain: gain applied to the input samples before filtering.
+     */
+    template < typename T >
+    void operator()(const T *input, T *output, const size_t length,
+                    const float gain = 1.0f)
+    {
+        for(size_t i = 0; i < length; i++)
+        {
+            float elem = static_cast< float >(input[i]) * gain;
+            output[i]  = static_cast< T >((*this)(elem));
+        }
+    }
+
     /**
      * Reset FIR history, clearing the memory of past values.
      */
@@ -90,8 +114,120 @@ public:
 private:
 
     const std::array< float, N >& taps;    ///< FIR filter coefficients.
-    std::array< float, N >        hist;    ///< History of past inputs.
-    size_t                        pos;     ///< Current position in history.
+    std::array< float, 2 * N >    hist;    ///< Mirrored history of past inputs.
+    size_t                        pos;     ///< Position of the newest input.
+};
+
+/**
+ * Class for interpolating FIR filter, in polyphase form. The filter upsamples
+ * the input by an integer factor L, computing L output values for each input
+ * value. The output is the same obtained by inserting L - 1 zeroes between
+ * each input sample and then filtering the result with a standard FIR, but
+ * the multiplications by the zero-valued samples are skipped.
+ *
+ * The filter coefficients are split in L branches, the i-th branch contains
+ * the coefficients i, i + L, i + 2L, ... and generates the i-th output sample
+ * of each group. Branches shorter than the others are padded with zeroes.
+ */
+template < size_t N, size_t L >
+class FirInterpolator
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param taps: reference to a std::array of floating poing values representing
+     * the coefficients of the equivalent FIR filter at the output sample rate.
+     */
+    FirInterpolator(const std::array< float, N >& taps) : pos(0)
+    {
+        for(size_t i = 0; i < L; i++)
+        {
+            for(size_t j = 0; j < P; j++)
+            {
+                size_t tap = i + (j * L);
+                branches[(i * P) + j] = (tap < N) ? taps[tap] : 0.0f;
+            }
+        }
+
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~FirInterpolator() { }
+
+    /**
+     * Perform one step of the interpolating filter, computing L new output
+     * values given the input value and the history of previous input values.
+     *
+     * @param input: input value for the current time step.
+     * @param output: pointer to a buffer of L elements where to store the
+     * output values.
+     */
+    void operator()(const float& input, float *output)
+    {
+        pos = (pos != 0 ? pos - 1 : P - 1);
+        hist[pos]     = input;
+        hist[pos + P] = input;
+
+        const float *h = &hist[pos];
+
+        for(size_t i = 0; i < L; i++)
+        {
+            const float *t = &branches[i * P];
+            float result   = 0.0;
+
+            for(size_t j = 0; j < P; j++)
+                result += h[j] * t[j];
+
+            output[i] = result;
+        }
+    }
+
+    /**
+     * Interpolate a block of samples. The output buffer must be able to hold
+     * L times the number of input samples.
+     *
+     * @param input: pointer to the input samples.
+     * @param output: pointer to the buffer where output samples are written.
+     * @param length: number of input samples to be processed.
+     * @param gain: gain applied to the input samples before filtering.
+     */
+    template < typename T >
+    void operator()(const T *input, T *output, const size_t length,
+                    const float gain = 1.0f)
+    {
+        std::array< float, L > out;
+
+        for(size_t i = 0; i < length; i++)
+        {
+            float elem = static_cast< float >(input[i]) * gain;
+            (*this)(elem, out.data());
+
+            for(size_t j = 0; j < L; j++)
+                output[(i * L) + j] = static_cast< T >(out[j]);
+        }
+    }
+
+    /**
+     * Reset filter history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        hist.fill(0);
+        pos = 0;
+    }
+
+private:
+
+    static constexpr size_t P = (N + L - 1) / L;    ///< Taps per branch.
+
+    std::array< float, L * P > branches;    ///< Polyphase filter coefficients.
+    std::array< float, 2 * P > hist;        ///< Mirrored history of past inputs.
+    size_t                     pos;         ///< Position of the newest input.
 };
 
 #endif /* DSP_H */
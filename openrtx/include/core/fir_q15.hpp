@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef FIR_Q15_H
+#define FIR_Q15_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+/*
+ * On Cortex-M cores with the DSP extension the dot product is computed with
+ * the SMLAD dual multiply-accumulate instruction, the CMSIS intrinsics are
+ * pulled in by the device header included by hwconfig.h.
+ */
+#if defined(__ARM_FEATURE_DSP)
+#include <hwconfig.h>
+#endif
+
+/**
+ * Convert a floating point value to Q15 fixed point format, with rounding
+ * and saturation to the [-1, 1) range.
+ *
+ * @param value: floating point value.
+ * @return value in Q15 format.
+ */
+constexpr int16_t floatToQ15(const float value)
+{
+    return (value >=  1.0f) ? INT16_MAX :
+           (value <= -1.0f) ? INT16_MIN :
+           static_cast< int16_t >(value * 32768.0f + ((value < 0.0f) ? -0.5f : 0.5f));
+}
+
+template < size_t N, size_t... I >
+constexpr std::array< int16_t, sizeof...(I) >
+makeQ15Taps(const std::array< float, N >& taps, std::index_sequence< I... >)
+{
+    return {{ ((I < N) ? floatToQ15(taps[I]) : static_cast< int16_t >(0))... }};
+}
+
+/**
+ * Convert, at compile time, a set of floating point FIR coefficients to Q15
+ * format. The coefficient array is padded with a zero to an even length, as
+ * required by the Q15 FIR filter implementation.
+ *
+ * @param taps: floating point FIR coefficients.
+ * @return std::array containing the Q15 FIR coefficients.
+ */
+template < size_t N >
+constexpr std::array< int16_t, N + (N % 2) >
+q15Taps(const std::array< float, N >& taps)
+{
+    return makeQ15Taps(taps, std::make_index_sequence< N + (N % 2) >{});
+}
+
+/**
+ * Class for FIR filter operating on 16 bit integer samples with coefficients
+ * in Q15 format. Products are accumulated on 32 bit, the output is rounded and
+ * saturated to 16 bit. The sum of the absolute values of the coefficients must
+ * not exceed 2.0 to guarantee the absence of overflows in the accumulator.
+ *
+ * Like the floating point version, the history is kept in a mirrored buffer.
+ * The result is the same on all the platforms: on Cortex-M4 the dot product
+ * uses the SMLAD instruction, elsewhere a portable C++ implementation is used.
+ */
+template < size_t N >
+class FirQ15
+{
+    static_assert((N % 2) == 0, "Number of taps of Q15 FIR must be even");
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param taps: reference to a std::array of Q15 values representing the
+     * FIR filter coefficients.
+     */
+    FirQ15(const std::array< int16_t, N >& taps) : taps(taps), pos(0)
+    {
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~FirQ15() { }
+
+    /**
+     * Perform one step of the FIR filter, computing a new output value given
+     * the input value and the history of previous input values.
+     *
+     * @param input: FIR input value for the current time step.
+     * @return FIR output as a function of the current and past input values.
+     */
+    int16_t operator()(const int16_t input)
+    {
+        pos = (pos != 0 ? pos - 1 : N - 1);
+        hist[pos]     = input;
+        hist[pos + N] = input;
+
+        int32_t acc = dotProduct(&hist[pos], taps.data());
+        acc = (acc + (1 << 14)) >> 15;
+
+        if(acc > INT16_MAX) return INT16_MAX;
+        if(acc < INT16_MIN) return INT16_MIN;
+        return static_cast< int16_t >(acc);
+    }
+
+    /**
+     * Filter a block of samples. Input and output buffers can be the same, in
+     * which case data is processed in-place.
+     *
+     * @param input: pointer to the input samples.
+     * @param output: pointer to the buffer where output samples are written.
+     * @param length: number of samples to be processed.
+     * @param invert: if true, the input samples are inverted before filtering.
+     */
+    void operator()(const int16_t *input, int16_t *output, const size_t length,
+                    const bool invert = false)
+    {
+        for(size_t i = 0; i < length; i++)
+        {
+            int16_t elem = input[i];
+            if(invert) elem = (elem == INT16_MIN) ? INT16_MAX : -elem;
+            output[i] = (*this)(elem);
+        }
+    }
+
+    /**
+     * Reset FIR history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        hist.fill(0);
+        pos = 0;
+    }
+
+private:
+
+    /**
+     * Compute the dot product between the history and the filter coefficients,
+     * processing two elements at a time.
+     *
+     * @param x: pointer to the first element of the history.
+     * @param y: pointer to the filter coefficients.
+     * @return dot product, on 32 bit.
+     */
+    static inline int32_t dotProduct(const int16_t *x, const int16_t *y)
+    {
+        #if defined(__ARM_FEATURE_DSP)
+        uint32_t acc = 0;
+        for(size_t i = 0; i < N; i += 2)
+        {
+            uint32_t a, b;
+            memcpy(&a, &x[i], sizeof(uint32_t));
+            memcpy(&b, &y[i], sizeof(uint32_t));
+            acc = __SMLAD(a, b, acc);
+        }
+
+        return static_cast< int32_t >(acc);
+        #else
+        int32_t acc = 0;
+        for(size_t i = 0; i < N; i += 2)
+        {
+            acc += (static_cast< int32_t >(x[i])     * y[i])
+                 + (static_cast< int32_t >(x[i + 1]) * y[i + 1]);
+        }
+
+        return acc;
+        #endif
+    }
+
+    const std::array< int16_t, N >& taps;    ///< FIR filter coefficients.
+    std::array< int16_t, 2 * N >    hist;    ///< Mirrored history of past inputs.
+    size_t                          pos;     ///< Position of the newest input.
+};
+
+#endif /* FIR_Q15_H */
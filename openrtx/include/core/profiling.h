@@ -0,0 +1,199 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <cycle_counter.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Execution time profiling of the periodic tasks of the firmware.
+ *
+ * Each probe collects, in statically allocated storage, the minimum, average
+ * and maximum duration of the code it measures together with a coarse
+ * histogram of the durations. Times are measured with the cycle counter, so
+ * they are in CPU cycles on the Cortex-M targets and in nanoseconds on Linux.
+ *
+ * A probe must be updated by a single thread, while its statistics can be read
+ * from any thread.
+ *
+ * Profiling is compiled in only when ENABLE_PROFILING is defined, otherwise
+ * the probe macros expand to nothing and the functions are empty.
+ */
+
+#define PROFILING_HIST_BINS  8      ///< Number of histogram bins
+
+/**
+ * Profiling probes.
+ */
+enum ProfilingProbe
+{
+    PROF_RTX_TASK      = 0,         ///< rtx_task(), up to the OpMode update
+    PROF_M17_DEMOD     = 1,         ///< M17Demodulator::update(), data wait excluded
+    PROF_CODEC2_ENCODE = 2,         ///< codec2_encode()
+    PROF_CODEC2_DECODE = 3,         ///< codec2_decode()
+    PROF_UI_UPDATE     = 4,         ///< ui_updateGUI()
+    PROF_GFX_RENDER    = 5,         ///< gfx_render()
+    PROF_STATE_TASK    = 6,         ///< state_task()
+    PROF_RTX_LATENCY   = 7,         ///< RTX task wakeup latency
+    PROF_NUM_PROBES
+};
+
+/**
+ * Execution time statistics of a probe, in cycle counter units. Bin i of the
+ * histogram counts the durations between 4^i and 4^(i+1) microseconds, the
+ * first and last bin include all the shorter and longer ones respectively.
+ */
+typedef struct
+{
+    cycleStats_t time;                          ///< Execution time
+    uint32_t     hist[PROFILING_HIST_BINS];     ///< Duration histogram
+}
+profStats_t;
+
+#ifdef ENABLE_PROFILING
+
+/**
+ * Initialise the profiling, enabling the cycle counter.
+ */
+void profiling_init();
+
+/**
+ * Add a measure to the statistics of a probe.
+ *
+ * @param probe: probe identifier.
+ * @param ticks: measured duration, in cycle counter units.
+ */
+void profiling_record(const uint8_t probe, const uint32_t ticks);
+
+/**
+ * Get a consistent copy of the statistics of a probe.
+ *
+ * @param probe: probe identifier.
+ * @param stats: pointer to the destination structure.
+ * @return false if the probe identifier is not valid.
+ */
+bool profiling_getStats(const uint8_t probe, profStats_t *stats);
+
+/**
+ * Clear the statistics of all the probes. The statistics of each probe are
+ * actually cleared by its next measure.
+ */
+void profiling_reset();
+
+/**
+ * @param probe: probe identifier.
+ * @return name of the probe.
+ */
+const char *profiling_probeName(const uint8_t probe);
+
+/**
+ * @return number of cycle counter units in one microsecond.
+ */
+uint32_t profiling_ticksPerUs();
+
+/**
+ * Start the measure of a probe, within the current scope.
+ */
+#define PROFILE_BEGIN(probe) \
+    const uint32_t _prof_start_##probe = cycleCounter_get()
+
+/**
+ * End the measure of a probe started with PROFILE_BEGIN in the same scope.
+ */
+#define PROFILE_END(probe) \
+    profiling_record((probe), cycleCounter_get() - _prof_start_##probe)
+
+#else
+
+static inline void profiling_init() { }
+
+static inline void profiling_record(const uint8_t probe, const uint32_t ticks)
+{
+    (void) probe;
+    (void) ticks;
+}
+
+static inline bool profiling_getStats(const uint8_t probe, profStats_t *stats)
+{
+    (void) probe;
+    (void) stats;
+
+    return false;
+}
+
+static inline void profiling_reset() { }
+
+static inline const char *profiling_probeName(const uint8_t probe)
+{
+    (void) probe;
+
+    return "";
+}
+
+static inline uint32_t profiling_ticksPerUs()
+{
+    return 1;
+}
+
+#define PROFILE_BEGIN(probe) do { } while(0)
+#define PROFILE_END(probe)   do { } while(0)
+
+#endif /* ENABLE_PROFILING */
+
+#ifdef __cplusplus
+}
+
+/**
+ * Measure the execution time of the enclosing scope.
+ */
+#ifdef ENABLE_PROFILING
+class ProfileScope
+{
+public:
+
+    ProfileScope(const uint8_t probe) : probe(probe), start(cycleCounter_get())
+    { }
+
+    ~ProfileScope()
+    {
+        profiling_record(probe, cycleCounter_get() - start);
+    }
+
+private:
+
+    const uint8_t  probe;
+    const uint32_t start;
+};
+
+#define PROFILE_SCOPE(probe) ProfileScope _prof_scope_##probe(probe)
+#else
+#define PROFILE_SCOPE(probe) do { } while(0)
+#endif /* ENABLE_PROFILING */
+
+#endif /* __cplusplus */
+
+#endif /* PROFILING_H */
@@ -27,6 +27,9 @@
 
 #include <pthread.h>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <wait_hook.h>
 
 /**
  * Class implementing a statically allocated circular buffer with blocking and
@@ -80,7 +83,9 @@ public:
         // The call is blocking: wait until there is some free space
         while(numElements >= N)
         {
+            waitHook_begin(&writerWait);
             pthread_cond_wait(&not_full, &mutex);
+            waitHook_end(&writerWait);
         }
 
         // There is free space, push data into the queue
@@ -88,7 +93,11 @@ public:
         writePos = (writePos + 1) % N;
 
         // Signal that the queue is not empty
-        if(numElements == 0) pthread_cond_signal(&not_empty);
+        if(numElements == 0)
+        {
+            waitHook_end(&readerWait);
+            pthread_cond_signal(&not_empty);
+        }
         numElements += 1;
 
         pthread_mutex_unlock(&mutex);
@@ -118,7 +127,9 @@ public:
         // The call is blocking: wait until there is something into the queue
         while(numElements == 0)
         {
+            waitHook_begin(&readerWait);
             pthread_cond_wait(&not_empty, &mutex);
+            waitHook_end(&readerWait);
         }
 
         // At least one element present pop one.
@@ -126,7 +137,7 @@ public:
         readPos = (readPos + 1) % N;
 
         // Signal that the queue is no more full
-        if(numElements >= N) pthread_cond_signal(&not_full);
+        if(numElements >= N) wakeWriter();
         numElements -= 1;
 
         pthread_mutex_unlock(&mutex);
@@ -141,7 +152,11 @@ public:
      */
     bool empty()
     {
-        return numElements == 0;
+        pthread_mutex_lock(&mutex);
+        bool isEmpty = (numElements == 0);
+        pthread_mutex_unlock(&mutex);
+
+        return isEmpty;
     }
 
     /**
@@ -151,7 +166,11 @@ public:
      */
     bool full()
     {
-        return numElements >= N;
+        pthread_mutex_lock(&mutex);
+        bool isFull = (numElements >= N);
+        pthread_mutex_unlock(&mutex);
+
+        return isFull;
     }
 
     /**
@@ -161,15 +180,19 @@ public:
      */
     void eraseElement()
     {
-        // Nothing to erase
-        if(numElements == 0) return;
-
         pthread_mutex_lock(&mutex);
 
+        // Nothing to erase
+        if(numElements == 0)
+        {
+            pthread_mutex_unlock(&mutex);
+            return;
+        }
+
         // Chomp away one element just by advancing the read pointer.
         readPos = (readPos + 1) % N;
 
-        if(numElements >= N) pthread_cond_signal(&not_full);
+        if(numElements >= N) wakeWriter();
         numElements -= 1;
 
         pthread_mutex_unlock(&mutex);
@@ -177,6 +200,15 @@ public:
 
 private:
 
+    /**
+     * Wake up a thread waiting to push data, to be called with the mutex held.
+     */
+    void wakeWriter()
+    {
+        waitHook_end(&writerWait);
+        pthread_cond_signal(&not_full);
+    }
+
     size_t readPos;      ///< Read pointer.
     size_t writePos;     ///< Write pointer.
     size_t numElements;  ///< Number of elements currently present.
@@ -185,6 +217,285 @@ private:
     pthread_mutex_t mutex;      ///< Mutex for concurrent access.
     pthread_cond_t  not_empty;  ///< Queue not empty condition.
     pthread_cond_t  not_full;   ///< Queue not full condition.
+    waitHook_t      readerWait = {};  ///< Platform wait marker, consumer.
+    waitHook_t      writerWait = {};  ///< Platform wait marker, producer.
+};
+
+/**
+ * Lock-free circular buffer for a single producer and a single consumer
+ * thread, with the same interface of RingBuffer. Read and write positions are
+ * exchanged with acquire/release semantics, so the non-blocking calls never
+ * take a lock. The blocking calls sleep on a condition variable only when the
+ * buffer is empty or full, and the other side signals it only when a thread is
+ * actually waiting.
+ *
+ * push(), pushN() are to be called only by the producer thread, pop(), popN()
+ * and eraseElement() only by the consumer thread.
+ */
+template < typename T, size_t N >
+class SPSCRingBuffer
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    SPSCRingBuffer() : readPos(0), writePos(0), readerWaiting(false),
+                       writerWaiting(false)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&not_empty, NULL);
+        pthread_cond_init(&not_full, NULL);
+    }
+
+    /**
+     * Destructor.
+     */
+    ~SPSCRingBuffer()
+    {
+        pthread_mutex_destroy(&mutex);
+        pthread_cond_destroy(&not_empty);
+        pthread_cond_destroy(&not_full);
+    }
+
+    /**
+     * Push an element to the buffer.
+     *
+     * @param elem: element to be pushed.
+     * @param blocking: if set to true, when the buffer is full this function
+     * blocks the execution flow until at least one empty slot is available.
+     * @return true if the element has been successfully pushed to the queue,
+     * false if the queue is full.
+     */
+    bool push(const T& elem, bool blocking)
+    {
+        return pushN(&elem, 1, blocking) == 1;
+    }
+
+    /**
+     * Push a batch of elements to the buffer, publishing them to the consumer
+     * all at once.
+     *
+     * @param elems: elements to be pushed.
+     * @param count: number of elements to be pushed.
+     * @param blocking: if set to true, this function blocks the execution flow
+     * until all the elements have been pushed.
+     * @return number of elements pushed.
+     */
+    size_t pushN(const T *elems, const size_t count, bool blocking)
+    {
+        size_t pushed = 0;
+
+        while(pushed < count)
+        {
+            size_t wr    = writePos.load(std::memory_order_relaxed);
+            size_t rd    = readPos.load(std::memory_order_acquire);
+            size_t space = N - distance(rd, wr);
+
+            if(space == 0)
+            {
+                if(blocking == false) break;
+                waitFor(writerWaiting, not_full, [&]
+                {
+                    return distance(readPos.load(std::memory_order_acquire), wr) < N;
+                });
+                continue;
+            }
+
+            size_t num = count - pushed;
+            if(num > space) num = space;
+
+            size_t idx = index(wr);
+            for(size_t i = 0; i < num; i++)
+            {
+                data[idx] = elems[pushed + i];
+                if(++idx >= N) idx = 0;
+            }
+
+            writePos.store(advance(wr, num), std::memory_order_release);
+            wake(readerWaiting, not_empty);
+            pushed += num;
+        }
+
+        return pushed;
+    }
+
+    /**
+     * Pop an element from the buffer.
+     *
+     * @param elem: place where to store the popped element.
+     * @param blocking: if set to true, when the buffer is empty this function
+     * blocks the execution flow until at least one element is available.
+     * @return true if the element has been successfully popped from the queue,
+     * false if the queue is empty.
+     */
+    bool pop(T& elem, bool blocking)
+    {
+        return popN(&elem, 1, blocking) == 1;
+    }
+
+    /**
+     * Pop a batch of elements from the buffer, releasing their slots to the
+     * producer all at once.
+     *
+     * @param elems: place where to store the popped elements.
+     * @param count: maximum number of elements to be popped.
+     * @param blocking: if set to true, when the buffer is empty this function
+     * blocks the execution flow until at least one element is available.
+     * @return number of elements popped.
+     */
+    size_t popN(T *elems, const size_t count, bool blocking)
+    {
+        size_t rd    = readPos.load(std::memory_order_relaxed);
+        size_t avail = distance(rd, writePos.load(std::memory_order_acquire));
+
+        if((avail == 0) && (count > 0))
+        {
+            if(blocking == false) return 0;
+            waitFor(readerWaiting, not_empty, [&]
+            {
+                return writePos.load(std::memory_order_acquire) != rd;
+            });
+            avail = distance(rd, writePos.load(std::memory_order_acquire));
+        }
+
+        size_t num = (count < avail) ? count : avail;
+        size_t idx = index(rd);
+        for(size_t i = 0; i < num; i++)
+        {
+            elems[i] = data[idx];
+            if(++idx >= N) idx = 0;
+        }
+
+        readPos.store(advance(rd, num), std::memory_order_release);
+        wake(writerWaiting, not_full);
+
+        return num;
+    }
+
+    /**
+     * Check if the buffer is empty.
+     *
+     * @return true if the buffer is empty.
+     */
+    bool empty()
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Check if the buffer is full.
+     *
+     * @return true if the buffer is full.
+     */
+    bool full()
+    {
+        return size() >= N;
+    }
+
+    /**
+     * @return number of elements currently present.
+     */
+    size_t size()
+    {
+        return distance(readPos.load(std::memory_order_acquire),
+                        writePos.load(std::memory_order_acquire));
+    }
+
+    /**
+     * Discard one element from the buffer's tail, creating a new empty slot.
+     * In case the buffer is full calling this function unlocks the eventual
+     * thread waiting to push data.
+     */
+    void eraseElement()
+    {
+        size_t rd = readPos.load(std::memory_order_relaxed);
+        if(rd == writePos.load(std::memory_order_acquire)) return;
+
+        readPos.store(advance(rd, 1), std::memory_order_release);
+        wake(writerWaiting, not_full);
+    }
+
+private:
+
+    // Positions run over [0, 2N) to tell a full buffer from an empty one
+    static size_t advance(const size_t pos, const size_t n)
+    {
+        size_t next = pos + n;
+        return (next >= 2 * N) ? (next - 2 * N) : next;
+    }
+
+    static size_t distance(const size_t from, const size_t to)
+    {
+        return (to >= from) ? (to - from) : (to + 2 * N - from);
+    }
+
+    static size_t index(const size_t pos)
+    {
+        return (pos >= N) ? (pos - N) : pos;
+    }
+
+    /**
+     * Sleep on a condition variable until the given predicate becomes true.
+     * The waiting flag is set before checking the predicate, so that the
+     * other side either sees the flag or the waiter sees the update.
+     */
+    template < typename P >
+    void waitFor(std::atomic_bool& waiting, pthread_cond_t& cond, P ready)
+    {
+        pthread_mutex_lock(&mutex);
+
+        while(true)
+        {
+            waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(ready()) break;
+
+            waitHook_begin(waitHook(cond));
+            pthread_cond_wait(&cond, &mutex);
+            waitHook_end(waitHook(cond));
+        }
+
+        waiting.store(false, std::memory_order_relaxed);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    /**
+     * Wake up the thread on the other side, if it is waiting. The flag is
+     * cleared here, so that a sleeping thread is signalled only once.
+     */
+    void wake(std::atomic_bool& waiting, pthread_cond_t& cond)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiting.load(std::memory_order_relaxed) == false)
+            return;
+
+        pthread_mutex_lock(&mutex);
+        waiting.store(false, std::memory_order_relaxed);
+        waitHook_end(waitHook(cond));
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    /**
+     * @return the platform marker of the waits on a condition variable.
+     */
+    waitHook_t *waitHook(const pthread_cond_t& cond)
+    {
+        return (&cond == &not_empty) ? &readerWait : &writerWait;
+    }
+
+    std::atomic< size_t > readPos;       ///< Read position, owned by the consumer.
+    std::atomic< size_t > writePos;      ///< Write position, owned by the producer.
+    std::atomic_bool      readerWaiting; ///< Consumer sleeping on not_empty.
+    std::atomic_bool      writerWaiting; ///< Producer sleeping on not_full.
+    T                     data[N];       ///< Data storage.
+
+    pthread_mutex_t mutex;      ///< Mutex for the blocking calls.
+    pthread_cond_t  not_empty;  ///< Queue not empty condition.
+    pthread_cond_t  not_full;   ///< Queue not full condition.
+    waitHook_t      readerWait = {};  ///< Platform wait marker, consumer.
+    waitHook_t      writerWait = {};  ///< Platform wait marker, producer.
 };
 
 #endif  // RINGBUF_H
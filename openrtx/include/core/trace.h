@@ -0,0 +1,228 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Binary event tracing, for the debug of the time critical code paths.
+ *
+ * Each thread writes fixed size, timestamped records into its own circular
+ * buffer without taking any lock, always overwriting the oldest records. The
+ * buffers can then be dumped in bulk, as a binary stream made of a header
+ * followed by the records, to be converted to CSV on the host with the
+ * scripts/trace_decode.py tool. Timestamps come from the cycle counter.
+ *
+ * Tracing is compiled in only when ENABLE_TRACE is defined, otherwise all the
+ * functions are empty and the TRACE() macro expands to nothing. When compiled
+ * in, it is switched on and off at runtime and it is off at boot, unless
+ * TRACE_AT_BOOT is defined too. A trigger event can be set to stop
+ * tracing a given number of records after its occurrence, preserving what
+ * happened around it until the buffers are dumped by trace_task().
+ */
+
+#ifndef TRACE_THREADS
+#define TRACE_THREADS    4          ///< Maximum number of threads tracing at once
+#endif
+
+#ifndef TRACE_RING_SIZE
+#ifdef PLATFORM_LINUX
+#define TRACE_RING_SIZE  65536      ///< Records per thread
+#else
+#define TRACE_RING_SIZE  256        ///< Records per thread
+#endif
+#endif
+
+#define TRACE_MAGIC      0x43525452 ///< "RTRC", little endian
+#define TRACE_VERSION    1
+
+/**
+ * Trace event identifiers, the meaning of the arguments is given for each
+ * event.
+ */
+enum TraceEvent
+{
+    TRACE_NONE             = 0,
+    TRACE_M17_CORRELATION  = 1,     ///< Sample index, sample, correlation
+    TRACE_M17_SYNC         = 2,     ///< Sample index, correlation, LSF flag
+    TRACE_M17_SWEEP        = 3,     ///< Sample index, sample, correlation
+    TRACE_M17_SYMBOL       = 4,     ///< Sample index, sample, symbol | frame index << 8
+    TRACE_M17_THRESHOLDS   = 5,     ///< Sample index, positive and negative threshold
+    TRACE_M17_TIMING       = 6,     ///< Sample index, timing error, phase correction
+    TRACE_M17_LOCK         = 7,     ///< Phase, stream and LSF syncword Hamming distance
+    TRACE_M17_UNLOCK       = 8,     ///< Phase, stream and LSF syncword Hamming distance
+    TRACE_M17_FRAME        = 9      ///< Phase, stream and LSF syncword Hamming distance
+};
+
+/**
+ * Trace record, 16 bytes.
+ */
+typedef struct
+{
+    uint32_t time;                  ///< Cycle counter value
+    uint8_t  event;                 ///< Event identifier
+    uint8_t  thread;                ///< Index of the thread buffer
+    int16_t  arg0;
+    int32_t  arg1;
+    int32_t  arg2;
+}
+traceRecord_t;
+
+/**
+ * Header of a trace dump, followed by numRecords records. Records of the same
+ * thread are in chronological order.
+ */
+typedef struct
+{
+    uint32_t magic;                 ///< TRACE_MAGIC
+    uint16_t version;               ///< TRACE_VERSION
+    uint16_t recordSize;            ///< Size of a record, in bytes
+    uint32_t timeBase;              ///< Cycle counter frequency, in Hz
+    uint32_t dumpTime;              ///< Cycle counter value at dump time
+    uint32_t numRecords;            ///< Number of records in the dump
+    uint32_t dropped;               ///< Records lost, no buffer available
+}
+traceHeader_t;
+
+/**
+ * Function writing a block of data of a trace dump.
+ *
+ * @param data: data to be written.
+ * @param len: data length, in bytes.
+ * @param arg: user defined argument, given to trace_dump().
+ * @return false in case of error, stopping the dump.
+ */
+typedef bool (*traceWrite_t)(const void *data, const size_t len, void *arg);
+
+#ifdef ENABLE_TRACE
+
+/**
+ * Add a record to the trace buffer of the calling thread, if tracing is
+ * enabled. The first call from a thread assigns it a buffer: when all of them
+ * are taken the record is dropped. On Linux the buffer is released when the
+ * thread terminates: it keeps its records and it is assigned to another
+ * thread only after tracing is restarted. On the other targets it is kept
+ * forever.
+ *
+ * @param event: event identifier.
+ * @param arg0, arg1, arg2: event arguments.
+ */
+void trace_record(const uint8_t event, const int16_t arg0, const int32_t arg1,
+                  const int32_t arg2);
+
+/**
+ * Enable or disable tracing. Enabling the tracing clears the buffers and
+ * re-arms the trigger, if set.
+ *
+ * @param enable: true to start tracing, false to stop it.
+ */
+void trace_enable(const bool enable);
+
+/**
+ * @return true if tracing is enabled.
+ */
+bool trace_isEnabled();
+
+/**
+ * Set the trigger event: tracing stops after a given number of records are
+ * written, from any thread, after the first occurrence of the event.
+ *
+ * @param event: trigger event, TRACE_NONE to disable the trigger.
+ * @param postRecords: number of records written after the trigger.
+ */
+void trace_setTrigger(const uint8_t event, const uint32_t postRecords);
+
+/**
+ * @return true if tracing has been stopped by the trigger and the buffers
+ * have not been dumped yet.
+ */
+bool trace_isTriggered();
+
+/**
+ * Dump the trace buffers, stopping the tracing. Records written while the dump
+ * is in progress are not included.
+ *
+ * @param write: function writing the dump data.
+ * @param arg: argument passed to the write function.
+ * @return number of records dumped.
+ */
+size_t trace_dump(traceWrite_t write, void *arg);
+
+/**
+ * Periodic task: when tracing has been stopped by the trigger, dump the
+ * buffers to the USB virtual COM port or, on Linux, append them to the file
+ * given by the OPENRTX_TRACE_FILE environment variable (default trace.bin)
+ * and restart tracing.
+ */
+void trace_task();
+
+#define TRACE(event, arg0, arg1, arg2) \
+    trace_record((event), (int16_t) (arg0), (int32_t) (arg1), (int32_t) (arg2))
+
+#else
+
+static inline void trace_enable(const bool enable)
+{
+    (void) enable;
+}
+
+static inline bool trace_isEnabled()
+{
+    return false;
+}
+
+static inline void trace_setTrigger(const uint8_t event, const uint32_t postRecords)
+{
+    (void) event;
+    (void) postRecords;
+}
+
+static inline bool trace_isTriggered()
+{
+    return false;
+}
+
+static inline size_t trace_dump(traceWrite_t write, void *arg)
+{
+    (void) write;
+    (void) arg;
+
+    return 0;
+}
+
+static inline void trace_task() { }
+
+#define TRACE(event, arg0, arg1, arg2) do { } while(0)
+
+#endif /* ENABLE_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
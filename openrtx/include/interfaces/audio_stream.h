@@ -47,6 +47,12 @@ typedef struct
 }
 dataBlock_t;
 
+/**
+ * Callback function invoked by an input stream whenever a new block of data
+ * is ready.
+ */
+typedef void (*streamCallback_t)(void *arg);
+
 /**
  * Start the acquisition of an incoming audio stream, also opening the
  * corresponding audio path. If a stream is opened from the same source but
@@ -83,6 +89,19 @@ streamId inputStream_start(const enum AudioSource source,
  */
 dataBlock_t inputStream_getData(streamId id);
 
+/**
+ * Register a function to be called whenever a new block of data of an already
+ * opened input stream is ready, to be used to wait for the data without
+ * blocking on inputStream_getData(). On the MCU targets the callback is called
+ * from the interrupt handler of the stream, with interrupts disabled. The
+ * callback is unregistered when the stream is stopped.
+ *
+ * @param id: identifier of the stream.
+ * @param callback: function to be called, NULL to unregister the current one.
+ * @param arg: argument passed to the callback.
+ */
+void inputStream_setCallback(streamId id, streamCallback_t callback, void *arg);
+
 /**
  * Release the current input stream, allowing for a new call of startInputStream.
  * If this function is called when sampler is running, acquisition is stopped
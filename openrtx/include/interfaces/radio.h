@@ -110,14 +110,30 @@ void radio_enableTx();
  */
 void radio_disableRtx();
 
+/**
+ * Configuration fields the RX and TX stages of the radio module depend on. The
+ * other fields are handled by the operating modes.
+ */
+#define RADIO_RX_FIELDS  (RTX_CFG_OPMODE | RTX_CFG_BANDWIDTH | RTX_CFG_RX_FREQ \
+                        | RTX_CFG_RX_TONE)
+
+#define RADIO_TX_FIELDS  (RTX_CFG_OPMODE | RTX_CFG_BANDWIDTH | RTX_CFG_TX_DISABLE \
+                        | RTX_CFG_TX_FREQ | RTX_CFG_TX_POWER | RTX_CFG_TX_TONE)
+
+#define RADIO_CFG_FIELDS (RADIO_RX_FIELDS | RADIO_TX_FIELDS)
+
 /**
  * Update configuration of the radio module to match the one currently described
  * by the rtxStatus_t configuration data structure.
  * This function has to be called whenever the configuration data structure has
  * been updated, to ensure all the operating parameters of the radio driver are
- * correctly configured.
+ * correctly configured. Only the parameters depending on the changed fields
+ * are reprogrammed.
+ *
+ * @param changes: bit mask of the rtxConfigField values which changed,
+ * RTX_CFG_ALL to reprogram everything.
  */
-void radio_updateConfiguration();
+void radio_updateConfiguration(const uint32_t changes);
 
 /**
  * Get the current RSSI level in dBm.
@@ -29,6 +29,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <array>
 
 namespace M17
 {
@@ -37,6 +38,11 @@ namespace M17
  * Convolutional encoder tailored on M17 protocol specifications, requiring a
  * coder rate R = 1/2, a constraint length K = 5 and polynomials G1 = 0x19 and
  * G2 = 0x17.
+ *
+ * Encoding is table driven: the coded bits of a whole input byte are looked up
+ * from the four bits of encoder memory and the byte value (8kB of tables). If
+ * M17_ENCODER_LOW_MEMORY is defined, the lookup is done one nibble at a time
+ * instead, with a 256 byte table.
  */
 class M17ConvolutionalEncoder
 {
@@ -63,10 +69,71 @@ public:
 
         for(size_t i = 0; i < len; i++)
         {
-            dest[i] = convolveByte(src[i]);
+            dest[i] = __builtin_bswap16(convolveByte(src[i]));
         }
     }
 
+    /**
+     * Encode a given block of data using the M17 convolutional encoding scheme,
+     * flush the encoder and apply a puncturing scheme to the result, writing
+     * the punctured bits straight into the destination array.
+     *
+     * \param data: pointer to source data block.
+     * \param len: length of the source data block.
+     * \param out: destination array for the punctured data.
+     * \param puncture: puncturing matrix, stored as an array of 8 bit values.
+     * \param outPos: position, in bits, of the first punctured bit in the
+     * destination array. Must be a multiple of eight.
+     * \return number of punctured bits written.
+     */
+    template < size_t OUT, size_t P >
+    size_t encodePunctured(const void *data, const size_t len,
+                           std::array< uint8_t, OUT >& out,
+                           const std::array< uint8_t, P >& puncture,
+                           const size_t outPos = 0)
+    {
+        const uint8_t *src = reinterpret_cast< const uint8_t * >(data);
+
+        uint8_t *dest       = out.data() + (outPos / 8);
+        uint8_t *end        = out.data() + OUT;
+        uint32_t acc        = 0;
+        uint8_t  accBits    = 0;
+        size_t   punctIndex = 0;
+        size_t   count      = 0;
+
+        // Input data plus flush, of which only eight coded bits are needed
+        for(size_t i = 0; i <= len; i++)
+        {
+            uint16_t coded   = convolveByte((i < len) ? src[i] : 0x00);
+            uint8_t  numBits = (i < len) ? 16 : 8;
+
+            for(uint8_t j = 0; j < numBits; j++)
+            {
+                if(puncture[punctIndex++])
+                {
+                    acc = (acc << 1) | ((coded >> 15) & 0x01);
+                    accBits++;
+                    count++;
+                }
+
+                if(punctIndex >= P) punctIndex = 0;
+                coded <<= 1;
+            }
+
+            while((accBits >= 8) && (dest < end))
+            {
+                accBits -= 8;
+                *dest++  = acc >> accBits;
+            }
+        }
+
+        // Leftover bits, aligned to the left
+        if((accBits > 0) && (dest < end))
+            *dest = acc << (8 - accBits);
+
+        return count;
+    }
+
     /**
      * Flush the convolutional encoder, returning the remaining encoded data.
      *
@@ -75,7 +142,7 @@ public:
      */
     uint16_t flush()
     {
-        return convolveByte(0x00);
+        return __builtin_bswap16(convolveByte(0x00));
     }
 
     /**
@@ -89,26 +156,76 @@ public:
 private:
 
     /**
-     * Compute the convolutional encoding of a byte, using the M17 encoding
-     * scheme.
+     * Compute, bit by bit, the coded bits of a block of input bits.
      *
-     * \param value: byte to be convolved.
-     * \return result of the convolutional encoding process.
+     * \param memory: encoder memory, the last four input bits.
+     * \param value: input bits, MSB first.
+     * \param numBits: number of input bits.
+     * \return coded bits, first one in the MSB of the result.
      */
-    uint16_t convolveByte(uint8_t value)
+    static constexpr uint16_t computeCode(uint8_t memory, uint8_t value,
+                                          const uint8_t numBits)
     {
         uint16_t result = 0;
 
-        for(uint8_t i = 0; i < 8; i++)
+        for(uint8_t i = 0; i < numBits; i++)
         {
-            memory  = (memory << 1) | ((value & 0x80) >> 7);
+            memory  = (memory << 1) | ((value >> (numBits - 1 - i)) & 0x01);
             memory &= 0x1F;
             result  = (result << 1) | (__builtin_popcount(memory & 0x19) & 0x01);
             result  = (result << 1) | (__builtin_popcount(memory & 0x17) & 0x01);
-            value <<= 1;
         }
 
-        return __builtin_bswap16(result);
+        return result;
+    }
+
+    /**
+     * Coded bits for each encoder memory state and input value.
+     */
+    template < typename T, size_t IN_BITS >
+    struct codeTable
+    {
+        T data[16][1 << IN_BITS];
+    };
+
+    template < typename T, size_t IN_BITS >
+    static constexpr codeTable< T, IN_BITS > makeTable()
+    {
+        codeTable< T, IN_BITS > table = {};
+
+        for(uint8_t mem = 0; mem < 16; mem++)
+        {
+            for(size_t val = 0; val < (1 << IN_BITS); val++)
+                table.data[mem][val] = computeCode(mem, val, IN_BITS);
+        }
+
+        return table;
+    }
+
+    /**
+     * Compute the convolutional encoding of a byte, using the M17 encoding
+     * scheme.
+     *
+     * \param value: byte to be convolved.
+     * \return result of the convolutional encoding process, first coded bit
+     * in the MSB.
+     */
+    uint16_t convolveByte(const uint8_t value)
+    {
+        #ifndef M17_ENCODER_LOW_MEMORY
+        static constexpr auto table = makeTable< uint16_t, 8 >();
+
+        uint16_t result = table.data[memory][value];
+        #else
+        static constexpr auto table = makeTable< uint8_t, 4 >();
+
+        uint16_t result = table.data[memory][value >> 4] << 8;
+        result         |= table.data[value >> 4][value & 0x0F];
+        #endif
+
+        memory = value & 0x0F;
+
+        return result;
     }
 
     uint8_t memory = 0;    ///< Convolutional encoder memory.
@@ -28,6 +28,7 @@
 #endif
 
 #include <fir.hpp>
+#include <fir_q15.hpp>
 #include <array>
 
 namespace M17
@@ -86,10 +87,17 @@ static constexpr std::array<float, 41> rrc_taps_24k =
 };
 
 /*
- * FIR implementations of the RRC filter for baseband audio generation.
+ * FIR implementations of the RRC filter for baseband audio generation. The
+ * 48kHz filter is in polyphase form and directly interpolates the symbol
+ * stream, generating ten baseband samples for each symbol.
  */
-extern Fir< std::tuple_size< decltype(rrc_taps_48k) >::value > rrc_48k;
-extern Fir< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc_24k;
+extern FirInterpolator< std::tuple_size< decltype(rrc_taps_48k) >::value, 10 > rrc_48k;
+
+/*
+ * Q15 coefficients of the 24kHz RRC filter, for the fixed point receive
+ * pipeline.
+ */
+static constexpr auto rrc_taps_24k_q15 = q15Taps(rrc_taps_24k);
 
 } /* M17 */
 
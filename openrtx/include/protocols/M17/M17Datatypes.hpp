@@ -38,6 +38,11 @@ using lich_t    = std::array< uint8_t, 12 >;   // Data type for Golay(24,12) enc
 using frame_t   = std::array< uint8_t, 48 >;   // Data type for a full M17 data frame, including sync word
 using syncw_t   = std::array< uint8_t, 2  >;   // Data type for a sync word
 
+// Data type for the soft decision values of the bits of a full M17 data frame,
+// including sync word. Values range from 0x0000 (bit at zero) to 0xFFFF (bit
+// at one), 0x7FFF means no information on the bit value.
+using soft_frame_t = std::array< uint16_t, 384 >;
+
 /**
  * This structure provides bit field definitions for the "TYPE" field
  * contained in an M17 Link Setup Frame.
@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_DEFRAMER_H
+#define M17_DEFRAMER_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include "M17Datatypes.hpp"
+
+namespace M17
+{
+
+/**
+ * Number of code symbols of a link setup frame after depuncturing, two for
+ * each of the 244 trellis steps.
+ */
+static constexpr size_t LSF_SYMBOLS = 488;
+
+/**
+ * Number of code symbols of the data section of a stream frame after
+ * depuncturing, two for each of the 148 trellis steps.
+ */
+static constexpr size_t STREAM_SYMBOLS = 296;
+
+/**
+ * Deframing functions: extract the data of a received M17 frame, applying in
+ * a single pass the decorrelation, the deinterleaving and the depuncturing.
+ * Each bit is fetched from the raw frame, sync word included, through an index
+ * table generated at compile time.
+ *
+ * Hard decision symbols are zero for a zero bit, two for a one bit and one for
+ * a punctured bit. Soft decision symbols range from zero to 0xFFFF, punctured
+ * bits are marked with 0x7FFF. Both formats are the inputs expected by the
+ * decodeDepunctured() functions of the Viterbi decoders.
+ */
+namespace Deframer
+{
+
+/**
+ * Extract the LICH block from a stream frame.
+ *
+ * @param frame: raw stream frame.
+ * @param lich: destination LICH block.
+ */
+void lich(const frame_t& frame, lich_t& lich);
+
+/**
+ * Extract the depunctured code symbols of a link setup frame.
+ *
+ * @param frame: raw link setup frame.
+ * @param symbols: destination array for the hard decision code symbols.
+ */
+void lsf(const frame_t& frame, std::array< uint8_t, LSF_SYMBOLS >& symbols);
+
+/**
+ * Extract the depunctured soft code symbols of a link setup frame.
+ *
+ * @param frame: soft decision values of the raw frame bits.
+ * @param symbols: destination array for the soft decision code symbols.
+ */
+void lsf(const soft_frame_t& frame, std::array< uint16_t, LSF_SYMBOLS >& symbols);
+
+/**
+ * Extract the depunctured code symbols of the data section of a stream frame.
+ *
+ * @param frame: raw stream frame.
+ * @param symbols: destination array for the hard decision code symbols.
+ */
+void stream(const frame_t& frame, std::array< uint8_t, STREAM_SYMBOLS >& symbols);
+
+/**
+ * Extract the depunctured soft code symbols of the data section of a stream
+ * frame.
+ *
+ * @param frame: soft decision values of the raw frame bits.
+ * @param symbols: destination array for the soft decision code symbols.
+ */
+void stream(const soft_frame_t& frame,
+            std::array< uint16_t, STREAM_SYMBOLS >& symbols);
+
+}      // namespace Deframer
+
+}      // namespace M17
+
+#endif // M17_DEFRAMER_H
@@ -32,11 +32,13 @@
 #include <memory>
 #include <array>
 #include <dsp.h>
+#include <dsp_chain.hpp>
 #include <cmath>
 #include <audio_path.h>
 #include <interfaces/audio_stream.h>
 #include <M17/M17Datatypes.hpp>
 #include <M17/M17Constants.hpp>
+#include <M17/M17DSP.hpp>
 
 namespace M17
 {
@@ -74,8 +76,13 @@ public:
 
     /**
      * Starts the sampling of the baseband signal in a double buffer.
+     *
+     * @param callback: optional function called by the input stream each time
+     * a new block of baseband samples is ready to be processed by update().
+     * @param arg: argument passed to the callback.
      */
-    void startBasebandSampling();
+    void startBasebandSampling(streamCallback_t callback = nullptr,
+                               void *arg = nullptr);
 
     /**
      * Stops the sampling of the baseband signal in a double buffer.
@@ -90,6 +97,15 @@ public:
      */
     const frame_t& getFrame();
 
+    /**
+     * Returns the soft decision values of the bits of the last decoded frame.
+     * The data is valid until the next call of update().
+     *
+     * @return reference to the internal data structure containing the soft
+     * decision values of the last decoded frame.
+     */
+    const soft_frame_t& getSoftFrame();
+
     /**
      * @return true if the last decoded frame is an LSF.
      */
@@ -104,6 +120,23 @@ public:
     bool update();
 
     /**
+     * Demodulates a block of baseband samples provided by the caller instead
+     * of reading them from the ADC. Samples must be taken at 24kHz, blocks
+     * longer than half of an M17 frame (480 samples) are processed in chunks
+     * of that size. Only the last frame completed within the block is kept,
+     * blocks must not be longer than a frame (960 samples) for no frame to be
+     * lost. Block content is modified by the DC removal.
+     *
+     * @param block: data block containing the baseband samples.
+     * @return true if a new frame has been fully decoded.
+     */
+    bool update(dataBlock_t block);
+
+    /**
+     * Get the lock status. When the lock is lost in the same update() call
+     * completing a frame, like the last frame before the EOT, the demodulator
+     * is reported locked until the next call, for the frame to be read.
+     *
      * @return true if a demodulator is locked on an M17 stream.
      */
     bool isLocked();
@@ -135,6 +168,8 @@ private:
     static constexpr float  CONV_STATS_ALPHA       = 0.005f;
     static constexpr float  CONV_THRESHOLD_FACTOR  = 3.40;
     static constexpr int16_t QNT_SMA_WINDOW        = 8;
+    static constexpr int32_t TIMING_LOOP_THRESHOLD = 2;
+    static constexpr int32_t CONV_CHUNK_SIZE       = 32;
 
     /**
      * M17 syncwords;
@@ -148,16 +183,21 @@ private:
     std::unique_ptr< int16_t[] > baseband_buffer; ///< Buffer for baseband audio handling.
     streamId                     basebandId;      ///< Id of the baseband input stream.
     pathId                       basebandPath;    ///< Id of the baseband input path.
-    dataBlock_t                  baseband;        ///< Data block with samples to be processed.
+    std::unique_ptr< int16_t[] > window;          ///< Working window, bridge followed by filtered samples.
+    dataBlock_t                  baseband;        ///< Filtered samples, negative indices address the bridge.
     uint16_t                     frame_index;     ///< Index for filling the raw frame.
     std::unique_ptr<frame_t >    demodFrame;      ///< Frame being demodulated.
     std::unique_ptr<frame_t >    readyFrame;      ///< Fully demodulated frame to be returned.
+    std::unique_ptr<soft_frame_t > softDemodFrame; ///< Soft bits of the frame being demodulated.
+    std::unique_ptr<soft_frame_t > softReadyFrame; ///< Soft bits of the frame to be returned.
     bool                         syncDetected;    ///< A syncword was detected.
     bool                         locked;          ///< A syncword was correctly demodulated.
     bool                         newFrame;        ///< A new frame has been fully decoded.
-    int16_t                      basebandBridge[M17_BRIDGE_SIZE] = { 0 }; ///< Bridge buffer
+    bool                         frameDone;       ///< A frame has been completed in this update.
+    bool                         lockHold;        ///< Lock lost after completing a frame in this update.
+    bool                         timingLocked;    ///< Initial sampling phase has been found.
     int16_t                      phase;           ///< Phase of the signal w.r.t. sampling
-    bool                         invPhase;        ///< Invert signal phase
+    int32_t                      timingError;     ///< Integrated symbol timing error.
 
     /*
      * State variables
@@ -176,13 +216,21 @@ private:
     int8_t       qnt_neg_cnt;      ///< Number of received negative samples
     int32_t      qnt_pos_acc;      ///< Accumulator for quantization average
     int32_t      qnt_neg_acc;      ///< Accumulator for quantization average
-    float qnt_pos_avg = 0.0f;      ///< Rolling average of positive samples
-    float qnt_neg_avg = 0.0f;      ///< Rolling average of negative samples
+    int16_t      qnt_pos_th = 0;   ///< Threshold for positive outer symbols
+    int16_t      qnt_neg_th = 0;   ///< Threshold for negative outer symbols
 
     /*
-     * DSP filter state
+     * Input processing chain, private to each demodulator instance: DC removal
+     * followed by the RRC matched filter, which also inverts the signal phase
+     * when required.
      */
-    filter_state_t dsp_state;
+    #ifdef M17_RX_FIXED_POINT
+    DspChain< DspDcRemovalFixed,
+              DspFirQ15< std::tuple_size< decltype(rrc_taps_24k_q15) >::value > > rxChain;
+    #else
+    DspChain< DspDcRemoval,
+              DspFir< std::tuple_size< decltype(rrc_taps_24k) >::value > > rxChain;
+    #endif
 
     /**
      * Resets the exponential mean and variance/stddev computation.
@@ -228,6 +276,18 @@ private:
      */
     int32_t convolution(int32_t offset, int8_t *target, size_t target_size);
 
+    /**
+     * Computes the convolution between the syncword and the samples for a
+     * number of consecutive offsets, in a single pass.
+     *
+     * @param offset: the offset in the active buffer of the first stride
+     * @param target: a buffer containing the syncword symbols
+     * @param conv: buffer where to store the convolution values
+     * @param count: number of consecutive offsets to be evaluated
+     */
+    void slidingCorrelation(int32_t offset, const int8_t *target,
+                            int32_t *conv, size_t count);
+
     /**
      * Finds the index of the next frame syncword in the baseband stream.
      *
@@ -246,6 +306,16 @@ private:
      */
     int8_t quantize(int32_t offset);
 
+    /**
+     * Takes the value from the input baseband at a given offset and computes
+     * the soft decision values of the two bits carried by the symbol, using
+     * the quantization thresholds.
+     *
+     * @param offset: the offset in the input baseband
+     * @param bits: array of two elements where to store the soft bits
+     */
+    void softDemap(int32_t offset, uint16_t *bits);
+
     /**
      * Perform a limited search for a syncword using correlation
      *
@@ -253,6 +323,24 @@ private:
      * @return int32_t sample of the beginning of a syncword
      */
     int32_t syncwordSweep(int32_t offset);
+
+    /**
+     * Symbol timing recovery: estimate the timing error of a symbol and
+     * integrate it, returning the correction to be applied to the sampling
+     * phase.
+     *
+     * @param offset: index of the symbol sample in the baseband.
+     * @return sampling phase correction, -1, 0 or +1 samples.
+     */
+    int32_t updateTiming(int32_t offset);
+
+    /**
+     * Demodulate a chunk of baseband samples, at most half of an M17 frame.
+     *
+     * @param samples: baseband samples.
+     * @param len: number of samples, not greater than M17_SAMPLE_BUF_SIZE.
+     */
+    void demodulate(int16_t *samples, const size_t len);
 };
 
 } /* M17 */
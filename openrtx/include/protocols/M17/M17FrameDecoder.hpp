@@ -75,6 +75,17 @@ public:
      */
     M17FrameType decodeFrame(const frame_t& frame);
 
+    /**
+     * Decode an M17 frame, identifying its type, using the soft decision
+     * values of the frame bits for the convolutional code decoding. Frame
+     * type and LICH are decoded from the hard bits.
+     *
+     * @param frame: byte array containg frame data.
+     * @param softFrame: soft decision values of the frame bits.
+     * @return the type of frame recognized.
+     */
+    M17FrameType decodeFrame(const frame_t& frame, const soft_frame_t& softFrame);
+
     /**
      * Get the latest Link Setup Frame decoded. Check of the validity of the
      * data contained in the LSF is left to application code.
@@ -104,26 +115,52 @@ private:
      * distance exceeds a masimum absolute threshold the frame is declared of
      * unknown type.
      *
-     * @param syncWord: frame syncword.
-     * @return frame type based on the given syncword.
+     * @param frame: byte array containg frame data, starting with the sync
+     * word.
+     * @return frame type based on the frame syncword.
      */
-    M17FrameType getFrameType(const std::array< uint8_t, 2 >& syncWord);
+    M17FrameType getFrameType(const frame_t& frame);
 
     /**
      * Decode Link Setup Frame data and update the internal LSF field with
      * the new frame data.
      *
-     * @param data: byte array containg frame data, without sync word.
+     * @param frame: byte array containg frame data.
+     */
+    void decodeLSF(const frame_t& frame);
+
+    /**
+     * Decode Link Setup Frame data from the soft decision values of its bits
+     * and update the internal LSF field with the new frame data.
+     *
+     * @param softFrame: soft decision values of the frame bits.
      */
-    void decodeLSF(const std::array< uint8_t, 46 >& data);
+    void decodeLSF(const soft_frame_t& softFrame);
 
     /**
      * Decode stream data and update the internal LSF field with the new
      * frame data.
      *
-     * @param data: byte array containg frame data, without sync word.
+     * @param frame: byte array containg frame data.
+     */
+    void decodeStream(const frame_t& frame);
+
+    /**
+     * Decode stream data from the soft decision values of its bits and update
+     * the internal LSF field with the new frame data.
+     *
+     * @param frame: byte array containg frame data.
+     * @param softFrame: soft decision values of the frame bits.
+     */
+    void decodeStream(const frame_t& frame, const soft_frame_t& softFrame);
+
+    /**
+     * Decode a LICH block and update the LSF reassembled from the LICH
+     * segments.
+     *
+     * @param lich: LICH block of a stream frame.
      */
-    void decodeStream(const std::array< uint8_t, 46 >& data);
+    void updateLsfFromLich(const lich_t& lich);
 
     /**
      * Decode a LICH block.
@@ -141,6 +178,7 @@ private:
     M17LinkSetupFrame lsfFromLich;      ///< LSF assembled from LICH segments.
     M17StreamFrame    streamFrame;      ///< Latest stream dat frame received.
     M17HardViterbi    viterbi;          ///< Viterbi decoder.
+    M17SoftViterbi    softViterbi;      ///< Soft decision Viterbi decoder.
 
     ///< Maximum allowed hamming distance when determining the frame type.
     static constexpr uint8_t MAX_SYNC_HAMM_DISTANCE = 4;
@@ -32,6 +32,54 @@
 namespace M17
 {
 
+/**
+ * Index tables of the quadratic permutation polynomial from M17 protocol
+ * specification, P(x) = 45*x + 92*x^2, for a block of NB bits. Bit i of a
+ * block is moved to position forward[i] by interleaving, bit j of an
+ * interleaved block comes from position inverse[j].
+ */
+template < size_t NB >
+struct InterleaverTable
+{
+    uint16_t forward[NB];
+    uint16_t inverse[NB];
+};
+
+/**
+ * Compute the interleaver index tables for a block of NB bits.
+ *
+ * \return interleaver index tables.
+ */
+template < size_t NB >
+constexpr InterleaverTable< NB > makeInterleaverTable()
+{
+    static_assert(NB <= 65536, "Block too long for 16 bit indices");
+
+    InterleaverTable< NB > table = {};
+
+    for(size_t i = 0; i < NB; i++)
+    {
+        size_t index = ((45 * i) + (92 * i * i)) % NB;
+        table.forward[i]     = index;
+        table.inverse[index] = i;
+    }
+
+    return table;
+}
+
+/**
+ * Interleaver index tables, generated at compile time and shared among all
+ * the users of a given block size.
+ */
+template < size_t NB >
+struct Interleaver
+{
+    static constexpr InterleaverTable< NB > table = makeInterleaverTable< NB >();
+};
+
+template < size_t NB >
+constexpr InterleaverTable< NB > Interleaver< NB >::table;
+
 /**
  * Interleave a block of data using the quadratic permutation polynomial from
  * M17 protocol specification. Polynomial used is P(x) = 45*x + 92*x^2.
@@ -42,18 +90,19 @@ template < size_t N >
 void interleave(std::array< uint8_t, N >& data)
 {
     std::array< uint8_t, N > interleaved;
+    const auto& inverse = Interleaver< N*8 >::table.inverse;
 
-    static constexpr size_t F1 = 45;
-    static constexpr size_t F2 = 92;
-    static constexpr size_t NB = N*8;
-
-    for(size_t i = 0; i < NB; i++)
+    // Each output byte is gathered from the eight source bits, in one pass
+    for(size_t i = 0; i < N; i++)
     {
-        size_t index = ((F1 * i) + (F2 * i * i)) % NB;
-        setBit(interleaved, index, getBit(data, i));
+        uint8_t byte = 0;
+        for(size_t j = 0; j < 8; j++)
+            byte = (byte << 1) | getBit(data, inverse[(8 * i) + j]);
+
+        interleaved[i] = byte;
     }
 
-    std::copy(interleaved.begin(), interleaved.end(), data.begin());
+    data = interleaved;
 }
 
 /**
@@ -67,18 +116,18 @@ template < size_t N >
 void deinterleave(std::array< uint8_t, N >& data)
 {
     std::array< uint8_t, N > deinterleaved;
+    const auto& forward = Interleaver< N*8 >::table.forward;
 
-    static constexpr size_t F1 = 45;
-    static constexpr size_t F2 = 92;
-    static constexpr size_t NB = N*8;
-
-    for(size_t i = 0; i < NB; i++)
+    for(size_t i = 0; i < N; i++)
     {
-        size_t index = ((F1 * i) + (F2 * i * i)) % NB;
-        setBit(deinterleaved, i, getBit(data, index));
+        uint8_t byte = 0;
+        for(size_t j = 0; j < 8; j++)
+            byte = (byte << 1) | getBit(data, forward[(8 * i) + j]);
+
+        deinterleaved[i] = byte;
     }
 
-    std::copy(deinterleaved.begin(), deinterleaved.end(), data.begin());
+    data = deinterleaved;
 }
 
 }      // namespace M17
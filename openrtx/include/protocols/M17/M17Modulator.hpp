@@ -33,6 +33,10 @@
 #include <memory>
 #include <array>
 
+#if defined(PLATFORM_LINUX)
+#include <functional>
+#endif
+
 namespace M17
 {
 
@@ -83,6 +87,16 @@ public:
      */
     void stop();
 
+    #if defined(PLATFORM_LINUX)
+    /**
+     * Set a function receiving the generated baseband, 48kHz samples, in
+     * place of the default output file. Linux only, used by host tools.
+     *
+     * @param callback: function called for each block of baseband samples.
+     */
+    void setBasebandCallback(std::function< void(const int16_t *, size_t) > callback);
+    #endif
+
 private:
 
     /**
@@ -114,6 +128,10 @@ private:
     pathId                       outPath;          ///< Baseband output path ID.
     bool                         txRunning;        ///< Transmission running.
 
+    #if defined(PLATFORM_LINUX)
+    std::function< void(const int16_t *, size_t) > basebandCallback;
+    #endif
+
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
     PwmCompensator pwmComp;
     #endif
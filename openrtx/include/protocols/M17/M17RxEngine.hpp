@@ -0,0 +1,277 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_RX_ENGINE_H
+#define M17_RX_ENGINE_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#ifndef PLATFORM_LINUX
+#error The multi-channel M17 receive engine is available only on Linux
+#endif
+
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17FrameDecoder.hpp>
+
+namespace M17
+{
+
+/**
+ * Source of baseband samples for a channel of the receive engine. Samples are
+ * provided at the 24kHz sample rate of the demodulator.
+ */
+class M17RxSource
+{
+public:
+
+    /**
+     * Destructor.
+     */
+    virtual ~M17RxSource() { }
+
+    /**
+     * Read baseband samples. The call can block until data is available.
+     *
+     * @param buf: buffer where to place the samples.
+     * @param len: maximum number of samples to be read.
+     * @return number of samples read, zero when the end of stream is reached.
+     */
+    virtual size_t read(int16_t *buf, const size_t len) = 0;
+};
+
+/**
+ * Baseband source reading raw 16 bit samples from a file or a FIFO, sampled
+ * either at 24kHz or at 48kHz.
+ */
+class M17FileSource : public M17RxSource
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param path: path of the file or FIFO.
+     * @param sampleRate: sample rate of the data, 24000 or 48000.
+     */
+    M17FileSource(const char *path, const uint32_t sampleRate);
+
+    /**
+     * Destructor.
+     */
+    virtual ~M17FileSource();
+
+    /**
+     * @return true if the file has been successfully opened.
+     */
+    bool isOpen();
+
+    virtual size_t read(int16_t *buf, const size_t len) override;
+
+private:
+
+    FILE                  *file;    ///< Input file.
+    size_t                 decim;   ///< Decimation factor to 24kHz.
+    size_t                 skip;    ///< Samples of a partial step left to skip.
+    std::vector< int16_t > buffer;  ///< Buffer for decimation.
+};
+
+/**
+ * Multichannel raw baseband stream, with the samples of the channels
+ * interleaved. Each channel is read through its own M17RxSource, channels
+ * are demultiplexed on demand and the data of the channels not being read is
+ * queued until requested.
+ */
+class M17InterleavedStream
+{
+public:
+
+    /**
+     * Open a multichannel stream.
+     *
+     * @param path: path of the file or FIFO.
+     * @param channels: number of interleaved channels.
+     * @param sampleRate: sample rate of the data, 24000 or 48000.
+     * @return one source for each channel of the stream, empty on error.
+     */
+    static std::vector< std::unique_ptr< M17RxSource > >
+    open(const char *path, const size_t channels, const uint32_t sampleRate);
+
+    /**
+     * Destructor.
+     */
+    ~M17InterleavedStream();
+
+private:
+
+    class ChannelSource;
+
+    M17InterleavedStream(FILE *file, const size_t channels,
+                         const uint32_t sampleRate);
+
+    /**
+     * Read samples of a channel, demultiplexing new data from the stream
+     * when the channel queue is empty.
+     */
+    size_t read(const size_t channel, int16_t *buf, const size_t len);
+
+    std::mutex                             mutex;    ///< Stream access lock.
+    FILE                                  *file;     ///< Input file.
+    size_t                                 decim;    ///< Decimation factor.
+    size_t                                 pending;  ///< Samples of an incomplete frame.
+    std::vector< std::deque< int16_t > >   queues;   ///< Per channel queues.
+    std::vector< int16_t >                 buffer;   ///< Read buffer.
+};
+
+/**
+ * Per channel receive statistics.
+ */
+struct M17ChannelStats
+{
+    size_t samples      = 0;    ///< Samples processed.
+    size_t frames       = 0;    ///< Frames received from the demodulator.
+    size_t lsfFrames    = 0;    ///< Valid LSF frames.
+    size_t streamFrames = 0;    ///< Stream frames.
+    size_t locks        = 0;    ///< Number of lock acquisitions.
+    size_t lockedBlocks = 0;    ///< Sample blocks processed while locked.
+    double busyTime     = 0.0;  ///< Processing time, in seconds.
+};
+
+/**
+ * Multi-channel M17 receive engine, Linux only. Runs an independent
+ * demodulator and frame decoder for each channel, distributing the channels
+ * over a pool of worker threads.
+ */
+class M17RxEngine
+{
+public:
+
+    /**
+     * Callback invoked for each frame decoded. It is called from the worker
+     * threads, concurrently for different channels, and must be thread safe.
+     */
+    using frameCallback_t = std::function< void(const size_t channel,
+                                                const M17FrameType type,
+                                                M17FrameDecoder& decoder) >;
+
+    /**
+     * Constructor.
+     *
+     * @param numThreads: number of worker threads.
+     */
+    M17RxEngine(const size_t numThreads);
+
+    /**
+     * Destructor.
+     */
+    ~M17RxEngine();
+
+    /**
+     * Add a receive channel.
+     *
+     * @param source: source of the channel baseband samples.
+     * @return index of the new channel.
+     */
+    size_t addChannel(std::unique_ptr< M17RxSource > source);
+
+    /**
+     * Set the callback invoked for each decoded frame.
+     *
+     * @param callback: frame callback.
+     */
+    void setFrameCallback(frameCallback_t callback);
+
+    /**
+     * Process all the channels until their sources are exhausted. The call
+     * blocks until all the channels are done.
+     */
+    void run();
+
+    /**
+     * @return number of channels.
+     */
+    size_t numChannels();
+
+    /**
+     * Get the statistics of a channel.
+     *
+     * @param channel: channel index.
+     * @return channel statistics.
+     */
+    const M17ChannelStats& getStats(const size_t channel);
+
+    /**
+     * @return wall clock duration of the last run, in seconds.
+     */
+    double getElapsedTime();
+
+private:
+
+    static constexpr size_t BLOCK_SIZE      = 480;   ///< Half M17 frame at 24kHz.
+    static constexpr size_t BLOCKS_PER_TASK = 32;    ///< Blocks processed per scheduling.
+
+    struct channel_t
+    {
+        std::unique_ptr< M17RxSource > source;
+        M17Demodulator                 demodulator;
+        M17FrameDecoder                decoder;
+        M17ChannelStats                stats;
+        bool                           locked;
+        std::array< int16_t, BLOCK_SIZE > block;
+    };
+
+    /**
+     * Worker thread body: takes channels from the ready queue and processes
+     * a batch of sample blocks for each of them, until all the channels are
+     * done.
+     */
+    void worker();
+
+    /**
+     * Process a batch of sample blocks of a channel.
+     *
+     * @param index: channel index.
+     * @return true if the channel has more data to be processed.
+     */
+    bool processChannel(const size_t index);
+
+    size_t                                      numThreads; ///< Worker threads.
+    std::vector< std::unique_ptr< channel_t > > channels;   ///< Receive channels.
+    frameCallback_t                             callback;   ///< Frame callback.
+    std::mutex                                  mutex;      ///< Ready queue lock.
+    std::condition_variable                     cond;       ///< Ready queue condition.
+    std::deque< size_t >                        ready;      ///< Channels ready to run.
+    size_t                                      active;     ///< Channels not yet done.
+    double                                      elapsed;    ///< Duration of last run.
+};
+
+}      // namespace M17
+
+#endif // M17_RX_ENGINE_H
@@ -31,12 +31,204 @@
 #include <cstdint>
 #include <cstddef>
 #include <array>
-#include <bitset>
 #include "M17Utils.hpp"
 
 namespace M17
 {
 
+/**
+ * Add-compare-select kernel for the 16 states trellis of the M17 convolutional
+ * code, shared by the hard and soft decision Viterbi decoders.
+ *
+ * The path metrics of all the states are packed in two vectors of eight 16 bit
+ * values, processed at once using GCC vector extensions: on the host these are
+ * mapped to SSE/NEON instructions, on Cortex-M4 to SIMD within a register.
+ * The decisions of each trellis step are stored as a single 16 bit word, with
+ * one bit for each state. Path metrics are renormalized at every step, so that
+ * they never exceed the signed 16 bit range as long as the cost of a single
+ * symbol is lower than 2048.
+ */
+class M17ViterbiAcs
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param symCost: cost of a completely wrong symbol, must be lower than
+     * 2048.
+     */
+    M17ViterbiAcs(const int16_t symCost) : symCost(symCost)
+    {
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~M17ViterbiAcs() { }
+
+    /**
+     * Reset the path metrics.
+     */
+    void reset()
+    {
+        metricsLo = v8i16{ };
+        metricsHi = v8i16{ };
+        offset    = 0;
+    }
+
+    /**
+     * Decode one bit and update trellis.
+     *
+     * @param s0: value of the first symbol, between zero and symCost.
+     * @param s1: value of the second symbol, between zero and symCost.
+     * @param pos: bit position in history.
+     */
+    void decodeBit(const int16_t s0, const int16_t s1, const size_t pos)
+    {
+        /*
+         * States 2i and 2i + 1 have the same predecessors, i and i + 8. The
+         * tables hold the symbols expected on the branch coming from the first
+         * predecessor of each state, for states 0 - 7 and 8 - 15; the symbols
+         * expected on the branch from the second predecessor are their
+         * complement, thus the cost of that branch is 2 * symCost minus the
+         * cost of the first one.
+         */
+        static constexpr v8i16 EXP_0_LO  = { 0, -1,  0, -1,  0, -1,  0, -1 };
+        static constexpr v8i16 EXP_0_HI  = {-1,  0, -1,  0, -1,  0, -1,  0 };
+        static constexpr v8i16 EXP_1_LO  = { 0, -1, -1,  0, -1,  0,  0, -1 };
+        static constexpr v8i16 EXP_1_HI  = { 0, -1, -1,  0, -1,  0,  0, -1 };
+        static constexpr v8i16 DUP_LO    = { 0, 0, 1, 1, 2, 2, 3, 3 };
+        static constexpr v8i16 DUP_HI    = { 4, 4, 5, 5, 6, 6, 7, 7 };
+        static constexpr v8i16 WEIGHT_LO = { 0x0001, 0x0002, 0x0004, 0x0008,
+                                             0x0010, 0x0020, 0x0040, 0x0080 };
+        static constexpr v8i16 WEIGHT_HI = { 0x0100, 0x0200, 0x0400, 0x0800,
+                                             0x1000, 0x2000, 0x4000,
+                                             static_cast< int16_t >(0x8000) };
+
+        const int16_t maxCost = 2 * symCost;
+
+        // Branch costs
+        v8i16 costLo = { };
+        v8i16 costHi = { };
+        addAbsDiff(costLo, EXP_0_LO & symCost, s0);
+        addAbsDiff(costLo, EXP_1_LO & symCost, s1);
+        addAbsDiff(costHi, EXP_0_HI & symCost, s0);
+        addAbsDiff(costHi, EXP_1_HI & symCost, s1);
+
+        // Path metrics through the first and second predecessors
+        v8i16 mALo = __builtin_shuffle(metricsLo, DUP_LO) + costLo;
+        v8i16 mAHi = __builtin_shuffle(metricsLo, DUP_HI) + costHi;
+        v8i16 mBLo = __builtin_shuffle(metricsHi, DUP_LO) + (maxCost - costLo);
+        v8i16 mBHi = __builtin_shuffle(metricsHi, DUP_HI) + (maxCost - costHi);
+
+        // Select survivors, ties are resolved in favour of second predecessor
+        v8i16 selLo = (mALo >= mBLo);
+        v8i16 selHi = (mAHi >= mBHi);
+        metricsLo   = (mALo & ~selLo) | (mBLo & selLo);
+        metricsHi   = (mAHi & ~selHi) | (mBHi & selHi);
+
+        v8i16 bits   = (selLo & WEIGHT_LO) | (selHi & WEIGHT_HI);
+        history[pos] = static_cast< uint16_t >(reduce(bits, vor));
+
+        // Renormalize path metrics
+        v8i16 min = metricsHi;
+        vmin(min, metricsLo);
+
+        int16_t base = reduce(min, vmin);
+        metricsLo   -= base;
+        metricsHi   -= base;
+        offset      += base;
+    }
+
+    /**
+     * History chainback to obtain final byte array.
+     *
+     * @param out: destination byte array for decoded data.
+     * @param pos: starting position for the chainback.
+     * @return minimum path metric at the end of the decode sequence.
+     */
+    template < size_t OUT >
+    uint32_t chainback(std::array< uint8_t, OUT >& out, size_t pos)
+    {
+        uint8_t state = 0;
+        size_t bitPos = OUT*8;
+
+        while(bitPos > 0)
+        {
+            bitPos--;
+            pos--;
+            bool bit = (history[pos] >> (state >> 4)) & 0x01;
+            state >>= 1;
+            if(bit) state |= 0x80;
+            setBit(out, bitPos, bit);
+        }
+
+        // Metrics are renormalized, the minimum is always zero
+        return offset;
+    }
+
+private:
+
+    using v8i16 = int16_t __attribute__((vector_size(16)));
+
+    /**
+     * Add to an accumulator the lane-wise absolute value of the difference
+     * between a vector and a scalar.
+     *
+     * NOTE: vectors are always passed by reference, passing or returning them
+     * by value makes the function ABI depend on the SIMD extensions available.
+     */
+    static inline void addAbsDiff(v8i16& acc, const v8i16& v, const int16_t s)
+    {
+        v8i16 d = v - s;
+        v8i16 m = d >> 15;
+        acc    += (d ^ m) - m;
+    }
+
+    /**
+     * Reduce all the elements of a vector to a single value, by repeatedly
+     * folding the vector in half.
+     *
+     * @param in: vector to be reduced.
+     * @param op: lane-wise reduction operation, accumulating on the first
+     * operand.
+     * @return the reduced value.
+     */
+    template < typename OP >
+    static inline int16_t reduce(const v8i16& in, OP op)
+    {
+        static constexpr v8i16 FOLD_4 = { 4, 5, 6, 7, 0, 1, 2, 3 };
+        static constexpr v8i16 FOLD_2 = { 2, 3, 0, 1, 4, 5, 6, 7 };
+        static constexpr v8i16 FOLD_1 = { 1, 0, 2, 3, 4, 5, 6, 7 };
+
+        v8i16 v = in;
+        op(v, __builtin_shuffle(v, FOLD_4));
+        op(v, __builtin_shuffle(v, FOLD_2));
+        op(v, __builtin_shuffle(v, FOLD_1));
+
+        return v[0];
+    }
+
+    static inline void vor(v8i16& a, const v8i16& b)
+    {
+        a |= b;
+    }
+
+    static inline void vmin(v8i16& a, const v8i16& b)
+    {
+        v8i16 m = (a < b);
+        a = (a & m) | (b & ~m);
+    }
+
+    const int16_t                 symCost;     ///< Cost of a wrong symbol.
+    v8i16                         metricsLo;   ///< Path metrics, states 0 - 7.
+    v8i16                         metricsHi;   ///< Path metrics, states 8 - 15.
+    uint32_t                      offset;      ///< Sum of the renormalizations.
+    std::array< uint16_t, 244 >   history;     ///< Survivor decisions.
+};
+
 /**
  * Hard decision Viterbi decoder tailored on M17 protocol specifications,
  * that is for decoding of data encoded with a convolutional encoder with a
@@ -51,7 +243,7 @@ public:
     /**
      * Constructor.
      */
-    M17HardViterbi() : prevMetrics(&prevMetricsData), currMetrics(&currMetricsData)
+    M17HardViterbi() : acs(2)
     { }
 
     /**
@@ -72,8 +264,7 @@ public:
     {
         static_assert(IN*4 < 244, "Input size exceeds max history");
 
-        currMetricsData.fill(0x00);
-        prevMetricsData.fill(0x00);
+        acs.reset();
 
         size_t pos = 0;
         for (size_t i = 0; i < IN*8; i += 2)
@@ -81,11 +272,11 @@ public:
             uint8_t s0 = getBit(in, i)     ? 2 : 0;
             uint8_t s1 = getBit(in, i + 1) ? 2 : 0;
 
-            decodeBit(s0, s1, pos);
+            acs.decodeBit(s0, s1, pos);
             pos++;
         }
 
-        return chainback(out, pos) / ((K - 1) >> 1);
+        return acs.chainback(out, pos) / ((K - 1) >> 1);
     }
 
     /**
@@ -102,8 +293,7 @@ public:
     {
         static_assert(IN*4 < 244, "Input size exceeds max history");
 
-        currMetricsData.fill(0x00);
-        prevMetricsData.fill(0x00);
+        acs.reset();
 
         size_t   histPos     = 0;
         size_t   punctIndex  = 0;
@@ -129,120 +319,58 @@ public:
                 if(punctIndex >= P) punctIndex = 0;
             }
 
-            decodeBit(sym[0], sym[1], histPos);
+            acs.decodeBit(sym[0], sym[1], histPos);
             histPos++;
         }
 
-        return (chainback(out, histPos) - punctBitCnt) / ((K - 1) >> 1);
+        return (acs.chainback(out, histPos) - punctBitCnt) / ((K - 1) >> 1);
     }
 
-private:
-
     /**
-     * Decode one bit and update trellis.
+     * Decode convolutionally encoded data already depunctured, with one code
+     * symbol for each element: zero for a bit at zero, two for a bit at one
+     * and one for a punctured bit.
      *
-     * @param s0: cost of the first symbol.
-     * @param s1: cost of the second symbol.
-     * @param pos: bit position in history.
+     * @param in: input code symbols.
+     * @param out: destination array where decoded data are written.
+     * @return number of bit errors corrected.
      */
-    void decodeBit(uint8_t s0, uint8_t s1, size_t pos)
+    template < size_t IN, size_t OUT >
+    uint16_t decodeDepunctured(const std::array< uint8_t, IN  >& in,
+                                     std::array< uint8_t, OUT >& out)
     {
-        static constexpr uint8_t COST_TABLE_0[] = {0, 0, 0, 0, 2, 2, 2, 2};
-        static constexpr uint8_t COST_TABLE_1[] = {0, 2, 2, 0, 0, 2, 2, 0};
-
-        for(uint8_t i = 0; i < NumStates/2; i++)
-        {
-            uint16_t metric = std::abs(COST_TABLE_0[i] - s0)
-                            + std::abs(COST_TABLE_1[i] - s1);
-
-
-            uint16_t m0 = (*prevMetrics)[i] + metric;
-            uint16_t m1 = (*prevMetrics)[i + NumStates/2] + (4 - metric);
-
-            uint16_t m2 = (*prevMetrics)[i] + (4 - metric);
-            uint16_t m3 = (*prevMetrics)[i + NumStates/2] + metric;
-
-            uint8_t i0 = 2 * i;
-            uint8_t i1 = i0 + 1;
-
-            if(m0 >= m1)
-            {
-                history[pos].set(i0, true);
-                (*currMetrics)[i0] = m1;
-            }
-            else
-            {
-                history[pos].set(i0, false);
-                (*currMetrics)[i0] = m0;
-            }
-
-            if(m2 >= m3)
-            {
-                history[pos].set(i1, true);
-                (*currMetrics)[i1] = m3;
-            }
-            else
-            {
-                history[pos].set(i1, false);
-                (*currMetrics)[i1] = m2;
-            }
-        }
+        static_assert(IN <= 244*2, "Input size exceeds max history");
 
-        std::swap(currMetrics, prevMetrics);
-    }
+        acs.reset();
 
-    /**
-     * History chainback to obtain final byte array.
-     *
-     * @param out: destination byte array for decoded data.
-     * @param pos: starting position for the chainback.
-     * @return minimum Viterbi cost at the end of the decode sequence.
-     */
-    template < size_t OUT >
-    uint16_t chainback(std::array< uint8_t, OUT >& out, size_t pos)
-    {
-        uint8_t state = 0;
-        size_t bitPos = OUT*8;
-
-        while(bitPos > 0)
+        uint16_t punctBitCnt = 0;
+        for(size_t i = 0; i < IN; i += 2)
         {
-            bitPos--;
-            pos--;
-            bool bit = history[pos].test(state >> 4);
-            state >>= 1;
-            if(bit) state |= 0x80;
-            setBit(out, bitPos, bit);
-        }
+            if(in[i]     == 1) punctBitCnt++;
+            if(in[i + 1] == 1) punctBitCnt++;
 
-        uint16_t cost = (*prevMetrics)[0];
-
-        for(size_t i = 0; i < NumStates; i++)
-        {
-            uint16_t m = (*prevMetrics)[i];
-            if(m < cost) cost = m;
+            acs.decodeBit(in[i], in[i + 1], i / 2);
         }
 
-        return cost;
+        return (acs.chainback(out, IN / 2) - punctBitCnt) / ((K - 1) >> 1);
     }
 
+private:
 
     static constexpr size_t K = 5;
-    static constexpr size_t NumStates = (1 << (K - 1));
 
-    std::array< uint16_t, NumStates > *prevMetrics;
-    std::array< uint16_t, NumStates > *currMetrics;
-
-    std::array< uint16_t, NumStates >  prevMetricsData;
-    std::array< uint16_t, NumStates >  currMetricsData;
-
-    std::array< std::bitset< NumStates >, 244 > history;
+    M17ViterbiAcs acs;    ///< Add-compare-select kernel.
 };
 
+
 /**
  * Soft decision Viterbi decoder tailored on M17 protocol specifications,
  * that is for decoding of data encoded with a convolutional encoder with a
  * coder rate R = 1/2, a constraint length K = 5 and polynomials G1 = 0x19 and
  * G2 = 0x17.
+ *
+ * Soft input values are reduced to 11 bit before being processed, to keep the
+ * path metrics in the 16 bit range.
  */
 
 class M17SoftViterbi
@@ -252,7 +380,7 @@ public:
     /**
      * Constructor.
      */
-    M17SoftViterbi() : prevMetrics(&prevMetricsData), currMetrics(&currMetricsData)
+    M17SoftViterbi() : acs(0xFFFF >> SOFT_SHIFT)
     { }
 
     /**
@@ -273,8 +401,7 @@ public:
     {
         static_assert(IN < 244*2, "Input size exceeds max history");
 
-        currMetricsData.fill(0);
-        prevMetricsData.fill(0);
+        acs.reset();
 
         size_t pos = 0;
         for (size_t i = 0; i < IN; i += 2)
@@ -282,11 +409,11 @@ public:
             uint16_t s0 = in[i];
             uint16_t s1 = in[i + 1];
 
-            decodeBit(s0, s1, pos);
+            acs.decodeBit(s0 >> SOFT_SHIFT, s1 >> SOFT_SHIFT, pos);
             pos++;
         }
 
-        return chainback(out, pos);
+        return acs.chainback(out, pos) << SOFT_SHIFT;
     }
 
     /**
@@ -304,8 +431,7 @@ public:
     {
         static_assert(IN < 244*2, "Input size exceeds max history");
 
-        currMetricsData.fill(0);
-        prevMetricsData.fill(0);
+        acs.reset();
 
         size_t   histPos     = 0;
         size_t   punctIndex  = 0;
@@ -332,129 +458,46 @@ public:
                 if(punctIndex >= P) punctIndex = 0;
             }
 
-            decodeBit(sym[0], sym[1], histPos);
+            acs.decodeBit(sym[0] >> SOFT_SHIFT, sym[1] >> SOFT_SHIFT, histPos);
             histPos++;
         }
 
-        return chainback(out, histPos) - punctBitCnt;
+        return (acs.chainback(out, histPos) << SOFT_SHIFT) - punctBitCnt;
     }
 
-private:
-
     /**
-     * Decode one bit and update trellis.
+     * Decode convolutionally encoded data already depunctured, with one soft
+     * code symbol for each element. Punctured bits are marked with 0x7FFF.
      *
-     * @param s0: cost of the first symbol.
-     * @param s1: cost of the second symbol.
-     * @param pos: bit position in history.
+     * @param in: input code symbols.
+     * @param out: destination array where decoded data are written.
+     * @return number of bit errors corrected.
      */
-    void decodeBit(uint16_t s0, uint16_t s1, size_t pos)
+    template < size_t IN, size_t OUT >
+    uint16_t decodeDepunctured(const std::array< uint16_t, IN >& in,
+                                     std::array< uint8_t, OUT >& out)
     {
-        static constexpr uint16_t COST_TABLE_0[] = {0, 0, 0, 0, 0xFFFF,
-                                                    0xFFFF, 0xFFFF, 0xFFFF};
-        static constexpr uint16_t COST_TABLE_1[] = {0, 0xFFFF, 0xFFFF, 0,
-                                                    0, 0xFFFF, 0xFFFF, 0};
-
-        for(uint8_t i = 0; i < NumStates/2; i++)
-        {
-            uint32_t metric = q_AbsDiff(COST_TABLE_0[i], s0)
-                            + q_AbsDiff(COST_TABLE_1[i], s1);
-
-
-            uint32_t m0 = (*prevMetrics)[i] + metric;
-            uint32_t m1 = (*prevMetrics)[i + NumStates/2] + (0x1FFFE - metric);
+        static_assert(IN <= 244*2, "Input size exceeds max history");
 
-            uint32_t m2 = (*prevMetrics)[i] + (0x1FFFE - metric);
-            uint32_t m3 = (*prevMetrics)[i + NumStates/2] + metric;
+        acs.reset();
 
-            uint8_t i0 = 2 * i;
-            uint8_t i1 = i0 + 1;
-
-            if(m0 >= m1)
-            {
-                history[pos].set(i0, true);
-                (*currMetrics)[i0] = m1;
-            }
-            else
-            {
-                history[pos].set(i0, false);
-                (*currMetrics)[i0] = m0;
-            }
-
-            if(m2 >= m3)
-            {
-                history[pos].set(i1, true);
-                (*currMetrics)[i1] = m3;
-            }
-            else
-            {
-                history[pos].set(i1, false);
-                (*currMetrics)[i1] = m2;
-            }
-        }
-
-        std::swap(currMetrics, prevMetrics);
-    }
-
-    /**
-     * History chainback to obtain final byte array.
-     *
-     * @param out: destination byte array for decoded data.
-     * @param pos: starting position for the chainback.
-     * @return minimum Viterbi cost at the end of the decode sequence.
-     */
-    template < size_t OUT >
-    uint32_t chainback(std::array< uint8_t, OUT >& out, size_t pos)
-    {
-        uint8_t state = 0;
-        size_t bitPos = OUT*8;
-
-        while(bitPos > 0)
+        uint16_t punctBitCnt = 0;
+        for(size_t i = 0; i < IN; i += 2)
         {
-            bitPos--;
-            pos--;
-            bool bit = history[pos].test(state >> 4);
-            state >>= 1;
-            if(bit) state |= 0x80;
-            setBit(out, bitPos, bit);
-        }
-
-        uint32_t cost = (*prevMetrics)[0];
+            if(in[i]     == 0x7FFF) punctBitCnt++;
+            if(in[i + 1] == 0x7FFF) punctBitCnt++;
 
-        for(size_t i = 0; i < NumStates; i++)
-        {
-            uint32_t m = (*prevMetrics)[i];
-            if(m < cost) cost = m;
+            acs.decodeBit(in[i] >> SOFT_SHIFT, in[i + 1] >> SOFT_SHIFT, i / 2);
         }
 
-        return cost;
+        return (acs.chainback(out, IN / 2) << SOFT_SHIFT) - punctBitCnt;
     }
 
-    /**
-     * Utility function to compute the absolute value of a difference between
-     * two fixed-point values.
-     *
-     * @param v1: first value
-     * @param v2: second value
-     * @return abs(v1-v2)
-     */
-    inline uint16_t q_AbsDiff(const uint16_t v1, const uint16_t v2)
-    {
-        if(v2 > v1) return v2 - v1;
-        return v1 - v2;
-    }
-
-
-    static constexpr size_t K = 5;
-    static constexpr size_t NumStates = (1 << (K - 1));
-
-    std::array< uint32_t, NumStates > *prevMetrics;
-    std::array< uint32_t, NumStates > *currMetrics;
+private:
 
-    std::array< uint32_t, NumStates >  prevMetricsData;
-    std::array< uint32_t, NumStates >  currMetricsData;
+    static constexpr uint8_t SOFT_SHIFT = 5;    ///< Soft input reduction.
 
-    std::array< std::bitset< NumStates >, 244 > history;
+    M17ViterbiAcs acs;    ///< Add-compare-select kernel.
 };
 
 }      // namespace M17
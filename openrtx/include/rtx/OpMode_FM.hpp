@@ -62,15 +62,25 @@ public:
 
     /**
      * Update the internal FSM.
-     * Application code has to call this function periodically, to ensure proper
-     * functionality.
+     * Application code has to call this function whenever one of the events
+     * returned by waitEvents() occurs, to ensure proper functionality.
      *
      * @param status: pointer to the rtxStatus_t structure containing the current
      * RTX status. Internal FSM may change the current value of the opStatus flag.
-     * @param newCfg: flag used inform the internal FSM that a new RTX configuration
-     * has been applied.
+     * @param cfgChanges: bit mask of rtxConfigField values, used to inform the
+     * internal FSM about which fields changed in the RTX configuration applied
+     * since the previous update.
      */
-    virtual void update(rtxStatus_t *const status, const bool newCfg) override;
+    virtual void update(rtxStatus_t *const status, const uint32_t cfgChanges) override;
+
+    /**
+     * Get the events the internal FSM is waiting for before its next update.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the current
+     * RTX status.
+     * @return bit mask of rtxEvent values.
+     */
+    virtual uint32_t waitEvents(const rtxStatus_t *const status) override;
 
     /**
      * Get the mode identifier corresponding to the OpMode class.
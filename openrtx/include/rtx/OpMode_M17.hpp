@@ -26,6 +26,7 @@
 #include <M17/M17Demodulator.hpp>
 #include <M17/M17Modulator.hpp>
 #include <audio_path.h>
+#include <atomic>
 #include "OpMode.hpp"
 
 /**
@@ -65,15 +66,25 @@ public:
 
     /**
      * Update the internal FSM.
-     * Application code has to call this function periodically, to ensure proper
-     * functionality.
+     * Application code has to call this function whenever one of the events
+     * returned by waitEvents() occurs, to ensure proper functionality.
      *
      * @param status: pointer to the rtxStatus_t structure containing the current
      * RTX status. Internal FSM may change the current value of the opStatus flag.
-     * @param newCfg: flag used inform the internal FSM that a new RTX configuration
-     * has been applied.
+     * @param cfgChanges: bit mask of rtxConfigField values, used to inform the
+     * internal FSM about which fields changed in the RTX configuration applied
+     * since the previous update.
      */
-    virtual void update(rtxStatus_t *const status, const bool newCfg) override;
+    virtual void update(rtxStatus_t *const status, const uint32_t cfgChanges) override;
+
+    /**
+     * Get the events the internal FSM is waiting for before its next update.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the current
+     * RTX status.
+     * @return bit mask of rtxEvent values.
+     */
+    virtual uint32_t waitEvents(const rtxStatus_t *const status) override;
 
     /**
      * Get the mode identifier corresponding to the OpMode class.
@@ -121,10 +132,27 @@ private:
      */
     void txState(rtxStatus_t *const status);
 
+    /**
+     * Callback of the baseband input stream, called when a new block of
+     * samples is ready. On the MCU targets it runs in interrupt context.
+     *
+     * @param arg: pointer to the OpMode_M17 instance.
+     */
+    static void basebandReady(void *arg);
+
+    /**
+     * Callback of the audio codec, called when a new encoded frame is ready.
+     *
+     * @param arg: unused.
+     */
+    static void codecFrameReady(void *arg);
 
     bool startRx;                      ///< Flag for RX management.
     bool startTx;                      ///< Flag for TX management.
     bool locked;                       ///< Demodulator locked on data stream.
+    bool txHalfFrame;                  ///< First half of TX payload ready.
+    std::atomic< bool > rxBlock;       ///< Baseband block ready to be demodulated.
+    M17::payload_t txPayload;          ///< TX payload being assembled.
     pathId rxAudioPath;                ///< Audio path ID for RX
     pathId txAudioPath;                ///< Audio path ID for TX
     M17::M17Modulator    modulator;    ///< M17 modulator.
@@ -92,13 +92,48 @@ enum opstatus
     TX  = 2         /**< Transmitting */
 };
 
+/**
+ * Events waking up the RTX task.
+ */
+enum rtxEvent
+{
+    RTX_EVT_NONE     = 0,           /**< Update without waiting               */
+    RTX_EVT_CONFIG   = (1 << 0),    /**< New configuration from rtx_configure */
+    RTX_EVT_BASEBAND = (1 << 1),    /**< Baseband samples ready               */
+    RTX_EVT_CODEC    = (1 << 2),    /**< Encoded voice frame ready            */
+    RTX_EVT_PTT      = (1 << 3),    /**< PTT pressed or released              */
+    RTX_EVT_TICK     = (1 << 4)     /**< Periodic timer, RSSI update          */
+};
+
+#define RTX_TICK_PERIOD 30          /**< Period of the RTX timer, in ms       */
+
+/**
+ * Fields of the RTX configuration, used to notify which ones changed when a
+ * new configuration is applied.
+ */
+enum rtxConfigField
+{
+    RTX_CFG_OPMODE     = (1 << 0),  /**< opMode                               */
+    RTX_CFG_BANDWIDTH  = (1 << 1),  /**< bandwidth                            */
+    RTX_CFG_TX_DISABLE = (1 << 2),  /**< txDisable                            */
+    RTX_CFG_SCAN       = (1 << 3),  /**< scan                                 */
+    RTX_CFG_RX_FREQ    = (1 << 4),  /**< rxFrequency                          */
+    RTX_CFG_TX_FREQ    = (1 << 5),  /**< txFrequency                          */
+    RTX_CFG_TX_POWER   = (1 << 6),  /**< txPower                              */
+    RTX_CFG_SQL_LEVEL  = (1 << 7),  /**< sqlLevel                             */
+    RTX_CFG_RX_TONE    = (1 << 8),  /**< rxToneEn, rxTone                     */
+    RTX_CFG_TX_TONE    = (1 << 9),  /**< txToneEn, txTone                     */
+    RTX_CFG_M17_CAN    = (1 << 10), /**< rxCan, txCan                         */
+    RTX_CFG_M17_ADDR   = (1 << 11), /**< source and destination addresses     */
+    RTX_CFG_RX_PHASE   = (1 << 12), /**< invertRxPhase                        */
+    RTX_CFG_ALL        = 0x1FFF     /**< All the fields                       */
+};
+
 
 /**
  * Initialise rtx stage.
- * @param m: pointer to the mutex protecting the shared configuration data
- * structure.
  */
-void rtx_init(pthread_mutex_t *m);
+void rtx_init();
 
 /**
  * Shut down rtx stage
@@ -106,10 +141,12 @@ void rtx_init(pthread_mutex_t *m);
 void rtx_terminate();
 
 /**
- * Post a new RTX configuration on the internal message queue. Data structure
- * \b must be protected by the same mutex whose pointer has been passed as a
- * parameter to rtx_init(). This driver only copies its content into the internal
- * data structure, eventual garbage collection has to be performed by caller.
+ * Publish a new RTX configuration, which is copied into an internal mailbox
+ * and applied by the RTX task at its next iteration. The RTX task reads the
+ * mailbox without taking any lock: if a configuration is published while a
+ * previous one has not been applied yet, the latter is discarded.
+ * Only the fields which differ from the configuration currently in use are
+ * reprogrammed, the value of the opStatus field is ignored.
  * @param cfg: pointer to a structure containing the new RTX configuration.
  */
 void rtx_configure(const rtxStatus_t *cfg);
@@ -121,11 +158,37 @@ void rtx_configure(const rtxStatus_t *cfg);
 rtxStatus_t rtx_getCurrentStatus();
 
 /**
- * High-level code is in charge of calling this function periodically, since it
- * contains all the RTX management functionalities.
+ * High-level code is in charge of calling this function in a loop, since it
+ * contains all the RTX management functionalities. The function blocks until
+ * one of the events the current operating mode is waiting for occurs.
  */
 void rtx_task();
 
+/**
+ * Notify one or more events to the RTX task, waking it up if it is waiting
+ * for them. This function is thread-safe but cannot be called from an
+ * interrupt handler.
+ *
+ * @param events: bit mask of rtxEvent values.
+ */
+void rtx_notify(const uint32_t events);
+
+/**
+ * Notify one or more events to the RTX task from an interrupt handler, with
+ * interrupts disabled. On Linux, where there are no interrupt handlers, this
+ * function is equivalent to rtx_notify().
+ *
+ * @param events: bit mask of rtxEvent values.
+ */
+void rtx_notifyFromIrq(const uint32_t events);
+
+/**
+ * Generate the PTT and timer events. High-level code is in charge of calling
+ * this function periodically, with a period shorter than RTX_TICK_PERIOD: it
+ * also sets the latency of the PTT detection.
+ */
+void rtx_eventTask();
+
 /**
  * Get current RSSI in dBm.
  * @return RSSI value in dBm.
@@ -20,11 +20,18 @@
 
 #include <interfaces/audio_stream.h>
 #include <audio_codec.h>
+#include <dsp_chain.hpp>
+#include <ringbuf.hpp>
+#include <profiling.h>
 #include <pthread.h>
 #include <codec2.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dsp.h>
+#include <atomic>
+#ifdef PLATFORM_LINUX
+#include <virtual_clock.h>
+#endif
 
 #define BUF_SIZE 4
 
@@ -38,13 +45,22 @@ static bool             running;
 static bool             stopThread;
 static pthread_t        codecThread;
 static pthread_mutex_t  mutex;
-static pthread_cond_t   not_empty;
-static pthread_cond_t   not_full;
 
-static uint8_t          readPos;
-static uint8_t          writePos;
-static uint8_t          numElements;
-static uint64_t         dataBuffer[BUF_SIZE];
+static codecCallback_t  frameCallback;
+static void            *frameCallbackArg;
+
+// Encoded frames queues. Producer and consumer are the codec thread and the
+// OpMode calling codec_popFrame() or codec_pushFrame(): neither side ever
+// takes a lock unless the OpMode blocks waiting for a frame.
+// When encoding, the newest BUF_SIZE frames are kept: the queue has room for
+// twice as many and the consumer drops the oldest ones in excess before
+// reading. If the consumer lags even more the queue fills up: the codec thread
+// raises encOverrun and keeps the newest frames aside, the consumer discards
+// all the stale queued frames and clears the flag, then the codec thread
+// pushes the frames kept aside and resumes.
+static SPSCRingBuffer< uint64_t, 2 * BUF_SIZE > encQueue;
+static SPSCRingBuffer< uint64_t, BUF_SIZE >     decQueue;
+static std::atomic< bool >                      encOverrun(false);
 
 #ifdef PLATFORM_MOD17
 static const uint8_t micGainPre  = 4;
@@ -57,6 +73,7 @@ static const uint8_t micGainPost = 4;
 static void *encodeFunc(void *arg);
 static void *decodeFunc(void *arg);
 static void startThread(void *(*func) (void *));
+static void flushQueue();
 
 
 void codec_init()
@@ -73,17 +90,14 @@ void codec_init()
         initCnt = 1;
     }
 
-    running     = false;
-    readPos     = 0;
-    writePos    = 0;
-    numElements = 0;
-    memset(dataBuffer, 0x00, BUF_SIZE * sizeof(uint64_t));
+    running          = false;
+    frameCallback    = NULL;
+    frameCallbackArg = NULL;
+    flushQueue();
 
     audioBuf  = ((stream_sample_t *) malloc(320 * sizeof(stream_sample_t)));
 
     pthread_mutex_init(&mutex, NULL);
-    pthread_cond_init(&not_empty, NULL);
-    pthread_cond_init(&not_full, NULL);
 }
 
 void codec_terminate()
@@ -96,8 +110,6 @@ void codec_terminate()
     if(running) codec_stop();
 
     pthread_mutex_destroy(&mutex);
-    pthread_cond_destroy(&not_empty);
-    pthread_cond_destroy(&not_full);
 
     if(audioBuf != NULL)
     {
@@ -106,6 +118,16 @@ void codec_terminate()
     }
 }
 
+bool codec_setFrameCallback(const codecCallback_t callback, void *arg)
+{
+    if(running) return false;
+
+    frameCallback    = callback;
+    frameCallbackArg = arg;
+
+    return true;
+}
+
 bool codec_startEncode(const enum AudioSource source)
 {
     if(running) return false;
@@ -122,9 +144,7 @@ bool codec_startEncode(const enum AudioSource source)
         return false;
     }
 
-    readPos     = 0;
-    writePos    = 0;
-    numElements = 0;
+    flushQueue();
     stopThread  = false;
     startThread(encodeFunc);
 
@@ -148,9 +168,7 @@ bool codec_startDecode(const enum AudioSink destination)
         return false;
     }
 
-    readPos     = 0;
-    writePos    = 0;
-    numElements = 0;
+    flushQueue();
     stopThread  = false;
     startThread(decodeFunc);
 
@@ -162,7 +180,15 @@ void codec_stop()
     if(running == false) return;
 
     stopThread = true;
+
+    #ifdef PLATFORM_LINUX
+    vclockBlock_t block = {false};
+    vclock_blockBegin(&block);
+    #endif
     pthread_join(codecThread, NULL);
+    #ifdef PLATFORM_LINUX
+    vclock_blockEnd(&block);
+    #endif
 
     running = false;
 }
@@ -171,26 +197,21 @@ bool codec_popFrame(uint8_t *frame, const bool blocking)
 {
     if(running == false) return false;
 
-    uint64_t element;
-
-    // No data available and non-blocking call: just return false.
-    if((numElements == 0) && (blocking == false))
-        return false;
-
-    // Blocking call: wait until some data is pushed
-    pthread_mutex_lock(&mutex);
-    while(numElements == 0)
+    if(encOverrun.load(std::memory_order_acquire))
     {
-        pthread_cond_wait(&not_empty, &mutex);
+        while(encQueue.empty() == false)
+            encQueue.eraseElement();
+
+        encOverrun.store(false, std::memory_order_release);
     }
 
-    element      = dataBuffer[readPos];
-    readPos      = (readPos + 1) % BUF_SIZE;
-    numElements -= 1;
-    pthread_mutex_unlock(&mutex);
+    while(encQueue.size() > BUF_SIZE)
+        encQueue.eraseElement();
+
+    uint64_t element;
+    if(encQueue.pop(element, blocking) == false)
+        return false;
 
-    // Do memcpy after mutex unlock to reduce execution time spent inside the
-    // critical section
     memcpy(frame, &element, 8);
 
     return true;
@@ -200,33 +221,10 @@ bool codec_pushFrame(const uint8_t *frame, const bool blocking)
 {
     if(running == false) return false;
 
-    // Copy data to a temporary variable before mutex lock to reduce execution
-    // time spent inside the critical section
     uint64_t element;
     memcpy(&element, frame, 8);
 
-
-    // No space available and non-blocking call: return
-    if((numElements >= BUF_SIZE) && (blocking == false))
-        return false;
-
-    // Blocking call: wait until there is some free space
-    pthread_mutex_lock(&mutex);
-    while(numElements >= BUF_SIZE)
-    {
-        pthread_cond_wait(&not_full, &mutex);
-    }
-
-    // There is free space, push data into the queue
-    dataBuffer[writePos] = element;
-    writePos = (writePos + 1) % BUF_SIZE;
-
-    // Signal that the queue is not empty
-    if(numElements == 0) pthread_cond_signal(&not_empty);
-    numElements += 1;
-
-    pthread_mutex_unlock(&mutex);
-    return true;
+    return decQueue.push(element, blocking);
 }
 
 
@@ -236,11 +234,20 @@ static void *encodeFunc(void *arg)
 {
     (void) arg;
 
-    filter_state_t dcrState;
-    dsp_resetFilterState(&dcrState);
+    #ifndef PLATFORM_LINUX
+    // Microphone conditioning, pre-amplification, DC removal and
+    // post-amplification are done in a single pass over the samples
+    DspChain< DspGain, DspDcRemoval, DspGain > micChain{DspGain(micGainPre),
+                                                        DspDcRemoval(),
+                                                        DspGain(micGainPost)};
+    #endif
 
     codec2 = codec2_create(CODEC2_MODE_3200);
 
+    // Newest frames encoded while the queue is overrun, oldest first
+    uint64_t pending[BUF_SIZE];
+    size_t   numPending = 0;
+
     while(stopThread == false)
     {
         dataBlock_t audio = inputStream_getData(audioStream);
@@ -248,14 +255,7 @@ static void *encodeFunc(void *arg)
         if(audio.data != NULL)
         {
             #ifndef PLATFORM_LINUX
-            // Pre-amplification stage
-            for(size_t i = 0; i < audio.len; i++) audio.data[i] *= micGainPre;
-
-            // DC removal
-            dsp_dcRemoval(&dcrState, audio.data, audio.len);
-
-            // Post-amplification stage
-            for(size_t i = 0; i < audio.len; i++) audio.data[i] *= micGainPost;
+            micChain.process(audio);
             #endif
 
             // CODEC2 encodes 160ms of speech into 8 bytes: here we write the
@@ -263,23 +263,36 @@ static void *encodeFunc(void *arg)
             // half and then the second one, sequentially.
             // Data ready flag is rised once all the 16 bytes contain new data.
             uint64_t frame = 0;
+            PROFILE_BEGIN(PROF_CODEC2_ENCODE);
             codec2_encode(codec2, ((uint8_t*) &frame), audio.data);
+            PROFILE_END(PROF_CODEC2_ENCODE);
 
-            pthread_mutex_lock(&mutex);
-
-            // If buffer is full erase the oldest frame
-            if(numElements >= BUF_SIZE)
+            // Once the consumer discarded the stale frames, push the ones
+            // kept aside in the meantime
+            if((numPending > 0) &&
+               (encOverrun.load(std::memory_order_acquire) == false))
             {
-                readPos = (readPos + 1) % BUF_SIZE;
+                encQueue.pushN(pending, numPending, false);
+                numPending = 0;
             }
 
-            dataBuffer[writePos] = frame;
-            writePos = (writePos + 1) % BUF_SIZE;
-
-            if(numElements == 0) pthread_cond_signal(&not_empty);
-            if(numElements < BUF_SIZE) numElements += 1;
+            bool queued = (numPending == 0) && encQueue.push(frame, false);
+            if(queued == false)
+            {
+                // Queue full: keep the newest frames aside until the
+                // consumer resynchronises
+                if(numPending == BUF_SIZE)
+                {
+                    memmove(pending, pending + 1,
+                            (BUF_SIZE - 1) * sizeof(uint64_t));
+                    numPending--;
+                }
+
+                pending[numPending++] = frame;
+                encOverrun.store(true, std::memory_order_release);
+            }
 
-            pthread_mutex_unlock(&mutex);
+            if(frameCallback != NULL) frameCallback(frameCallbackArg);
         }
     }
 
@@ -303,28 +316,19 @@ static void *decodeFunc(void *arg)
 
     while(stopThread == false)
     {
-        // Try popping data from the queue
+        // Try popping data from the queue. The thread is paced by the output
+        // stream and never sleeps on the queue, so codec_pushFrame() never
+        // has to wake it up.
         uint64_t frame   = 0;
-        bool     newData = false;
-
-        pthread_mutex_lock(&mutex);
-
-        if(numElements != 0)
-        {
-            frame        = dataBuffer[readPos];
-            readPos      = (readPos + 1) % BUF_SIZE;
-            if(numElements >= BUF_SIZE) pthread_cond_signal(&not_full);
-            numElements -= 1;
-            newData      = true;
-        }
-
-        pthread_mutex_unlock(&mutex);
+        bool     newData = decQueue.pop(frame, false);
 
         stream_sample_t *audioBuf = outputStream_getIdleBuffer(audioStream);
 
         if(newData)
         {
+            PROFILE_BEGIN(PROF_CODEC2_DECODE);
             codec2_decode(codec2, audioBuf, ((uint8_t *) &frame));
+            PROFILE_END(PROF_CODEC2_DECODE);
 
             #ifdef PLATFORM_MD3x0
             // Bump up volume a little bit, as on MD3x0 is quite low
@@ -368,3 +372,16 @@ static void startThread(void *(*func) (void *))
     #endif
 
 }
+
+/**
+ * Discard all the queued frames, to be called only when no codec thread is
+ * running.
+ */
+static void flushQueue()
+{
+    uint64_t frame;
+    while(encQueue.pop(frame, false)) ;
+    while(decQueue.pop(frame, false)) ;
+
+    encOverrun.store(false, std::memory_order_relaxed);
+}
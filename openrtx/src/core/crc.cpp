@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
+ *                                Niccolò Izzo IU2KIN                      *
+ *                                Frederik Saraci IU2NRO                   *
+ *                                Silvano Seva IU2KWO                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <crc.h>
+
+/*
+ * CRCs are computed with the slice-by-N method, processing N bytes of data at
+ * each step through N lookup tables of 256 entries. Tables are generated at
+ * compile time. On the MCUs slice-by-4 is used, taking 2kB of flash for each
+ * polynomial.
+ */
+#ifdef PLATFORM_LINUX
+static constexpr size_t SLICES = 8;
+#else
+static constexpr size_t SLICES = 4;
+#endif
+
+struct crcTable
+{
+    uint16_t t[SLICES][256];
+};
+
+/**
+ * Generate the slice-by-N tables for a 16 bit CRC, MSB first.
+ *
+ * @param poly: CRC polynomial.
+ * @return CRC tables.
+ */
+static constexpr crcTable makeTable(const uint16_t poly)
+{
+    crcTable table = {};
+
+    for(uint16_t i = 0; i < 256; i++)
+    {
+        uint16_t crc = i << 8;
+        for(uint8_t j = 0; j < 8; j++)
+            crc = (crc & 0x8000) ? ((crc << 1) ^ poly) : (crc << 1);
+
+        table.t[0][i] = crc;
+    }
+
+    for(size_t k = 1; k < SLICES; k++)
+    {
+        for(uint16_t i = 0; i < 256; i++)
+        {
+            uint16_t prev = table.t[k - 1][i];
+            table.t[k][i] = (prev << 8) ^ table.t[0][prev >> 8];
+        }
+    }
+
+    return table;
+}
+
+static constexpr crcTable ccittTable = makeTable(0x1021);
+static constexpr crcTable m17Table   = makeTable(0x5935);
+
+/**
+ * Update a 16 bit CRC with a new block of data.
+ *
+ * @param tbl: tables of the CRC polynomial.
+ * @param crc: current CRC value.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return updated CRC value.
+ */
+static uint16_t crc16_update(const crcTable& tbl, uint16_t crc,
+                             const void *data, size_t len)
+{
+    const uint8_t *buf = ((const uint8_t *) data);
+    const auto& t      = tbl.t;
+
+    while(len >= SLICES)
+    {
+        uint8_t x0 = buf[0] ^ (crc >> 8);
+        uint8_t x1 = buf[1] ^ (crc & 0xFF);
+
+        #ifdef PLATFORM_LINUX
+        crc = t[7][x0]     ^ t[6][x1]     ^ t[5][buf[2]] ^ t[4][buf[3]]
+            ^ t[3][buf[4]] ^ t[2][buf[5]] ^ t[1][buf[6]] ^ t[0][buf[7]];
+        #else
+        crc = t[3][x0] ^ t[2][x1] ^ t[1][buf[2]] ^ t[0][buf[3]];
+        #endif
+
+        buf += SLICES;
+        len -= SLICES;
+    }
+
+    while(len > 0)
+    {
+        crc = (crc << 8) ^ t[0][(crc >> 8) ^ *buf];
+        buf++;
+        len--;
+    }
+
+    return crc;
+}
+
+uint16_t crc_ccitt_update(const uint16_t crc, const void *data, const size_t len)
+{
+    return crc16_update(ccittTable, crc, data, len);
+}
+
+uint16_t crc_ccitt(const void *data, const size_t len)
+{
+    return crc16_update(ccittTable, CRC_CCITT_INIT, data, len);
+}
+
+uint16_t crc_m17_update(const uint16_t crc, const void *data, const size_t len)
+{
+    return crc16_update(m17Table, crc, data, len);
+}
+
+uint16_t crc_m17(const void *data, const size_t len)
+{
+    return crc16_update(m17Table, CRC_M17_INIT, data, len);
+}
@@ -35,36 +35,26 @@ void dsp_resetFilterState(filter_state_t *state)
 
 void dsp_dcRemoval(filter_state_t *state, audio_sample_t *buffer, size_t length)
 {
-    /*
-     * Removal of DC component performed using an high-pass filter with
-     * transfer function G(z) = (z - 1)/(z - 0.999).
-     * Recursive implementation of the filter is:
-     * y(k) = u(k) - u(k-1) + 0.999*y(k-1)
-     */
-
     if(length < 2) return;
 
-    static constexpr float alpha = 0.999f;
-    size_t pos = 0;
+    for(size_t pos = 0; pos < length; pos++)
+        buffer[pos] = dsp_dcRemovalStep(state, buffer[pos]);
+}
 
-    if(state->initialised == false)
-    {
-        state->u[1] = static_cast< float >(buffer[0]);
-        state->initialised = true;
-        pos = 1;
-    }
+void dsp_resetFixedFilterState(fixed_filter_state_t *state)
+{
+    state->u = 0;
+    state->y = 0;
+    state->initialised = false;
+}
 
-    for(; pos < length; pos++)
-    {
-        state->u[0] = static_cast< float >(buffer[pos]);
-        state->y[0] = (state->u[0])
-                    - (state->u[1])
-                    + alpha * (state->y[1]);
+void dsp_dcRemovalFixed(fixed_filter_state_t *state, audio_sample_t *buffer,
+                        size_t length)
+{
+    if(length < 2) return;
 
-        state->u[1] = state->u[0];
-        state->y[1] = state->y[0];
-        buffer[pos] = static_cast< audio_sample_t >(state->y[0] + 0.5f);
-    }
+    for(size_t pos = 0; pos < length; pos++)
+        buffer[pos] = dsp_dcRemovalFixedStep(state, buffer[pos]);
 }
 
 void dsp_invertPhase(audio_sample_t *buffer, uint16_t length)
@@ -26,7 +26,9 @@
 #include <voicePrompts.h>
 #include <graphics.h>
 #include <openrtx.h>
+#include <profiling.h>
 #include <threads.h>
+#include <trace.h>
 #include <ui.h>
 #ifdef PLATFORM_LINUX
 #include <stdlib.h>
@@ -72,6 +74,16 @@ void openrtx_init()
     sleepFor(0u, 30u);
     platform_setBacklightLevel(state.settings.brightness);
 
+    #ifdef TRACE_AT_BOOT
+    // Start tracing, keeping what happens around the first lock loss of the
+    // M17 demodulator
+    trace_setTrigger(TRACE_M17_UNLOCK, TRACE_RING_SIZE / 2);
+    trace_enable(true);
+    #endif
+
+    // Enable the cycle counter used by the execution time probes
+    profiling_init();
+
     #if defined(GPS_PRESENT)
     // Detect and initialise GPS
     state.gpsDetected = gps_detect(1000);
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <profiling.h>
+
+#ifdef ENABLE_PROFILING
+
+#include <atomic>
+#include <cstring>
+
+#ifndef PLATFORM_LINUX
+extern "C" uint32_t SystemCoreClock;
+#endif
+
+/**
+ * \internal Probe data. The statistics are protected by a sequence counter,
+ * odd while an update is in progress, allowing readers to detect and retry a
+ * copy overlapping with an update without ever blocking the writer.
+ */
+struct probe
+{
+    std::atomic< uint32_t > seq;
+    std::atomic< bool >     resetReq;
+    profStats_t             stats;
+};
+
+static probe probes[PROF_NUM_PROBES];
+
+static const char *probeNames[PROF_NUM_PROBES] =
+{
+    "RTX task",
+    "M17 demod",
+    "C2 encode",
+    "C2 decode",
+    "UI update",
+    "GFX render",
+    "State task",
+    "RTX wakeup"
+};
+
+
+static void clearStats(profStats_t& stats)
+{
+    cycleStats_reset(&stats.time);
+    memset(stats.hist, 0x00, sizeof(stats.hist));
+}
+
+void profiling_init()
+{
+    cycleCounter_init();
+}
+
+void profiling_record(const uint8_t probe, const uint32_t ticks)
+{
+    if(probe >= PROF_NUM_PROBES)
+        return;
+
+    auto&    p   = probes[probe];
+    uint32_t seq = p.seq.load(std::memory_order_relaxed);
+    p.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    profStats_t& stats = p.stats;
+    bool reset = p.resetReq.exchange(false, std::memory_order_relaxed);
+    if((stats.time.count == 0) || reset)
+        clearStats(stats);
+
+    cycleStats_update(&stats.time, ticks);
+
+    // Histogram bins are spaced by a factor of four, starting from 4us
+    uint32_t us  = ticks / profiling_ticksPerUs();
+    uint32_t bin = 0;
+    if(us > 0)
+        bin = (31 - __builtin_clz(us)) / 2;
+
+    if(bin >= PROFILING_HIST_BINS)
+        bin = PROFILING_HIST_BINS - 1;
+
+    stats.hist[bin] += 1;
+
+    p.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool profiling_getStats(const uint8_t probe, profStats_t *stats)
+{
+    if((probe >= PROF_NUM_PROBES) || (stats == nullptr))
+        return false;
+
+    auto& p = probes[probe];
+    uint32_t before, after;
+
+    do
+    {
+        before = p.seq.load(std::memory_order_acquire);
+        memcpy(stats, &p.stats, sizeof(profStats_t));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after  = p.seq.load(std::memory_order_relaxed);
+    }
+    while(((before & 1) != 0) || (before != after));
+
+    if((stats->time.count == 0) || p.resetReq.load(std::memory_order_relaxed))
+        clearStats(*stats);
+
+    return true;
+}
+
+void profiling_reset()
+{
+    for(auto& p : probes)
+        p.resetReq.store(true, std::memory_order_relaxed);
+}
+
+const char *profiling_probeName(const uint8_t probe)
+{
+    if(probe >= PROF_NUM_PROBES)
+        return "";
+
+    return probeNames[probe];
+}
+
+uint32_t profiling_ticksPerUs()
+{
+    #ifdef PLATFORM_LINUX
+    return 1000;
+    #else
+    return SystemCoreClock / 1000000;
+    #endif
+}
+
+#endif /* ENABLE_PROFILING */
@@ -39,11 +39,10 @@
 #include <gps.h>
 #endif
 #include <voicePrompts.h>
+#include <trace.h>
+#include <profiling.h>
 
 
-/* Mutex for concurrent access to RTX state variable */
-pthread_mutex_t rtx_mutex;
-
 /**
  * \internal Thread managing user input and UI
  */
@@ -56,6 +55,9 @@ void *ui_threadFunc(void *arg)
     bool        sync_rtx = true;
     long long   time     = 0;
 
+    // Fields not set by the UI are left to zero
+    memset(&rtx_cfg, 0x00, sizeof(rtxStatus_t));
+
     // Load initial state and update the UI
     ui_saveState();
     ui_updateGUI();
@@ -80,12 +82,12 @@ void *ui_threadFunc(void *arg)
 
         vp_tick();                           // continue playing voice prompts in progress if any.
 
-        // If synchronization needed take mutex and update RTX configuration
+        // If synchronization needed publish the new RTX configuration, which
+        // is copied by rtx_configure()
         if(sync_rtx)
         {
             float power = dBmToWatt(state.channel.power);
 
-            pthread_mutex_lock(&rtx_mutex);
             rtx_cfg.opMode      = state.channel.mode;
             rtx_cfg.bandwidth   = state.channel.bandwidth;
             rtx_cfg.rxFrequency = state.channel.rx_frequency;
@@ -101,16 +103,20 @@ void *ui_threadFunc(void *arg)
             strncpy(rtx_cfg.source_address,      state.settings.callsign, 10);
             strncpy(rtx_cfg.destination_address, state.m17_data.dst_addr, 10);
 
-            pthread_mutex_unlock(&rtx_mutex);
-
             rtx_configure(&rtx_cfg);
             sync_rtx = false;
         }
 
         // Update UI and render on screen, if necessary
-        if(ui_updateGUI() == true)
+        PROFILE_BEGIN(PROF_UI_UPDATE);
+        bool render = ui_updateGUI();
+        PROFILE_END(PROF_UI_UPDATE);
+
+        if(render == true)
         {
+            PROFILE_BEGIN(PROF_GFX_RENDER);
             gfx_render();
+            PROFILE_END(PROF_GFX_RENDER);
         }
 
         // 40Hz update rate for keyboard and UI
@@ -172,7 +178,15 @@ void *main_thread(void *arg)
         #endif
 
         // Run state update task
+        PROFILE_BEGIN(PROF_STATE_TASK);
         state_task();
+        PROFILE_END(PROF_STATE_TASK);
+
+        // Dump the trace buffers, if triggered
+        trace_task();
+
+        // Wake up the RTX thread on PTT edges and for its periodic tasks
+        rtx_eventTask();
 
         // Run this loop once every 5ms
         time += 5;
@@ -183,6 +197,9 @@ void *main_thread(void *arg)
     gps_terminate();
     #endif
 
+    // Wake up the RTX thread, letting it terminate
+    rtx_notify(RTX_EVT_CONFIG);
+
     return NULL;
 }
 
@@ -193,7 +210,7 @@ void *rtx_threadFunc(void *arg)
 {
     (void) arg;
 
-    rtx_init(&rtx_mutex);
+    rtx_init();
 
     while(state.devStatus == RUNNING)
     {
@@ -210,9 +227,6 @@ void *rtx_threadFunc(void *arg)
  */
 void create_threads()
 {
-    // Create RTX state mutex
-    pthread_mutex_init(&rtx_mutex, NULL);
-
     // Create rtx radio thread
     pthread_t      rtx_thread;
     pthread_attr_t rtx_attr;
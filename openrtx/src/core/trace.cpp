@@ -0,0 +1,322 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <trace.h>
+
+#ifdef ENABLE_TRACE
+
+#include <cycle_counter.h>
+#include <pthread.h>
+#include <atomic>
+
+#ifdef PLATFORM_LINUX
+#include <cstdio>
+#include <cstdlib>
+#else
+#include <usb_vcom.h>
+extern "C" uint32_t SystemCoreClock;
+#endif
+
+static_assert(sizeof(traceRecord_t) == 16, "Unexpected trace record size");
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0,
+              "Trace buffer size must be a power of two");
+
+static constexpr size_t DUMP_CHUNK = 16;    // Records written at each time
+
+/**
+ * \internal Trace buffer of a thread. Only the owner thread writes the records
+ * and advances the head, which counts the records written since the buffer
+ * has been cleared.
+ *
+ * On Linux a buffer is released when its owner terminates. It keeps the
+ * records of the terminated thread until the buffers are cleared, at the next
+ * start of tracing, and only then it can be assigned to another thread: all
+ * the records of a buffer always come from the same thread. On the other
+ * targets the traced threads are created at boot and never terminate, thus
+ * the buffers are assigned once. Records of the threads exceeding the number
+ * of buffers are dropped and counted in the dump header.
+ */
+struct traceRing
+{
+    std::atomic< bool >      claimed;
+    std::atomic< bool >      ready;
+    std::atomic< bool >      released;
+    std::atomic< pthread_t > owner;
+    std::atomic< uint32_t >  head;
+    traceRecord_t            records[TRACE_RING_SIZE];
+};
+
+static traceRing               rings[TRACE_THREADS];
+static std::atomic< bool >     enabled(false);
+static std::atomic< bool >     triggered(false);
+static std::atomic< uint8_t >  trigEvent(TRACE_NONE);
+static std::atomic< bool >     trigArmed(false);
+static std::atomic< int32_t >  trigCount(0);
+static uint32_t                trigPost = 0;
+static std::atomic< uint32_t > dropped(0);
+
+#ifdef PLATFORM_LINUX
+static pthread_once_t          keyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t           ringKey;
+
+/**
+ * \internal Release the trace buffer of a terminated thread. The buffer stays
+ * claimed, to preserve its records, until the next clear.
+ */
+static void releaseRing(void *arg)
+{
+    auto *ring = static_cast< traceRing * >(arg);
+    ring->ready.store(false, std::memory_order_relaxed);
+    ring->released.store(true, std::memory_order_release);
+}
+
+static void createKey()
+{
+    pthread_key_create(&ringKey, releaseRing);
+}
+#endif
+
+/**
+ * \internal Get the trace buffer of the calling thread, assigning it one if
+ * needed.
+ */
+static traceRing *getRing(uint8_t& index)
+{
+    pthread_t self = pthread_self();
+
+    for(uint8_t i = 0; i < TRACE_THREADS; i++)
+    {
+        if(rings[i].ready.load(std::memory_order_acquire) &&
+           pthread_equal(rings[i].owner.load(std::memory_order_relaxed), self))
+        {
+            index = i;
+            return &rings[i];
+        }
+    }
+
+    for(uint8_t i = 0; i < TRACE_THREADS; i++)
+    {
+        bool expected = false;
+        if(rings[i].claimed.compare_exchange_strong(expected, true))
+        {
+            #ifdef PLATFORM_LINUX
+            pthread_once(&keyOnce, createKey);
+            pthread_setspecific(ringKey, &rings[i]);
+            #endif
+
+            rings[i].owner.store(self, std::memory_order_relaxed);
+            rings[i].ready.store(true, std::memory_order_release);
+            index = i;
+            return &rings[i];
+        }
+    }
+
+    return nullptr;
+}
+
+static void clearRings()
+{
+    for(auto& ring : rings)
+    {
+        ring.head.store(0, std::memory_order_relaxed);
+
+        // Buffers of terminated threads become available again
+        if(ring.released.exchange(false, std::memory_order_acquire))
+            ring.claimed.store(false, std::memory_order_release);
+    }
+
+    dropped.store(0, std::memory_order_relaxed);
+}
+
+void trace_record(const uint8_t event, const int16_t arg0, const int32_t arg1,
+                  const int32_t arg2)
+{
+    if(enabled.load(std::memory_order_relaxed) == false)
+        return;
+
+    uint8_t    index;
+    traceRing *ring = getRing(index);
+    if(ring == nullptr)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t       head   = ring->head.load(std::memory_order_relaxed);
+    traceRecord_t& record = ring->records[head & (TRACE_RING_SIZE - 1)];
+    record.time   = cycleCounter_get();
+    record.event  = event;
+    record.thread = index;
+    record.arg0   = arg0;
+    record.arg1   = arg1;
+    record.arg2   = arg2;
+    ring->head.store(head + 1, std::memory_order_release);
+
+    // Trigger handling: stop after the requested number of records
+    if((event == trigEvent.load(std::memory_order_relaxed)) &&
+       trigArmed.exchange(false, std::memory_order_relaxed))
+    {
+        trigCount.store(trigPost, std::memory_order_relaxed);
+        triggered.store(true, std::memory_order_release);
+        return;
+    }
+
+    if(triggered.load(std::memory_order_relaxed) &&
+       (trigCount.fetch_sub(1, std::memory_order_relaxed) <= 1))
+    {
+        enabled.store(false, std::memory_order_relaxed);
+    }
+}
+
+void trace_enable(const bool enable)
+{
+    if(enable)
+    {
+        cycleCounter_init();
+        clearRings();
+        triggered.store(false, std::memory_order_relaxed);
+        trigArmed.store(trigEvent.load() != TRACE_NONE, std::memory_order_relaxed);
+    }
+
+    enabled.store(enable, std::memory_order_release);
+}
+
+bool trace_isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void trace_setTrigger(const uint8_t event, const uint32_t postRecords)
+{
+    trigPost = postRecords;
+    trigEvent.store(event, std::memory_order_relaxed);
+    trigArmed.store(event != TRACE_NONE, std::memory_order_relaxed);
+    triggered.store(false, std::memory_order_relaxed);
+}
+
+bool trace_isTriggered()
+{
+    return triggered.load(std::memory_order_acquire) &&
+           (enabled.load(std::memory_order_relaxed) == false);
+}
+
+size_t trace_dump(traceWrite_t write, void *arg)
+{
+    enabled.store(false, std::memory_order_relaxed);
+
+    /*
+     * A thread which checked the enable flag before it was cleared can still
+     * write one last record, in the slot following its latest one: when the
+     * buffer is full that is the oldest record, which is then left out.
+     */
+    uint32_t heads[TRACE_THREADS];
+    uint32_t total = 0;
+    for(size_t i = 0; i < TRACE_THREADS; i++)
+    {
+        heads[i] = rings[i].head.load(std::memory_order_acquire);
+        total   += (heads[i] < TRACE_RING_SIZE) ? heads[i] : (TRACE_RING_SIZE - 1);
+    }
+
+    traceHeader_t header;
+    header.magic      = TRACE_MAGIC;
+    header.version    = TRACE_VERSION;
+    header.recordSize = sizeof(traceRecord_t);
+    #ifdef PLATFORM_LINUX
+    header.timeBase   = 1000000000;
+    #else
+    header.timeBase   = SystemCoreClock;
+    #endif
+    header.dumpTime   = cycleCounter_get();
+    header.numRecords = total;
+    header.dropped    = dropped.load(std::memory_order_relaxed);
+
+    if(write(&header, sizeof(header), arg) == false)
+        return 0;
+
+    traceRecord_t chunk[DUMP_CHUNK];
+    size_t        dumped = 0;
+
+    for(size_t i = 0; i < TRACE_THREADS; i++)
+    {
+        uint32_t start = 0;
+        if(heads[i] >= TRACE_RING_SIZE)
+            start = heads[i] - TRACE_RING_SIZE + 1;
+
+        uint32_t pos = start;
+        while(pos < heads[i])
+        {
+            size_t num = 0;
+            while((num < DUMP_CHUNK) && (pos < heads[i]))
+            {
+                chunk[num] = rings[i].records[pos & (TRACE_RING_SIZE - 1)];
+                num++;
+                pos++;
+            }
+
+            if(write(chunk, num * sizeof(traceRecord_t), arg) == false)
+                return dumped;
+
+            dumped += num;
+        }
+    }
+
+    triggered.store(false, std::memory_order_relaxed);
+
+    return dumped;
+}
+
+#ifdef PLATFORM_LINUX
+static bool writeFile(const void *data, const size_t len, void *arg)
+{
+    return fwrite(data, 1, len, static_cast< FILE * >(arg)) == len;
+}
+#else
+static bool writeVcom(const void *data, const size_t len, void *arg)
+{
+    (void) arg;
+
+    return vcom_writeBlock(data, len) == static_cast< ssize_t >(len);
+}
+#endif
+
+void trace_task()
+{
+    if(trace_isTriggered() == false)
+        return;
+
+    #ifdef PLATFORM_LINUX
+    const char *path = getenv("OPENRTX_TRACE_FILE");
+    if(path == NULL)
+        path = "trace.bin";
+
+    FILE *file = fopen(path, "ab");
+    if(file != NULL)
+    {
+        trace_dump(writeFile, file);
+        fclose(file);
+    }
+    #else
+    trace_dump(writeVcom, NULL);
+    #endif
+
+    trace_enable(true);
+}
+
+#endif /* ENABLE_TRACE */
@@ -0,0 +1,197 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <M17/M17Deframer.hpp>
+#include <M17/M17Interleaver.hpp>
+#include <M17/M17Decorrelator.hpp>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace M17;
+
+static constexpr size_t   SYNC_BITS = 16;       // Sync word length
+static constexpr size_t   DATA_BITS = 368;      // Frame length, without sync word
+static constexpr size_t   LICH_BITS = 96;       // LICH length
+static constexpr uint16_t ERASURE   = 0xFFFF;   // Punctured code symbol
+static constexpr uint16_t INVERT    = 0x8000;   // Bit inverted by decorrelation
+
+/*
+ * Deframing table: for each output bit or code symbol, the position of the
+ * source bit in the raw frame, with the INVERT flag set when the bit has to be
+ * decorrelated, or ERASURE for a punctured symbol.
+ */
+template < size_t N >
+struct deframerTable
+{
+    uint16_t index[N];
+};
+
+/**
+ * Compute the position in the raw frame of a bit of the deinterleaved frame
+ * data, together with its decorrelation flag.
+ *
+ * @param bit: position of the bit in the deinterleaved frame data.
+ * @return position of the bit in the raw frame, including decorrelation flag.
+ */
+static constexpr uint16_t framePosition(const size_t bit)
+{
+    size_t pos = Interleaver< DATA_BITS >::table.forward[bit];
+    bool   inv = (sequence[pos / 8] >> (7 - (pos % 8))) & 0x01;
+
+    return (SYNC_BITS + pos) | (inv ? INVERT : 0);
+}
+
+/**
+ * Compute the deframing table for a section of the frame data.
+ *
+ * @param offset: position of the first bit of the section in the
+ * deinterleaved frame data.
+ * @param puncture: puncturing matrix applied to the section.
+ * @return deframing table.
+ */
+template < size_t N, size_t P >
+static constexpr deframerTable< N > makeTable(const size_t offset,
+                                              const std::array< uint8_t, P >& puncture)
+{
+    deframerTable< N > table = {};
+    size_t bit = offset;
+
+    for(size_t i = 0; i < N; i++)
+    {
+        if(puncture[i % P])
+            table.index[i] = framePosition(bit++);
+        else
+            table.index[i] = ERASURE;
+    }
+
+    return table;
+}
+
+/**
+ * Count the frame bits carrying a given number of depunctured code symbols.
+ *
+ * @param symbols: number of code symbols.
+ * @param puncture: puncturing matrix.
+ * @return number of bits not punctured out.
+ */
+template < size_t P >
+static constexpr size_t puncturedBits(const size_t symbols,
+                                      const std::array< uint8_t, P >& puncture)
+{
+    size_t count = 0;
+
+    for(size_t i = 0; i < symbols; i++)
+    {
+        if(puncture[i % P])
+            count++;
+    }
+
+    return count;
+}
+
+static_assert(puncturedBits(LSF_SYMBOLS, LSF_PUNCTURE) == DATA_BITS,
+              "LSF code symbols do not fill the frame");
+static_assert(LICH_BITS + puncturedBits(STREAM_SYMBOLS, DATA_PUNCTURE) == DATA_BITS,
+              "Stream frame code symbols do not fill the frame");
+
+static constexpr std::array< uint8_t, 1 > NO_PUNCTURE = { 1 };
+
+static constexpr auto lichTable   = makeTable< LICH_BITS >(0, NO_PUNCTURE);
+static constexpr auto lsfTable    = makeTable< LSF_SYMBOLS >(0, LSF_PUNCTURE);
+static constexpr auto streamTable = makeTable< STREAM_SYMBOLS >(LICH_BITS,
+                                                                DATA_PUNCTURE);
+
+template < size_t N >
+static inline void deframe(const frame_t& frame, const deframerTable< N >& table,
+                           std::array< uint8_t, N >& symbols)
+{
+    for(size_t i = 0; i < N; i++)
+    {
+        uint16_t pos = table.index[i];
+
+        if(pos == ERASURE)
+        {
+            symbols[i] = 1;
+        }
+        else
+        {
+            bool bit   = getBit(frame, pos & ~INVERT) ^ (pos >> 15);
+            symbols[i] = bit ? 2 : 0;
+        }
+    }
+}
+
+template < size_t N >
+static inline void deframe(const soft_frame_t& frame,
+                           const deframerTable< N >& table,
+                           std::array< uint16_t, N >& symbols)
+{
+    for(size_t i = 0; i < N; i++)
+    {
+        uint16_t pos = table.index[i];
+
+        if(pos == ERASURE)
+            symbols[i] = 0x7FFF;
+        else
+            symbols[i] = frame[pos & ~INVERT] ^ ((pos & INVERT) ? 0xFFFF : 0x0000);
+    }
+}
+
+
+void Deframer::lich(const frame_t& frame, lich_t& lich)
+{
+    for(size_t i = 0; i < lich.size(); i++)
+    {
+        const uint16_t *idx = &lichTable.index[8 * i];
+        uint8_t byte = 0;
+
+        for(size_t j = 0; j < 8; j++)
+        {
+            bool bit = getBit(frame, idx[j] & ~INVERT) ^ (idx[j] >> 15);
+            byte     = (byte << 1) | bit;
+        }
+
+        lich[i] = byte;
+    }
+}
+
+void Deframer::lsf(const frame_t& frame,
+                   std::array< uint8_t, LSF_SYMBOLS >& symbols)
+{
+    deframe(frame, lsfTable, symbols);
+}
+
+void Deframer::lsf(const soft_frame_t& frame,
+                   std::array< uint16_t, LSF_SYMBOLS >& symbols)
+{
+    deframe(frame, lsfTable, symbols);
+}
+
+void Deframer::stream(const frame_t& frame,
+                      std::array< uint8_t, STREAM_SYMBOLS >& symbols)
+{
+    deframe(frame, streamTable, symbols);
+}
+
+void Deframer::stream(const soft_frame_t& frame,
+                      std::array< uint16_t, STREAM_SYMBOLS >& symbols)
+{
+    deframe(frame, streamTable, symbols);
+}
@@ -26,129 +26,22 @@
 #include <interfaces/audio_stream.h>
 #include <math.h>
 #include <cstring>
+#include <algorithm>
 #include <stdio.h>
+#include <trace.h>
+#include <profiling.h>
 
 using namespace M17;
 
-#ifdef ENABLE_DEMOD_LOG
 
-#include <ringbuf.h>
-#include <atomic>
-#ifndef PLATFORM_LINUX
-#include <usb_vcom.h>
-#endif
 
-typedef struct
-{
-    int16_t sample;
-    int32_t conv;
-    float   conv_th;
-    int32_t sample_index;
-    float   qnt_pos_avg;
-    float   qnt_neg_avg;
-    int32_t symbol;
-    int32_t frame_index;
-    uint8_t flags;
-    uint8_t _empty;
-}
-__attribute__((packed)) log_entry_t;
-
-#ifdef PLATFORM_LINUX
-#define LOG_QUEUE 160000
+#ifdef M17_RX_FIXED_POINT
+M17Demodulator::M17Demodulator() : rxChain(DspDcRemovalFixed(),
+                                           DspFirQ15< rrc_taps_24k_q15.size() >(rrc_taps_24k_q15))
 #else
-#define LOG_QUEUE 1024
+M17Demodulator::M17Demodulator() : rxChain(DspDcRemoval(),
+                                           DspFir< rrc_taps_24k.size() >(rrc_taps_24k))
 #endif
-
-static RingBuffer< log_entry_t, LOG_QUEUE > logBuf;
-static std::atomic_bool dumpData;
-static bool      logRunning;
-static bool      trigEnable;
-static bool      triggered;
-static uint32_t  trigCnt;
-static pthread_t logThread;
-
-static void *logFunc(void *arg)
-{
-    (void) arg;
-
-    #ifdef PLATFORM_LINUX
-    FILE *csv_log = fopen("demod_log.csv", "w");
-    fprintf(csv_log, "Sample,Convolution,Threshold,Index,Max,Min,Symbol,I,Flags\n");
-    #endif
-
-    uint8_t emptyCtr = 0;
-
-    while(logRunning)
-    {
-        if(dumpData)
-        {
-            // Log up to four entries filled with zeroes before terminating
-            // the dump.
-            log_entry_t entry;
-            memset(&entry, 0x00, sizeof(log_entry_t));
-            if(logBuf.pop(entry, false) == false) emptyCtr++;
-
-            if(emptyCtr >= 100)
-            {
-                dumpData = false;
-                emptyCtr = 0;
-                #ifdef PLATFORM_LINUX
-                logRunning = false;
-                #endif
-            }
-
-            #ifdef PLATFORM_LINUX
-            fprintf(csv_log, "%" PRId16 ",%d,%f,%d,%f,%f,%d,%d,%d\n",
-                    entry.sample,
-                    entry.conv,
-                    entry.conv_th,
-                    entry.sample_index,
-                    entry.qnt_pos_avg,
-                    entry.qnt_neg_avg,
-                    entry.symbol,
-                    entry.frame_index,
-                    entry.flags);
-            fflush(csv_log);
-            #else
-            vcom_writeBlock(&entry, sizeof(log_entry_t));
-            #endif
-        }
-    }
-
-    #ifdef PLATFORM_LINUX
-    fclose(csv_log);
-    exit(-1);
-    #endif
-
-    return NULL;
-}
-
-static inline void pushLog(const log_entry_t& e)
-{
-    /*
-     * 1) do not push data to log while dump is in progress
-     * 2) if triggered, increase the counter
-     * 3) fill half of the buffer with entries after the trigger, then start dump
-     * 4) if buffer is full, erase the oldest element
-     * 5) push data without blocking
-     */
-
-    if(dumpData) return;
-    if(triggered) trigCnt++;
-    if(trigCnt >= LOG_QUEUE/2)
-    {
-        dumpData  = true;
-        triggered = false;
-        trigCnt   = 0;
-    }
-    if(logBuf.full()) logBuf.eraseElement();
-    logBuf.push(e, false);
-}
-
-#endif
-
-
-M17Demodulator::M17Demodulator()
 {
 
 }
@@ -169,21 +62,24 @@ void M17Demodulator::init()
     baseband_buffer = std::make_unique< int16_t[] >(2 * M17_SAMPLE_BUF_SIZE);
     demodFrame      = std::make_unique< frame_t >();
     readyFrame      = std::make_unique< frame_t >();
+    softDemodFrame  = std::make_unique< soft_frame_t >();
+    softReadyFrame  = std::make_unique< soft_frame_t >();
+    window          = std::make_unique< int16_t[] >(M17_BRIDGE_SIZE + M17_SAMPLE_BUF_SIZE);
     baseband        = { nullptr, 0 };
     frame_index     = 0;
     phase           = 0;
+    timingError     = 0;
     syncDetected    = false;
+    timingLocked    = false;
     locked          = false;
     newFrame        = false;
+    frameDone       = false;
+    lockHold        = false;
 
-    #ifdef ENABLE_DEMOD_LOG
-    logRunning = true;
-    triggered  = false;
-    dumpData   = false;
-    trigEnable = false;
-    trigCnt    = 0;
-    pthread_create(&logThread, NULL, logFunc, NULL);
-    #endif
+    resetCorrelationStats();
+    resetQuantizationStats();
+    rxChain.reset();
+    rxChain.stage< 1 >().setInvert(false);
 }
 
 void M17Demodulator::terminate()
@@ -196,13 +92,13 @@ void M17Demodulator::terminate()
     baseband_buffer.reset();
     demodFrame.reset();
     readyFrame.reset();
-
-    #ifdef ENABLE_DEMOD_LOG
-    logRunning = false;
-    #endif
+    softDemodFrame.reset();
+    softReadyFrame.reset();
+    window.reset();
 }
 
-void M17Demodulator::startBasebandSampling()
+void M17Demodulator::startBasebandSampling(streamCallback_t callback,
+                                           void *arg)
 {
     basebandPath = audioPath_request(SOURCE_RTX, SINK_MCU, PRIO_RX);
     basebandId = inputStream_start(SOURCE_RTX, PRIO_RX,
@@ -210,11 +106,12 @@ void M17Demodulator::startBasebandSampling()
                                    2 * M17_SAMPLE_BUF_SIZE,
                                    BUF_CIRC_DOUBLE,
                                    M17_RX_SAMPLE_RATE);
+    inputStream_setCallback(basebandId, callback, arg);
     // Clean start of the demodulation statistics
     resetCorrelationStats();
     resetQuantizationStats();
     // DC removal filter reset
-    dsp_resetFilterState(&dsp_state);
+    rxChain.stage< 0 >().reset();
 }
 
 void M17Demodulator::stopBasebandSampling()
@@ -224,6 +121,7 @@ void M17Demodulator::stopBasebandSampling()
      phase = 0;
      syncDetected = false;
      locked = false;
+     lockHold = false;
 }
 
 void M17Demodulator::resetCorrelationStats()
@@ -248,19 +146,18 @@ float M17Demodulator::getCorrelationStddev()
 
 void M17Demodulator::resetQuantizationStats()
 {
-    qnt_pos_avg = 0.0f;
-    qnt_neg_avg = 0.0f;
+    qnt_pos_cnt = 0;
+    qnt_neg_cnt = 0;
+    qnt_pos_acc = 0;
+    qnt_neg_acc = 0;
+    qnt_pos_th  = 0;
+    qnt_neg_th  = 0;
 }
 
 void M17Demodulator::updateQuantizationStats(int32_t frame_index,
                                              int32_t symbol_index)
 {
-    int16_t sample = 0;
-    // When we are at negative indices use bridge buffer
-    if (symbol_index < 0)
-        sample = basebandBridge[M17_BRIDGE_SIZE + symbol_index];
-    else
-        sample = baseband.data[symbol_index];
+    int16_t sample = baseband.data[symbol_index];
     if (sample > 0)
     {
         qnt_pos_acc += sample;
@@ -271,11 +168,19 @@ void M17Demodulator::updateQuantizationStats(int32_t frame_index,
         qnt_neg_acc += sample;
         qnt_neg_cnt++;
     }
-    // If we reached end of the syncword, compute average and reset queue
+    // If we reached end of the syncword, compute the quantization thresholds
+    // as 2/3 of the average amplitude of the samples and reset queue
     if(frame_index == M17_SYNCWORD_SYMBOLS - 1)
     {
-        qnt_pos_avg = qnt_pos_acc / static_cast<float>(qnt_pos_cnt);
-        qnt_neg_avg = qnt_neg_acc / static_cast<float>(qnt_neg_cnt);
+        #ifdef M17_RX_FIXED_POINT
+        if(qnt_pos_cnt > 0) qnt_pos_th = (2 * qnt_pos_acc) / (3 * qnt_pos_cnt);
+        if(qnt_neg_cnt > 0) qnt_neg_th = (2 * qnt_neg_acc) / (3 * qnt_neg_cnt);
+        #else
+        float qnt_pos_avg = qnt_pos_acc / static_cast<float>(qnt_pos_cnt);
+        float qnt_neg_avg = qnt_neg_acc / static_cast<float>(qnt_neg_cnt);
+        qnt_pos_th = static_cast< int16_t >(qnt_pos_avg / 1.5f);
+        qnt_neg_th = static_cast< int16_t >(qnt_neg_avg / 1.5f);
+        #endif
         qnt_pos_acc = 0;
         qnt_neg_acc = 0;
         qnt_pos_cnt = 0;
@@ -288,21 +193,37 @@ int32_t M17Demodulator::convolution(int32_t offset,
                                     size_t target_size)
 {
     // Compute convolution
+    const int16_t *samples = &baseband.data[offset];
     int32_t conv = 0;
     for(uint32_t i = 0; i < target_size; i++)
     {
-        int32_t sample_index = offset + i * M17_SAMPLES_PER_SYMBOL;
-        int16_t sample = 0;
-        // When we are at negative indices use bridge buffer
-        if (sample_index < 0)
-            sample = basebandBridge[M17_BRIDGE_SIZE + sample_index];
-        else
-            sample = baseband.data[sample_index];
-        conv += (int32_t) target[i] * (int32_t) sample;
+        int32_t sample = samples[i * M17_SAMPLES_PER_SYMBOL];
+        conv += static_cast< int32_t >(target[i]) * sample;
     }
     return conv;
 }
 
+void M17Demodulator::slidingCorrelation(int32_t offset, const int8_t *target,
+                                        int32_t *conv, size_t count)
+{
+    /*
+     * Compute the convolution for all the offsets at once, iterating over the
+     * target symbols in the outer loop. In this way the inner loop is a
+     * multiply-accumulate over contiguous samples and accumulators.
+     */
+    for(size_t i = 0; i < count; i++)
+        conv[i] = 0;
+
+    for(size_t j = 0; j < M17_SYNCWORD_SYMBOLS; j++)
+    {
+        const int16_t *samples = &baseband.data[offset + j * M17_SAMPLES_PER_SYMBOL];
+        int32_t        sym     = target[j];
+
+        for(size_t i = 0; i < count; i++)
+            conv[i] += sym * samples[i];
+    }
+}
+
 sync_t M17Demodulator::nextFrameSync(int32_t offset)
 {
 
@@ -311,38 +232,37 @@ sync_t M17Demodulator::nextFrameSync(int32_t offset)
     // Leverage the fact LSF syncword is the opposite of the frame syncword
     // to detect both syncwords at once. Stop early because convolution needs
     // access samples ahead of the starting offset.
+    // Correlation is computed in chunks of CONV_CHUNK_SIZE offsets and compared
+    // against the threshold without computing the square root of the variance:
+    // |conv| > factor * stddev is equivalent to conv^2 > factor^2 * variance.
+    static constexpr float thFactor = CONV_THRESHOLD_FACTOR * CONV_THRESHOLD_FACTOR;
     int32_t maxLen = static_cast < int32_t >(baseband.len - M17_SYNCWORD_SAMPLES);
-    for(int32_t i = offset; (syncword.index == -1) && (i < maxLen); i++)
+    int32_t convChunk[CONV_CHUNK_SIZE];
+
+    for(int32_t start = offset; (syncword.index == -1) && (start < maxLen);
+        start += CONV_CHUNK_SIZE)
     {
-        int32_t conv = convolution(i, stream_syncword, M17_SYNCWORD_SYMBOLS);
-        updateCorrelationStats(conv);
-
-        #ifdef ENABLE_DEMOD_LOG
-        log_entry_t log;
-        log.sample       = (i < 0) ? basebandBridge[M17_BRIDGE_SIZE + i] : baseband.data[i];
-        log.conv         = conv;
-        log.conv_th      = CONV_THRESHOLD_FACTOR * getCorrelationStddev();
-        log.sample_index = i;
-        log.qnt_pos_avg  = 0.0;
-        log.qnt_neg_avg  = 0.0;
-        log.symbol       = 0;
-        log.frame_index  = 0;
-        log.flags        = 1;
-
-        pushLog(log);
-        #endif
+        int32_t count = std::min(maxLen - start, +CONV_CHUNK_SIZE);
+        slidingCorrelation(start, stream_syncword, convChunk, count);
 
-        // Positive correlation peak -> frame syncword
-        if (conv > (getCorrelationStddev() * CONV_THRESHOLD_FACTOR))
+        for(int32_t j = 0; j < count; j++)
         {
-            syncword.lsf = false;
-            syncword.index = i;
-        }
-        // Negative correlation peak -> LSF syncword
-        else if (conv < -(getCorrelationStddev() * CONV_THRESHOLD_FACTOR))
-        {
-            syncword.lsf = true;
-            syncword.index = i;
+            int32_t conv = convChunk[j];
+            updateCorrelationStats(conv);
+
+            float conv2 = static_cast< float >(conv) * static_cast< float >(conv);
+
+            TRACE(TRACE_M17_CORRELATION, start + j, baseband.data[start + j], conv);
+
+            // Positive correlation peak -> frame syncword
+            // Negative correlation peak -> LSF syncword
+            if (conv2 > (conv_emvar * thFactor))
+            {
+                syncword.lsf   = (conv < 0);
+                syncword.index = start + j;
+                TRACE(TRACE_M17_SYNC, syncword.index, conv, syncword.lsf);
+                break;
+            }
         }
     }
 
@@ -351,14 +271,10 @@ sync_t M17Demodulator::nextFrameSync(int32_t offset)
 
 int8_t M17Demodulator::quantize(int32_t offset)
 {
-    int16_t sample = 0;
-    if (offset < 0) // When we are at negative offsets use bridge buffer
-        sample = basebandBridge[M17_BRIDGE_SIZE + offset];
-    else            // Otherwise use regular data buffer
-        sample = baseband.data[offset];
-    if (sample > static_cast< int16_t >(qnt_pos_avg / 1.5f))
+    int16_t sample = baseband.data[offset];
+    if (sample > qnt_pos_th)
         return +3;
-    else if (sample < static_cast< int16_t >(qnt_neg_avg / 1.5f))
+    else if (sample < qnt_neg_th)
         return -3;
     else if (sample > 0)
         return +1;
@@ -366,6 +282,53 @@ int8_t M17Demodulator::quantize(int32_t offset)
         return -1;
 }
 
+void M17Demodulator::softDemap(int32_t offset, uint16_t *bits)
+{
+    /*
+     * The quantization thresholds sit halfway between the inner and the outer
+     * symbols, thus the inner symbols are found at half the threshold and the
+     * outer ones at one and a half times the threshold. The first bit gives
+     * the sign of the symbol and goes from 0x0000 to 0xFFFF between the two
+     * inner symbols, the second bit distinguishes between inner and outer
+     * symbols and goes from 0x0000 to 0xFFFF between inner and outer symbol.
+     */
+    static constexpr int32_t SOFT_HALF = 0x7FFF;
+    static constexpr int32_t SOFT_FULL = 0xFFFF;
+
+    int32_t sample = baseband.data[offset];
+    int32_t th     = (sample >= 0) ? qnt_pos_th : -qnt_neg_th;
+
+    // No statistics available yet
+    if(th <= 0)
+    {
+        bits[0] = SOFT_HALF;
+        bits[1] = SOFT_HALF;
+        return;
+    }
+
+    int32_t mag = (sample >= 0) ? sample : -sample;
+
+    // Sign bit, one for negative symbols
+    int32_t soft;
+    if(2 * mag >= th)
+        soft = SOFT_FULL;
+    else
+        soft = SOFT_HALF + (mag * (SOFT_FULL - 1)) / th;
+
+    bits[0] = (sample >= 0) ? (SOFT_FULL - soft) : soft;
+
+    // Outer symbol bit
+    int32_t dist = mag - th;
+    if(2 * dist >= th)
+        soft = SOFT_FULL;
+    else if(-2 * dist >= th)
+        soft = 0;
+    else
+        soft = SOFT_HALF + (dist * (SOFT_FULL - 1)) / th;
+
+    bits[1] = soft;
+}
+
 const frame_t& M17Demodulator::getFrame()
 {
     // When a frame is read is not new anymore
@@ -373,9 +336,14 @@ const frame_t& M17Demodulator::getFrame()
     return *readyFrame;
 }
 
+const soft_frame_t& M17Demodulator::getSoftFrame()
+{
+    return *softReadyFrame;
+}
+
 bool M17Demodulator::isLocked()
 {
-    return locked;
+    return locked || lockHold;
 }
 
 int32_t M17Demodulator::syncwordSweep(int32_t offset)
@@ -388,26 +356,7 @@ int32_t M17Demodulator::syncwordSweep(int32_t offset)
         int32_t conv = convolution(offset + i,
                                    stream_syncword,
                                    M17_SYNCWORD_SYMBOLS);
-        #ifdef ENABLE_DEMOD_LOG
-        int16_t sample;
-        if (offset + i < 0)
-            sample = basebandBridge[M17_BRIDGE_SIZE + offset + i];
-        else
-            sample = baseband.data[offset + i];
-
-        log_entry_t log;
-        log.sample       = sample;
-        log.conv         = conv;
-        log.conv_th      = 0.0;
-        log.sample_index = offset + i;
-        log.qnt_pos_avg  = 0.0;
-        log.qnt_neg_avg  = 0.0;
-        log.symbol       = 0;
-        log.frame_index  = 0;
-        log.flags        = 2;
-
-        pushLog(log);
-        #endif
+        TRACE(TRACE_M17_SWEEP, offset + i, baseband.data[offset + i], conv);
 
         if (conv > max_conv)
         {
@@ -419,179 +368,235 @@ int32_t M17Demodulator::syncwordSweep(int32_t offset)
     return max_index;
 }
 
+int32_t M17Demodulator::updateTiming(int32_t offset)
+{
+    /*
+     * Early-late timing error detector: at the optimum sampling instant the
+     * samples one step before and one step after the symbol are, on average,
+     * equal. When sampling too early the late sample is closer to the symbol
+     * peak and thus larger in magnitude, the opposite when sampling too late.
+     * The error is integrated and the sampling phase moved by one sample when
+     * it exceeds a threshold proportional to the signal amplitude.
+     */
+    int32_t early = baseband.data[offset - 1];
+    int32_t late  = baseband.data[offset + 1];
+    int32_t error = (baseband.data[offset] >= 0) ? (late - early)
+                                                 : (early - late);
+
+    int32_t threshold = TIMING_LOOP_THRESHOLD * (qnt_pos_th - qnt_neg_th);
+    if(threshold <= 0)
+        return 0;
+
+    timingError += error;
+
+    if(timingError > threshold)
+    {
+        timingError = 0;
+        return 1;
+    }
+
+    if(timingError < -threshold)
+    {
+        timingError = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
 bool M17Demodulator::update()
+{
+    // Read samples from the ADC
+    if(audioPath_getStatus(basebandPath) != PATH_OPEN) return false;
+    dataBlock_t block = inputStream_getData(basebandId);
+    bool ret = update(block);
+
+    return ret;
+}
+
+bool M17Demodulator::update(dataBlock_t block)
+{
+    PROFILE_SCOPE(PROF_M17_DEMOD);
+
+    frameDone = false;
+    lockHold  = false;
+
+    if(block.data == NULL)
+        return newFrame;
+
+    // Larger blocks are split, the working window holds half of a frame
+    for(size_t pos = 0; pos < block.len; pos += M17_SAMPLE_BUF_SIZE)
+    {
+        size_t len = std::min(block.len - pos, +M17_SAMPLE_BUF_SIZE);
+        demodulate(block.data + pos, len);
+    }
+
+    return newFrame;
+}
+
+void M17Demodulator::demodulate(int16_t *samples, const size_t len)
 {
     sync_t syncword = { 0, false };
-    phase = (syncDetected) ? phase % M17_SAMPLES_PER_SYMBOL : -M17_BRIDGE_SIZE;
+    phase = (syncDetected) ? phase : -M17_BRIDGE_SIZE;
     uint16_t decoded_syms = 0;
 
-    // Read samples from the ADC
-    if(audioPath_getStatus(basebandPath) != PATH_OPEN) return false;
-    baseband = inputStream_getData(basebandId);
+    /*
+     * Filtered samples are placed in the working window, right after the
+     * tail of the previous block: in this way the samples with negative
+     * index are accessible from the same base pointer.
+     */
+    baseband.data = &window[M17_BRIDGE_SIZE];
+    baseband.len  = len;
+
+    // Apply DC removal filter and RRC, inverting the phase if required,
+    // in a single pass over the input block
+    rxChain.process(samples, baseband.data, len);
 
-    if(baseband.data != NULL)
+    // Process the buffer
+    while(syncword.index != -1)
     {
-        // Apply DC removal filter
-        dsp_dcRemoval(&dsp_state, baseband.data, baseband.len);
 
-        // Apply RRC on the baseband buffer
-        for(size_t i = 0; i < baseband.len; i++)
+        // If we are not demodulating a syncword, search for one
+        if (syncDetected == false)
         {
-            float elem = static_cast< float >(baseband.data[i]);
-            if(invPhase) elem = 0.0f - elem;
-            baseband.data[i]  = static_cast< int16_t >(M17::rrc_24k(elem));
-        }
+            syncword = nextFrameSync(phase);
 
-        // Process the buffer
-        while(syncword.index != -1)
+            if (syncword.index != -1) // Valid syncword found
+            {
+                phase = syncword.index + 1;
+                syncDetected = true;
+                timingLocked = false;
+                timingError  = 0;
+                frame_index  = 0;
+                decoded_syms = 0;
+            }
+        }
+        // While we detected a syncword, demodulate available samples
+        else
         {
+            // Slice the input buffer to extract a frame and quantize.
+            // The timing detector needs the sample following the symbol:
+            // if not yet available, carry the symbol to the next block.
+            int32_t symbol_index = phase
+                + (M17_SAMPLES_PER_SYMBOL * decoded_syms);
+            if ((symbol_index + 1) >= static_cast<int32_t>(baseband.len))
+            {
+                phase = symbol_index - static_cast<int32_t>(baseband.len);
+                break;
+            }
+            // Update quantization stats only on syncwords
+            if (frame_index < M17_SYNCWORD_SYMBOLS)
+                updateQuantizationStats(frame_index, symbol_index);
+            int8_t symbol = quantize(symbol_index);
+
+            TRACE(TRACE_M17_SYMBOL, symbol_index, baseband.data[symbol_index],
+                  static_cast< uint8_t >(symbol) | (frame_index << 8));
+
+            setSymbol(*demodFrame, frame_index, symbol);
+            softDemap(symbol_index, &(*softDemodFrame)[2 * frame_index]);
+            decoded_syms++;
+            frame_index++;
 
-            // If we are not demodulating a syncword, search for one
-            if (syncDetected == false)
+            // Track the clock skew between Tx and Rx symbol by symbol
+            if (timingLocked)
             {
-                syncword = nextFrameSync(phase);
+                int32_t correction = updateTiming(symbol_index);
+                if(correction != 0)
+                    TRACE(TRACE_M17_TIMING, symbol_index, timingError,
+                          correction);
 
-                if (syncword.index != -1) // Valid syncword found
-                {
-                    phase = syncword.index + 1;
-                    syncDetected = true;
-                    frame_index  = 0;
-                    decoded_syms = 0;
-                }
+                phase += correction;
             }
-            // While we detected a syncword, demodulate available samples
-            else
+
+            if (frame_index == M17_SYNCWORD_SYMBOLS)
             {
-                // Slice the input buffer to extract a frame and quantize
-                int32_t symbol_index = phase
-                    + (M17_SAMPLES_PER_SYMBOL * decoded_syms);
-                if (symbol_index >= static_cast<int32_t>(baseband.len))
-                    break;
-                // Update quantization stats only on syncwords
-                if (frame_index < M17_SYNCWORD_SYMBOLS)
-                    updateQuantizationStats(frame_index, symbol_index);
-                int8_t symbol = quantize(symbol_index);
-
-                #ifdef ENABLE_DEMOD_LOG
-                // Log quantization
-                for (int i = -2; i <= 2; i++)
+                /*
+                 * Check for valid syncword using hamming distance.
+                 * The demodulator switches to locked state only if there
+                 * is an exact syncword match, this avoids continuous false
+                 * detections in absence of an M17 signal.
+                 */
+                uint8_t maxHamming = 2;
+                if(locked == false) maxHamming = 0;
+
+                uint8_t hammingSync = hammingDistance((*demodFrame)[0],
+                                                      STREAM_SYNC_WORD[0])
+                                    + hammingDistance((*demodFrame)[1],
+                                                      STREAM_SYNC_WORD[1]);
+
+                uint8_t hammingLsf = hammingDistance((*demodFrame)[0],
+                                                     LSF_SYNC_WORD[0])
+                                   + hammingDistance((*demodFrame)[1],
+                                                     LSF_SYNC_WORD[1]);
+
+                TRACE(TRACE_M17_THRESHOLDS, symbol_index, qnt_pos_th, qnt_neg_th);
+
+                if ((hammingSync > maxHamming) && (hammingLsf > maxHamming))
                 {
-                    if ((symbol_index + i) >= 0 &&
-                        (symbol_index + i) < static_cast<int32_t> (baseband.len))
+                    // Lock lost, reset demodulator alignment (phase) only
+                    // if we were locked on a valid signal.
+                    // This to avoid, in case of absence of carrier, to fall
+                    // in a loop where the demodulator continues to search
+                    // for the syncword in the same block of samples, causing
+                    // the update function to take more than 20ms to complete.
+                    if(locked)
                     {
-                        log_entry_t log;
-                        log.sample       = baseband.data[symbol_index + i];
-                        log.conv         = phase;
-                        log.conv_th      = 0.0;
-                        log.sample_index = symbol_index + i;
-                        log.qnt_pos_avg  = qnt_pos_avg / 1.5f;
-                        log.qnt_neg_avg  = qnt_neg_avg / 1.5f;
-                        log.symbol       = symbol;
-                        log.frame_index  = frame_index;
-                        log.flags        = 3;
-                        if(i == 0) log.flags += 8;
-
-                        pushLog(log);
-                    }
-                }
-                #endif
-
-                setSymbol(*demodFrame, frame_index, symbol);
-                decoded_syms++;
-                frame_index++;
+                        TRACE(TRACE_M17_UNLOCK, phase, hammingSync, hammingLsf);
+                        phase = 0;
 
-                if (frame_index == M17_SYNCWORD_SYMBOLS)
-                {
-                    /*
-                     * Check for valid syncword using hamming distance.
-                     * The demodulator switches to locked state only if there
-                     * is an exact syncword match, this avoids continuous false
-                     * detections in absence of an M17 signal.
-                     */
-                    uint8_t maxHamming = 2;
-                    if(locked == false) maxHamming = 0;
-
-                    uint8_t hammingSync = hammingDistance((*demodFrame)[0],
-                                                          STREAM_SYNC_WORD[0])
-                                        + hammingDistance((*demodFrame)[1],
-                                                          STREAM_SYNC_WORD[1]);
-
-                    uint8_t hammingLsf = hammingDistance((*demodFrame)[0],
-                                                         LSF_SYNC_WORD[0])
-                                       + hammingDistance((*demodFrame)[1],
-                                                         LSF_SYNC_WORD[1]);
-
-                    if ((hammingSync > maxHamming) && (hammingLsf > maxHamming))
-                    {
-                        // Lock lost, reset demodulator alignment (phase) only
-                        // if we were locked on a valid signal.
-                        // This to avoid, in case of absence of carrier, to fall
-                        // in a loop where the demodulator continues to search
-                        // for the syncword in the same block of samples, causing
-                        // the update function to take more than 20ms to complete.
-                        if(locked) phase = 0;
-                        syncDetected = false;
-                        locked       = false;
-
-                        #ifdef ENABLE_DEMOD_LOG
-                        // Pre-arm the log trigger.
-                        trigEnable = true;
-                        #endif
+                        // Keep the frame just completed readable
+                        if(frameDone) lockHold = true;
                     }
-                    else
-                    {
-                        // Correct syncword found
-                        locked = true;
-
-                        #ifdef ENABLE_DEMOD_LOG
-                        // Trigger a data dump when lock is re-acquired.
-                        if((dumpData == false) && (trigEnable == true))
-                        {
-                            trigEnable = false;
-                            triggered  = true;
-                        }
-                        #endif
-                    }
-                }
 
-                // Locate syncword to correct clock skew between Tx and Rx
-                if (frame_index == M17_SYNCWORD_SYMBOLS + SYNC_SWEEP_OFFSET)
-                {
-                    // Find index (possibly negative) of the syncword
-                    int32_t expected_sync =
-                        phase +
-                        M17_SAMPLES_PER_SYMBOL * decoded_syms -
-                        M17_SYNCWORD_SAMPLES -
-                        SYNC_SWEEP_OFFSET * M17_SAMPLES_PER_SYMBOL;
-                    int32_t sync_skew = syncwordSweep(expected_sync);
-                    phase += sync_skew;
+                    syncDetected = false;
+                    locked       = false;
                 }
-
-                // If the frame buffer is full switch demod and ready frame
-                if (frame_index == M17_FRAME_SYMBOLS)
+                else
                 {
-                    demodFrame.swap(readyFrame);
-                    frame_index = 0;
-                    newFrame    = true;
+                    // Correct syncword found
+                    TRACE((locked ? TRACE_M17_FRAME : TRACE_M17_LOCK), phase,
+                          hammingSync, hammingLsf);
+                    locked = true;
                 }
             }
-        }
 
-        // Copy last N samples to bridge buffer
-        memcpy(basebandBridge,
-               baseband.data + (baseband.len - M17_BRIDGE_SIZE),
-               sizeof(int16_t) * M17_BRIDGE_SIZE);
-    }
+            // Correct the initial sampling phase locating the peak of the
+            // syncword correlation, only once after the acquisition: the
+            // timing recovery loop takes over from here.
+            if ((timingLocked == false) &&
+                (frame_index == M17_SYNCWORD_SYMBOLS + SYNC_SWEEP_OFFSET))
+            {
+                // Find index (possibly negative) of the syncword
+                int32_t expected_sync =
+                    phase +
+                    M17_SAMPLES_PER_SYMBOL * decoded_syms -
+                    M17_SYNCWORD_SAMPLES -
+                    SYNC_SWEEP_OFFSET * M17_SAMPLES_PER_SYMBOL;
+                int32_t sync_skew = syncwordSweep(expected_sync);
+                phase += sync_skew;
+                timingLocked = true;
+            }
 
-    #if defined(PLATFORM_LINUX) && defined(ENABLE_DEMOD_LOG)
-    if (baseband.data == NULL)
-        dumpData = true;
-    #endif
+            // If the frame buffer is full switch demod and ready frame
+            if (frame_index == M17_FRAME_SYMBOLS)
+            {
+                demodFrame.swap(readyFrame);
+                softDemodFrame.swap(softReadyFrame);
+                frame_index = 0;
+                newFrame    = true;
+                frameDone   = true;
+            }
+        }
+    }
 
-    return newFrame;
+    // Move last N samples to the head of the working window. With a chunk
+    // shorter than N, part of the previous bridge is kept.
+    memmove(window.get(),
+            baseband.data + (static_cast< int32_t >(baseband.len) - M17_BRIDGE_SIZE),
+            sizeof(int16_t) * M17_BRIDGE_SIZE);
 }
 
 void M17Demodulator::invertPhase(const bool status)
 {
-    invPhase = status;
+    rxChain.stage< 1 >().setInvert(status);
 }
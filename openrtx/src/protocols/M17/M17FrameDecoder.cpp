@@ -20,9 +20,7 @@
 
 #include <M17/M17Golay.hpp>
 #include <M17/M17FrameDecoder.hpp>
-#include <M17/M17Interleaver.hpp>
-#include <M17/M17Decorrelator.hpp>
-#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17Deframer.hpp>
 #include <M17/M17Constants.hpp>
 #include <M17/M17Utils.hpp>
 #include <algorithm>
@@ -43,26 +41,38 @@ void M17FrameDecoder::reset()
 
 M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
 {
-    std::array< uint8_t, 2 >  syncWord;
-    std::array< uint8_t, 46 > data;
+    auto type = getFrameType(frame);
 
-    std::copy_n(frame.begin(), 2, syncWord.begin());
-    std::copy(frame.begin() + 2, frame.end(), data.begin());
+    switch(type)
+    {
+        case M17FrameType::LINK_SETUP:
+            decodeLSF(frame);
+            break;
+
+        case M17FrameType::STREAM:
+            decodeStream(frame);
+            break;
+
+        default:
+            break;
+    }
 
-    // Re-correlating data is the same operation as decorrelating
-    decorrelate(data);
-    deinterleave(data);
+    return type;
+}
 
-    auto type = getFrameType(syncWord);
+M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame,
+                                          const soft_frame_t& softFrame)
+{
+    auto type = getFrameType(frame);
 
     switch(type)
     {
         case M17FrameType::LINK_SETUP:
-            decodeLSF(data);
+            decodeLSF(softFrame);
             break;
 
         case M17FrameType::STREAM:
-            decodeStream(data);
+            decodeStream(frame, softFrame);
             break;
 
         default:
@@ -72,16 +82,16 @@ M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
     return type;
 }
 
-M17FrameType M17FrameDecoder::getFrameType(const std::array< uint8_t, 2 >& syncWord)
+M17FrameType M17FrameDecoder::getFrameType(const frame_t& frame)
 {
     // Preamble
     M17FrameType type   = M17FrameType::PREAMBLE;
-    uint8_t minDistance = hammingDistance(syncWord[0], 0x77)
-                        + hammingDistance(syncWord[1], 0x77);
+    uint8_t minDistance = hammingDistance(frame[0], 0x77)
+                        + hammingDistance(frame[1], 0x77);
 
     // Link setup frame
-    uint8_t hammDistance = hammingDistance(syncWord[0], LSF_SYNC_WORD[0])
-                         + hammingDistance(syncWord[1], LSF_SYNC_WORD[1]);
+    uint8_t hammDistance = hammingDistance(frame[0], LSF_SYNC_WORD[0])
+                         + hammingDistance(frame[1], LSF_SYNC_WORD[1]);
     if(hammDistance < minDistance)
     {
         type = M17FrameType::LINK_SETUP;
@@ -89,8 +99,8 @@ M17FrameType M17FrameDecoder::getFrameType(const std::array< uint8_t, 2 >& syncW
     }
 
     // Stream frame
-    hammDistance = hammingDistance(syncWord[0], STREAM_SYNC_WORD[0])
-                 + hammingDistance(syncWord[1], STREAM_SYNC_WORD[1]);
+    hammDistance = hammingDistance(frame[0], STREAM_SYNC_WORD[0])
+                 + hammingDistance(frame[1], STREAM_SYNC_WORD[1]);
     if(hammDistance < minDistance)
     {
         type = M17FrameType::STREAM;
@@ -107,21 +117,62 @@ M17FrameType M17FrameDecoder::getFrameType(const std::array< uint8_t, 2 >& syncW
     return type;
 }
 
-void M17FrameDecoder::decodeLSF(const std::array< uint8_t, 46 >& data)
+void M17FrameDecoder::decodeLSF(const frame_t& frame)
 {
+    std::array< uint8_t, LSF_SYMBOLS > symbols;
     std::array< uint8_t, sizeof(M17LinkSetupFrame) > tmp;
 
-    viterbi.decodePunctured(data, tmp, LSF_PUNCTURE);
+    Deframer::lsf(frame, symbols);
+    viterbi.decodeDepunctured(symbols, tmp);
     memcpy(&lsf.data, tmp.data(), tmp.size());
 }
 
-void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
+void M17FrameDecoder::decodeLSF(const soft_frame_t& softFrame)
+{
+    std::array< uint16_t, LSF_SYMBOLS > symbols;
+    std::array< uint8_t, sizeof(M17LinkSetupFrame) > tmp;
+
+    Deframer::lsf(softFrame, symbols);
+    softViterbi.decodeDepunctured(symbols, tmp);
+    memcpy(&lsf.data, tmp.data(), tmp.size());
+}
+
+void M17FrameDecoder::decodeStream(const frame_t& frame)
 {
-    // Extract and unpack the LICH segment contained at beginning of frame
     lich_t lich;
+    Deframer::lich(frame, lich);
+    updateLsfFromLich(lich);
+
+    // Extract and decode stream data
+    std::array< uint8_t, STREAM_SYMBOLS > symbols;
+    std::array< uint8_t, sizeof(M17StreamFrame) > tmp;
+
+    Deframer::stream(frame, symbols);
+    viterbi.decodeDepunctured(symbols, tmp);
+    memcpy(&streamFrame.data, tmp.data(), tmp.size());
+}
+
+void M17FrameDecoder::decodeStream(const frame_t& frame,
+                                   const soft_frame_t& softFrame)
+{
+    lich_t lich;
+    Deframer::lich(frame, lich);
+    updateLsfFromLich(lich);
+
+    // Extract and decode stream data
+    std::array< uint16_t, STREAM_SYMBOLS > symbols;
+    std::array< uint8_t, sizeof(M17StreamFrame) > tmp;
+
+    Deframer::stream(softFrame, symbols);
+    softViterbi.decodeDepunctured(symbols, tmp);
+    memcpy(&streamFrame.data, tmp.data(), tmp.size());
+}
+
+void M17FrameDecoder::updateLsfFromLich(const lich_t& lich)
+{
+    // Unpack the LICH segment contained at beginning of frame
     std::array < uint8_t, 6 > lsfSegment;
 
-    std::copy_n(data.begin(), lich.size(), lich.begin());
     bool decodeOk = decodeLich(lsfSegment, lich);
 
     if(decodeOk)
@@ -144,17 +195,6 @@ void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
             lsfFromLich.clear();
         }
     }
-
-    // Extract and decode stream data
-    std::array< uint8_t, 34 > punctured;
-    std::array< uint8_t, sizeof(M17StreamFrame) > tmp;
-
-    auto begin = data.begin();
-    begin     += lich.size();
-    std::copy(begin, data.end(), punctured.begin());
-
-    viterbi.decodePunctured(punctured, tmp, DATA_PUNCTURE);
-    memcpy(&streamFrame.data, tmp.data(), tmp.size());
 }
 
 bool M17FrameDecoder::decodeLich(std::array < uint8_t, 6 >& segment,
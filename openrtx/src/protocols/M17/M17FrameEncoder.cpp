@@ -60,14 +60,11 @@ void M17FrameEncoder::encodeLsf(M17LinkSetupFrame& lsf, frame_t& output)
         lichSegments[i] = lsf.generateLichSegment(i);
     }
 
-    // Encode the LSF, then puncture and decorrelate its data
-    std::array<uint8_t, 61> encoded;
-    encoder.reset();
-    encoder.encode(lsf.getData(), encoded.data(), sizeof(M17LinkSetupFrame));
-    encoded[60] = encoder.flush();
-
+    // Encode and puncture the LSF, then interleave and decorrelate its data
     std::array<uint8_t, 46> punctured;
-    puncture(encoded, punctured, LSF_PUNCTURE);
+    encoder.reset();
+    encoder.encodePunctured(lsf.getData(), sizeof(M17LinkSetupFrame),
+                            punctured, LSF_PUNCTURE);
     interleave(punctured);
     decorrelate(punctured);
 
@@ -87,21 +84,15 @@ uint16_t M17FrameEncoder::encodeStreamFrame(const payload_t& payload,
     if(isLast) streamFrame.lastFrame();
     std::copy(payload.begin(), payload.end(), streamFrame.payload().begin());
 
-    // Encode frame
-    std::array<uint8_t, 37> encoded;
-    encoder.reset();
-    encoder.encode(streamFrame.getData(), encoded.data(), sizeof(M17StreamFrame));
-    encoded[36] = encoder.flush();
-
-    std::array<uint8_t, 34> punctured;
-    puncture(encoded, punctured, DATA_PUNCTURE);
-
-    // Add LICH segment to coded data
+    // Add LICH segment, followed by the encoded and punctured frame data
     std::array<uint8_t, 46> frame;
-    auto it = std::copy(lichSegments[currentLich].begin(),
-                        lichSegments[currentLich].end(),
-                        frame.begin());
-    std::copy(punctured.begin(), punctured.end(), it);
+    std::copy(lichSegments[currentLich].begin(),
+              lichSegments[currentLich].end(),
+              frame.begin());
+
+    encoder.reset();
+    encoder.encodePunctured(streamFrame.getData(), sizeof(M17StreamFrame),
+                            frame, DATA_PUNCTURE, 8 * sizeof(lich_t));
 
     // Increment LICH counter after copy
     currentLich = (currentLich + 1) % lichSegments.size();
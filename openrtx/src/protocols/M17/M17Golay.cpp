@@ -44,7 +44,14 @@ static constexpr uint16_t decode_matrix[12] =
 };
 
 
-uint16_t Golay24::calcChecksum(const uint16_t& value)
+/**
+ * Compute the Golay(24,12) checksum of a 12-bit data block by summing the rows
+ * of the encoding matrix.
+ *
+ * @param value: input data.
+ * @return Golay(24,12) checksum.
+ */
+static constexpr uint16_t computeChecksum(const uint16_t value)
 {
     uint16_t checksum = 0;
 
@@ -59,21 +66,15 @@ uint16_t Golay24::calcChecksum(const uint16_t& value)
     return checksum;
 }
 
-
 /**
- * Detect and correct errors in a Golay(24,12) codeword.
+ * Compute the error pattern corresponding to a given syndrome.
  *
- * @param codeword: input codeword.
+ * @param syndrome: syndrome of the received codeword.
  * @return bitmask corresponding to detected bit errors in the codeword, or
  * 0xFFFFFFFF if bit errors are unrecoverable.
  */
-uint32_t Golay24::detectErrors(const uint32_t& codeword)
+static constexpr uint32_t computeErrors(const uint16_t syndrome)
 {
-    uint16_t data   = codeword >> 12;
-    uint16_t parity = codeword & 0xFFF;
-
-    uint16_t syndrome = parity ^ calcChecksum(data);
-
     if(__builtin_popcount(syndrome) <= 3)
     {
         return syndrome;
@@ -117,3 +118,73 @@ uint32_t Golay24::detectErrors(const uint32_t& codeword)
 
     return 0xFFFFFFFF;
 }
+
+
+#ifndef M17_GOLAY_LOW_MEMORY
+
+/*
+ * Lookup tables for encoding and decoding, generated at compile time: the
+ * checksum of each 12-bit data block (8kB) and the error pattern of each
+ * 12-bit syndrome (16kB).
+ */
+template < typename T >
+struct golayTable
+{
+    T data[4096];
+};
+
+static constexpr golayTable< uint16_t > makeChecksumTable()
+{
+    golayTable< uint16_t > table = {};
+
+    for(uint16_t i = 0; i < 4096; i++)
+        table.data[i] = computeChecksum(i);
+
+    return table;
+}
+
+static constexpr golayTable< uint32_t > makeErrorTable()
+{
+    golayTable< uint32_t > table = {};
+
+    for(uint16_t i = 0; i < 4096; i++)
+        table.data[i] = computeErrors(i);
+
+    return table;
+}
+
+static constexpr auto checksum_table = makeChecksumTable();
+static constexpr auto error_table    = makeErrorTable();
+
+uint16_t Golay24::calcChecksum(const uint16_t& value)
+{
+    return checksum_table.data[value & 0x0FFF];
+}
+
+uint32_t Golay24::detectErrors(const uint32_t& codeword)
+{
+    uint16_t data     = (codeword >> 12) & 0x0FFF;
+    uint16_t parity   = codeword & 0x0FFF;
+    uint16_t syndrome = parity ^ checksum_table.data[data];
+
+    return error_table.data[syndrome];
+}
+
+#else
+
+uint16_t Golay24::calcChecksum(const uint16_t& value)
+{
+    return computeChecksum(value);
+}
+
+uint32_t Golay24::detectErrors(const uint32_t& codeword)
+{
+    uint16_t data   = codeword >> 12;
+    uint16_t parity = codeword & 0xFFF;
+
+    uint16_t syndrome = parity ^ calcChecksum(data);
+
+    return computeErrors(syndrome);
+}
+
+#endif
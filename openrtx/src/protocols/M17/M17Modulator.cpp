@@ -20,7 +20,6 @@
 
 #include <new>
 #include <cstddef>
-#include <cstring>
 #include <experimental/array>
 #include <M17/M17Modulator.hpp>
 #include <M17/M17Utils.hpp>
@@ -143,22 +142,27 @@ void M17Modulator::stop()
 
 void M17Modulator::symbolsToBaseband()
 {
-    memset(idleBuffer, 0x00, M17_FRAME_SAMPLES * sizeof(stream_sample_t));
+    /*
+     * Generate the baseband samples of each symbol period directly from the
+     * symbol stream, using the polyphase RRC interpolator.
+     */
+    std::array< float, M17_SAMPLES_PER_SYMBOL > chunk;
 
     for(size_t i = 0; i < symbols.size(); i++)
     {
-        idleBuffer[i * 10] = symbols[i];
-    }
-
-    for(size_t i = 0; i < M17_FRAME_SAMPLES; i++)
-    {
-        float elem    = static_cast< float >(idleBuffer[i]);
-        elem          = M17::rrc_48k(elem * M17_RRC_GAIN) - M17_RRC_OFFSET;
-        #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
-        elem          = pwmComp(elem);
-        elem         *= -1.0f;          // Invert signal phase
-        #endif
-        idleBuffer[i] = static_cast< int16_t >(elem);
+        float sym = static_cast< float >(symbols[i]);
+        M17::rrc_48k(sym * M17_RRC_GAIN, chunk.data());
+
+        stream_sample_t *out = &idleBuffer[i * M17_SAMPLES_PER_SYMBOL];
+        for(size_t j = 0; j < M17_SAMPLES_PER_SYMBOL; j++)
+        {
+            float elem = chunk[j] - M17_RRC_OFFSET;
+            #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
+            elem       = pwmComp(elem);
+            elem      *= -1.0f;          // Invert signal phase
+            #endif
+            out[j]     = static_cast< int16_t >(elem);
+        }
     }
 }
 
@@ -173,8 +177,19 @@ void M17Modulator::sendBaseband()
     idleBuffer = outputStream_getIdleBuffer(outStream);
 }
 #else
+void M17Modulator::setBasebandCallback(std::function< void(const int16_t *, size_t) > callback)
+{
+    basebandCallback = callback;
+}
+
 void M17Modulator::sendBaseband()
 {
+    if(basebandCallback)
+    {
+        basebandCallback(idleBuffer, M17_FRAME_SAMPLES);
+        return;
+    }
+
     FILE *outfile = fopen("/tmp/m17_output.raw", "ab");
 
     for(size_t i = 0; i < M17_FRAME_SAMPLES; i++)
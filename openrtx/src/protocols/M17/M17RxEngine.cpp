@@ -0,0 +1,330 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <M17/M17RxEngine.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace M17;
+
+static constexpr size_t READ_SIZE = 4096;   // Samples per channel read from files
+
+M17FileSource::M17FileSource(const char *path, const uint32_t sampleRate) :
+    decim(sampleRate / 24000), skip(0), buffer(READ_SIZE * (sampleRate / 24000))
+{
+    file = fopen(path, "rb");
+}
+
+M17FileSource::~M17FileSource()
+{
+    if(file != NULL)
+        fclose(file);
+}
+
+bool M17FileSource::isOpen()
+{
+    return (file != NULL) && (decim > 0);
+}
+
+size_t M17FileSource::read(int16_t *buf, const size_t len)
+{
+    if(isOpen() == false)
+        return 0;
+
+    if(decim == 1)
+        return fread(buf, sizeof(int16_t), len, file);
+
+    size_t toRead = std::min(len, READ_SIZE) * decim;
+    size_t nRead  = fread(buffer.data(), sizeof(int16_t), toRead, file);
+
+    /*
+     * Keep the first sample of each decimation step. When a read ends in the
+     * middle of a step, its first sample is taken anyway and the rest of the
+     * step is skipped at the beginning of the next read: no sample is lost,
+     * neither between reads nor at the end of the file.
+     */
+    size_t count = 0;
+    size_t i     = skip;
+    for(; i < nRead; i += decim)
+        buf[count++] = buffer[i];
+
+    skip = i - nRead;
+
+    return count;
+}
+
+
+/**
+ * Source for a single channel of an interleaved stream.
+ */
+class M17InterleavedStream::ChannelSource : public M17RxSource
+{
+public:
+
+    ChannelSource(std::shared_ptr< M17InterleavedStream > stream,
+                  const size_t channel) : stream(stream), channel(channel) { }
+
+    virtual ~ChannelSource() { }
+
+    virtual size_t read(int16_t *buf, const size_t len) override
+    {
+        return stream->read(channel, buf, len);
+    }
+
+private:
+
+    std::shared_ptr< M17InterleavedStream > stream;
+    size_t                                  channel;
+};
+
+std::vector< std::unique_ptr< M17RxSource > >
+M17InterleavedStream::open(const char *path, const size_t channels,
+                           const uint32_t sampleRate)
+{
+    std::vector< std::unique_ptr< M17RxSource > > sources;
+
+    if((channels == 0) || ((sampleRate != 24000) && (sampleRate != 48000)))
+        return sources;
+
+    FILE *file = fopen(path, "rb");
+    if(file == NULL)
+        return sources;
+
+    std::shared_ptr< M17InterleavedStream >
+        stream(new M17InterleavedStream(file, channels, sampleRate));
+
+    for(size_t i = 0; i < channels; i++)
+        sources.emplace_back(new ChannelSource(stream, i));
+
+    return sources;
+}
+
+M17InterleavedStream::M17InterleavedStream(FILE *file, const size_t channels,
+                                           const uint32_t sampleRate) :
+    file(file), decim(sampleRate / 24000), pending(0), queues(channels),
+    buffer(READ_SIZE * channels * (sampleRate / 24000))
+{
+
+}
+
+M17InterleavedStream::~M17InterleavedStream()
+{
+    fclose(file);
+}
+
+size_t M17InterleavedStream::read(const size_t channel, int16_t *buf,
+                                  const size_t len)
+{
+    std::lock_guard< std::mutex > lock(mutex);
+    auto& queue = queues[channel];
+
+    // Demultiplex new data only when this channel has none queued
+    if(queue.empty())
+    {
+        size_t frameSize = queues.size() * decim;
+        size_t nRead     = fread(buffer.data() + pending, sizeof(int16_t),
+                                 buffer.size() - pending, file);
+        size_t total     = pending + nRead;
+        size_t usable    = total - (total % frameSize);
+
+        for(size_t i = 0; i < usable; i += frameSize)
+        {
+            for(size_t ch = 0; ch < queues.size(); ch++)
+                queues[ch].push_back(buffer[i + ch]);
+        }
+
+        // Keep an incomplete frame for the next read, not to misalign the
+        // channels
+        pending = total - usable;
+        std::copy_n(buffer.begin() + usable, pending, buffer.begin());
+    }
+
+    size_t count = std::min(len, queue.size());
+    std::copy_n(queue.begin(), count, buf);
+    queue.erase(queue.begin(), queue.begin() + count);
+
+    return count;
+}
+
+
+M17RxEngine::M17RxEngine(const size_t numThreads) :
+    numThreads(std::max< size_t >(numThreads, 1)), active(0), elapsed(0.0)
+{
+
+}
+
+M17RxEngine::~M17RxEngine()
+{
+    for(auto& ch : channels)
+        ch->demodulator.terminate();
+}
+
+size_t M17RxEngine::addChannel(std::unique_ptr< M17RxSource > source)
+{
+    std::unique_ptr< channel_t > ch(new channel_t);
+    ch->source = std::move(source);
+    ch->locked = false;
+    ch->demodulator.init();
+
+    channels.push_back(std::move(ch));
+
+    return channels.size() - 1;
+}
+
+void M17RxEngine::setFrameCallback(frameCallback_t callback)
+{
+    this->callback = callback;
+}
+
+void M17RxEngine::run()
+{
+    ready.clear();
+    for(size_t i = 0; i < channels.size(); i++)
+        ready.push_back(i);
+
+    active = channels.size();
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector< std::thread > workers;
+    size_t nWorkers = std::min(numThreads, channels.size());
+    for(size_t i = 0; i < nWorkers; i++)
+        workers.emplace_back(&M17RxEngine::worker, this);
+
+    for(auto& w : workers)
+        w.join();
+
+    auto end = std::chrono::steady_clock::now();
+    elapsed  = std::chrono::duration< double >(end - start).count();
+}
+
+size_t M17RxEngine::numChannels()
+{
+    return channels.size();
+}
+
+const M17ChannelStats& M17RxEngine::getStats(const size_t channel)
+{
+    return channels[channel]->stats;
+}
+
+double M17RxEngine::getElapsedTime()
+{
+    return elapsed;
+}
+
+void M17RxEngine::worker()
+{
+    while(true)
+    {
+        size_t index;
+
+        {
+            std::unique_lock< std::mutex > lock(mutex);
+            cond.wait(lock, [&] { return (ready.empty() == false) || (active == 0); });
+
+            if(ready.empty())
+                return;
+
+            index = ready.front();
+            ready.pop_front();
+        }
+
+        bool more = processChannel(index);
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+            if(more)
+                ready.push_back(index);
+            else
+                active--;
+        }
+
+        cond.notify_all();
+    }
+}
+
+bool M17RxEngine::processChannel(const size_t index)
+{
+    channel_t& ch = *channels[index];
+    bool  more    = true;
+    auto  start   = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < BLOCKS_PER_TASK; i++)
+    {
+        // Fill a whole block, sources may return less data than requested
+        size_t len = 0;
+        while(len < BLOCK_SIZE)
+        {
+            size_t n = ch.source->read(ch.block.data() + len, BLOCK_SIZE - len);
+            if(n == 0)
+            {
+                more = false;
+                break;
+            }
+
+            len += n;
+        }
+
+        if(len == 0)
+            break;
+
+        dataBlock_t block = { ch.block.data(), len };
+        bool newFrame     = ch.demodulator.update(block);
+        bool lock         = ch.demodulator.isLocked();
+
+        ch.stats.samples += len;
+
+        // Reset frame decoder when transitioning from unlocked to locked state
+        if((lock == true) && (ch.locked == false))
+        {
+            ch.decoder.reset();
+            ch.stats.locks++;
+        }
+
+        ch.locked = lock;
+        if(lock) ch.stats.lockedBlocks++;
+
+        if(lock && newFrame)
+        {
+            auto& soft  = ch.demodulator.getSoftFrame();
+            auto& frame = ch.demodulator.getFrame();
+            auto  type  = ch.decoder.decodeFrame(frame, soft);
+
+            ch.stats.frames++;
+            if(type == M17FrameType::STREAM)
+                ch.stats.streamFrames++;
+            else if((type == M17FrameType::LINK_SETUP) && ch.decoder.getLsf().valid())
+                ch.stats.lsfFrames++;
+
+            if(callback)
+                callback(index, type, ch.decoder);
+        }
+
+        if(more == false)
+            break;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    ch.stats.busyTime += std::chrono::duration< double >(end - start).count();
+
+    return more;
+}
@@ -81,9 +81,9 @@ void OpMode_FM::disable()
     enterRx   = false;
 }
 
-void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
+void OpMode_FM::update(rtxStatus_t *const status, const uint32_t cfgChanges)
 {
-    (void) newCfg;
+    (void) cfgChanges;
 
     // RX logic
     if(status->opStatus == RX)
@@ -185,9 +185,19 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
             platform_ledOff(RED);
             break;
     }
+}
+
+uint32_t OpMode_FM::waitEvents(const rtxStatus_t *const status)
+{
+    // Pending transition to RX
+    if(enterRx)
+        return RTX_EVT_NONE;
+
+    // Squelch is updated at the RTX timer rate, when receiving
+    if(status->opStatus == TX)
+        return RTX_EVT_PTT;
 
-    // Sleep thread for 30ms for 33Hz update rate
-    sleepFor(0u, 30u);
+    return RTX_EVT_PTT | RTX_EVT_TICK;
 }
 
 bool OpMode_FM::rxSquelchOpen()
@@ -29,7 +29,8 @@
 using namespace std;
 using namespace M17;
 
-OpMode_M17::OpMode_M17() : startRx(false), startTx(false), locked(false)
+OpMode_M17::OpMode_M17() : startRx(false), startTx(false), locked(false),
+                           txHalfFrame(false), rxBlock(false)
 {
 
 }
@@ -42,11 +43,14 @@ OpMode_M17::~OpMode_M17()
 void OpMode_M17::enable()
 {
     codec_init();
+    codec_setFrameCallback(codecFrameReady, nullptr);
     modulator.init();
     demodulator.init();
-    locked  = false;
-    startRx = true;
-    startTx = false;
+    locked      = false;
+    startRx     = true;
+    startTx     = false;
+    txHalfFrame = false;
+    rxBlock     = false;
 }
 
 void OpMode_M17::disable()
@@ -63,18 +67,12 @@ void OpMode_M17::disable()
     demodulator.terminate();
 }
 
-void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
+void OpMode_M17::update(rtxStatus_t *const status, const uint32_t cfgChanges)
 {
-    (void) newCfg;
-
-    // Force inversion of RX phase for MD-3x0 VHF and MD-UV3x0 radios
-    #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
-    const hwInfo_t* hwinfo = platform_getHwInfo();
-    if(hwinfo->vhf_band == 1)
-        status->invertRxPhase = true;
-    else
-        status->invertRxPhase = false;
-    #endif
+    // Apply a change of the RX phase also while receiving, otherwise it is
+    // set when reception starts
+    if((cfgChanges & RTX_CFG_RX_PHASE) && (status->opStatus == RX))
+        demodulator.invertPhase(status->invertRxPhase);
 
     // Main FSM logic
     switch(status->opStatus)
@@ -119,6 +117,47 @@ void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
     }
 }
 
+uint32_t OpMode_M17::waitEvents(const rtxStatus_t *const status)
+{
+    switch(status->opStatus)
+    {
+        case OFF:
+            // Pending transition to RX or TX, the PTT may have been pressed
+            // while receiving
+            if(startRx || (platform_getPttStatus() && (status->txDisable == 0)))
+                return RTX_EVT_NONE;
+
+            return RTX_EVT_PTT;
+
+        case RX:
+            // Paced by the baseband input stream, once sampling has started
+            if(startRx)
+                return RTX_EVT_NONE;
+
+            return RTX_EVT_BASEBAND | RTX_EVT_PTT;
+
+        case TX:
+            return RTX_EVT_CODEC | RTX_EVT_PTT;
+
+        default:
+            break;
+    }
+
+    return RTX_EVT_CONFIG;
+}
+
+void OpMode_M17::basebandReady(void *arg)
+{
+    static_cast< OpMode_M17 * >(arg)->rxBlock = true;
+    rtx_notifyFromIrq(RTX_EVT_BASEBAND);
+}
+
+void OpMode_M17::codecFrameReady(void *arg)
+{
+    (void) arg;
+    rtx_notify(RTX_EVT_CODEC);
+}
+
 void OpMode_M17::offState(rtxStatus_t *const status)
 {
     radio_disableRtx();
@@ -143,7 +182,8 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
 {
     if(startRx)
     {
-        demodulator.startBasebandSampling();
+        rxBlock = false;
+        demodulator.startBasebandSampling(basebandReady, this);
         demodulator.invertPhase(status->invertRxPhase);
 
         rxAudioPath = audioPath_request(SOURCE_MCU, SINK_SPK, PRIO_RX);
@@ -154,7 +194,12 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         startRx = false;
     }
 
-    bool newData = demodulator.update();
+    // Demodulate only when a new block of baseband samples is ready, the
+    // task may have been woken up by the PTT
+    bool newData = false;
+    if(rxBlock.exchange(false))
+        newData = demodulator.update();
+
     bool lock    = demodulator.isLocked();
 
     // Reset frame decoder when transitioning from unlocked to locked state
@@ -168,7 +213,8 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
     if(locked && newData)
     {
         auto&   frame  = demodulator.getFrame();
-        auto    type   = decoder.decodeFrame(frame);
+        auto&   soft   = demodulator.getSoftFrame();
+        auto    type   = decoder.decodeFrame(frame, soft);
         bool    lsfOk  = decoder.getLsf().valid();
         uint8_t pthSts = audioPath_getStatus(rxAudioPath);
 
@@ -195,7 +241,8 @@ void OpMode_M17::txState(rtxStatus_t *const status)
 
     if(startTx)
     {
-        startTx = false;
+        startTx     = false;
+        txHalfFrame = false;
 
         std::string src(status->source_address);
         std::string dst(status->destination_address);
@@ -224,12 +271,22 @@ void OpMode_M17::txState(rtxStatus_t *const status)
         modulator.send(m17Frame);
     }
 
-    payload_t dataFrame;
-    bool      lastFrame = false;
+    bool lastFrame = false;
+
+    // Send a new frame once there are 16 bytes of compressed speech. The RTX
+    // task is woken up by the codec each time a new half of them is ready.
+    if(txHalfFrame == false)
+    {
+        if(codec_popFrame(txPayload.data(), false) == false)
+            return;
+
+        txHalfFrame = true;
+    }
+
+    if(codec_popFrame(txPayload.data() + 8, false) == false)
+        return;
 
-    // Wait until there are 16 bytes of compressed speech, then send them
-    codec_popFrame(dataFrame.data(),     true);
-    codec_popFrame(dataFrame.data() + 8, true);
+    txHalfFrame = false;
 
     if(platform_getPttStatus() == false)
     {
@@ -238,7 +295,7 @@ void OpMode_M17::txState(rtxStatus_t *const status)
         status->opStatus = OFF;
     }
 
-    encoder.encodeStreamFrame(dataFrame, m17Frame, lastFrame);
+    encoder.encodeStreamFrame(txPayload, m17Frame, lastFrame);
     modulator.send(m17Frame);
 
     if(lastFrame)
@@ -18,15 +18,22 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
+#include <interfaces/platform.h>
+#include <interfaces/delays.h>
 #include <interfaces/radio.h>
 #include <string.h>
 #include <rtx.h>
 #include <OpMode_FM.hpp>
 #include <OpMode_M17.hpp>
+#include <profiling.h>
+#include <atomic>
+#ifdef PLATFORM_LINUX
+#include <virtual_clock.h>
+#else
+#include <kernel/scheduler/scheduler.h>
+#include <miosix.h>
+#endif
 
-pthread_mutex_t *cfgMutex;      // Mutex for incoming config messages
-
-const rtxStatus_t *newCnf;      // Pointer for incoming config messages
 rtxStatus_t rtxStatus;          // RTX driver status
 
 float rssi;                     // Current RSSI in dBm
@@ -37,11 +44,215 @@ OpMode     noMode;              // Empty opMode handler for opmode::NONE
 OpMode_FM  fmMode;              // FM mode handler
 OpMode_M17 m17Mode;             // M17 mode handler
 
-void rtx_init(pthread_mutex_t *m)
+/*
+ * Events notified to the RTX task and not yet handled. On the MCU targets the
+ * events can be notified also from interrupt handlers, thus they are guarded
+ * by disabling the interrupts and the RTX thread waits on them directly.
+ */
+static uint32_t        evPending = 0;
+static uint32_t        evWaiting = 0;   // Events the RTX task is sleeping on
+#ifdef PLATFORM_LINUX
+static pthread_mutex_t evMutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  evCond    = PTHREAD_COND_INITIALIZER;
+static vclockBlock_t   evBlock   = {false};
+#else
+static miosix::Thread *evThread  = nullptr;
+#endif
+#ifdef ENABLE_PROFILING
+static uint32_t        evTime    = 0;   // Time of the wakeup notification
+#endif
+
+// State of the PTT and timer event generation
+static bool      lastPtt  = false;
+static long long nextTick = 0;
+
+/*
+ * Configuration mailbox, double buffered and protected by a sequence number.
+ * The sequence number is odd while a configuration is being written and is
+ * increased by two for each configuration published: the n-th configuration
+ * is stored in the buffer n & 1, while the next one is written in the other
+ * buffer. The RTX task copies the latest configuration without locking and
+ * retries only if, meanwhile, the writer began to overwrite the same buffer.
+ * The buffers are accessed by words, to have well defined concurrent accesses.
+ */
+static constexpr size_t CFG_WORDS = (sizeof(rtxStatus_t) + 3) / 4;
+
+static std::atomic< uint32_t > cfgBuf[2][CFG_WORDS];
+static std::atomic< uint32_t > cfgSeq(0);
+static uint32_t                cfgLast = 0;    // Sequence number last applied
+static pthread_mutex_t         cfgWrMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/**
+ * \internal Get the pending events, clearing them.
+ *
+ * @param mask: events to wait for, if none of them is pending.
+ * @param block: if false, return immediately.
+ * @return the pending events.
+ */
+static uint32_t waitEvents(const uint32_t mask, const bool block)
+{
+    bool     waited = false;
+    uint32_t events;
+
+    #ifdef PLATFORM_LINUX
+    pthread_mutex_lock(&evMutex);
+
+    if(block && ((evPending & mask) == 0))
+    {
+        evWaiting = mask;
+        waited    = true;
+
+        while(evWaiting != 0)
+        {
+            vclock_blockBegin(&evBlock);
+            pthread_cond_wait(&evCond, &evMutex);
+            vclock_blockEnd(&evBlock);
+        }
+    }
+
+    events    = evPending;
+    evPending = 0;
+
+    pthread_mutex_unlock(&evMutex);
+    #else
+    {
+        miosix::FastInterruptDisableLock dLock;
+
+        if(block && ((evPending & mask) == 0))
+        {
+            evWaiting = mask;
+            evThread  = miosix::Thread::IRQgetCurrentThread();
+            waited    = true;
+
+            while(evWaiting != 0)
+            {
+                miosix::Thread::IRQwait();
+                {
+                    miosix::FastInterruptEnableLock eLock(dLock);
+                    miosix::Thread::yield();
+                }
+            }
+        }
+
+        events    = evPending;
+        evPending = 0;
+    }
+    #endif
+
+    // Time elapsed from the notification to the wakeup
+    #ifdef ENABLE_PROFILING
+    if(waited)
+        profiling_record(PROF_RTX_LATENCY, cycleCounter_get() - evTime);
+    #else
+    (void) waited;
+    #endif
+
+    return events;
+}
+
+/**
+ * \internal Add events to the pending ones, to be called with the events
+ * locked.
+ *
+ * @return true if the RTX task has been woken up.
+ */
+static bool postEvents(const uint32_t events)
+{
+    evPending |= events;
+
+    // Wake up the RTX task only if it is waiting for one of these events
+    if((evWaiting & events) == 0)
+        return false;
+
+    #ifdef ENABLE_PROFILING
+    evTime = cycleCounter_get();
+    #endif
+
+    evWaiting = 0;
+    #ifdef PLATFORM_LINUX
+    vclock_blockEnd(&evBlock);
+    pthread_cond_signal(&evCond);
+    #else
+    evThread->IRQwakeup();
+    #endif
+
+    return true;
+}
+
+/**
+ * \internal Copy the latest configuration published in the mailbox, if not
+ * yet read.
+ *
+ * @param cfg: destination of the configuration.
+ * @return true if a new configuration has been copied.
+ */
+static bool readConfig(rtxStatus_t& cfg)
+{
+    uint32_t words[CFG_WORDS];
+    uint32_t seq;
+
+    do
+    {
+        seq = cfgSeq.load(std::memory_order_acquire);
+        if((seq >> 1) == cfgLast)
+            return false;
+
+        const auto& buf = cfgBuf[(seq >> 1) & 1];
+        for(size_t i = 0; i < CFG_WORDS; i++)
+            words[i] = buf[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    while((cfgSeq.load(std::memory_order_relaxed) - (seq & ~1u)) > 2);
+
+    cfgLast = seq >> 1;
+    memcpy(&cfg, words, sizeof(rtxStatus_t));
+
+    return true;
+}
+
+/**
+ * \internal Compare two configurations.
+ *
+ * @return bit mask of the rtxConfigField values which differ.
+ */
+static uint32_t diffConfig(const rtxStatus_t& a, const rtxStatus_t& b)
+{
+    uint32_t changes = 0;
+
+    if(a.opMode != b.opMode)               changes |= RTX_CFG_OPMODE;
+    if(a.bandwidth != b.bandwidth)         changes |= RTX_CFG_BANDWIDTH;
+    if(a.txDisable != b.txDisable)         changes |= RTX_CFG_TX_DISABLE;
+    if(a.scan != b.scan)                   changes |= RTX_CFG_SCAN;
+    if(a.rxFrequency != b.rxFrequency)     changes |= RTX_CFG_RX_FREQ;
+    if(a.txFrequency != b.txFrequency)     changes |= RTX_CFG_TX_FREQ;
+    if(a.txPower != b.txPower)             changes |= RTX_CFG_TX_POWER;
+    if(a.sqlLevel != b.sqlLevel)           changes |= RTX_CFG_SQL_LEVEL;
+    if(a.invertRxPhase != b.invertRxPhase) changes |= RTX_CFG_RX_PHASE;
+
+    if((a.rxToneEn != b.rxToneEn) || (a.rxTone != b.rxTone))
+        changes |= RTX_CFG_RX_TONE;
+
+    if((a.txToneEn != b.txToneEn) || (a.txTone != b.txTone))
+        changes |= RTX_CFG_TX_TONE;
+
+    if((a.rxCan != b.rxCan) || (a.txCan != b.txCan))
+        changes |= RTX_CFG_M17_CAN;
+
+    if((memcmp(a.source_address, b.source_address,
+               sizeof(a.source_address)) != 0) ||
+       (memcmp(a.destination_address, b.destination_address,
+               sizeof(a.destination_address)) != 0))
+        changes |= RTX_CFG_M17_ADDR;
+
+    return changes;
+}
+
+void rtx_init()
 {
-    // Initialise mutex for configuration access
-    cfgMutex = m;
-    newCnf   = NULL;
+    // Apply the latest configuration published, if any, at the first update
+    cfgLast = 0;
 
     /*
      * Default initialisation for rtx status
@@ -65,7 +276,7 @@ void rtx_init(pthread_mutex_t *m)
      * Initialise low-level platform-specific driver
      */
     radio_init(&rtxStatus);
-    radio_updateConfiguration();
+    radio_updateConfiguration(RTX_CFG_ALL);
 
     /*
      * Initial value for RSSI filter
@@ -74,6 +285,63 @@ void rtx_init(pthread_mutex_t *m)
     reinitFilter = false;
 }
 
+void rtx_notify(const uint32_t events)
+{
+    #ifdef PLATFORM_LINUX
+    pthread_mutex_lock(&evMutex);
+    postEvents(events);
+    pthread_mutex_unlock(&evMutex);
+    #else
+    bool yield = false;
+    {
+        miosix::FastInterruptDisableLock dLock;
+        if(postEvents(events))
+        {
+            auto *self = miosix::Thread::IRQgetCurrentThread();
+            yield = evThread->IRQgetPriority() > self->IRQgetPriority();
+        }
+    }
+
+    if(yield) miosix::Thread::yield();
+    #endif
+}
+
+void rtx_notifyFromIrq(const uint32_t events)
+{
+    #ifdef PLATFORM_LINUX
+    rtx_notify(events);
+    #else
+    if(postEvents(events))
+    {
+        auto *self = miosix::Thread::IRQgetCurrentThread();
+        if(evThread->IRQgetPriority() > self->IRQgetPriority())
+            miosix::Scheduler::IRQfindNextThread();
+    }
+    #endif
+}
+
+void rtx_eventTask()
+{
+    uint32_t  events = RTX_EVT_NONE;
+    long long now    = getTick();
+    bool      ptt    = platform_getPttStatus();
+
+    if(ptt != lastPtt)
+    {
+        events |= RTX_EVT_PTT;
+        lastPtt = ptt;
+    }
+
+    if(now >= nextTick)
+    {
+        events  |= RTX_EVT_TICK;
+        nextTick = now + RTX_TICK_PERIOD;
+    }
+
+    if(events != RTX_EVT_NONE)
+        rtx_notify(events);
+}
+
 void rtx_terminate()
 {
     rtxStatus.opStatus = OFF;
@@ -88,11 +356,27 @@ void rtx_configure(const rtxStatus_t *cfg)
      * NOTE: an incoming configuration may overwrite a preceding one not yet
      * read by the radio task. This mechanism ensures that the radio driver
      * always gets the most recent configuration.
+     * The mutex only serializes the writers, the RTX task never takes it.
      */
+    uint32_t words[CFG_WORDS] = {0};
+    memcpy(words, cfg, sizeof(rtxStatus_t));
+
+    pthread_mutex_lock(&cfgWrMutex);
+
+    uint32_t seq = cfgSeq.load(std::memory_order_relaxed);
+    auto&    buf = cfgBuf[((seq >> 1) + 1) & 1];
+
+    cfgSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for(size_t i = 0; i < CFG_WORDS; i++)
+        buf[i].store(words[i], std::memory_order_relaxed);
+
+    cfgSeq.store(seq + 2, std::memory_order_release);
+
+    pthread_mutex_unlock(&cfgWrMutex);
 
-    pthread_mutex_lock(cfgMutex);
-    newCnf = cfg;
-    pthread_mutex_unlock(cfgMutex);
+    rtx_notify(RTX_EVT_CONFIG);
 }
 
 rtxStatus_t rtx_getCurrentStatus()
@@ -102,33 +386,48 @@ rtxStatus_t rtx_getCurrentStatus()
 
 void rtx_task()
 {
-    // Check if there is a pending new configuration and, in case, read it.
-    bool reconfigure = false;
-    if(pthread_mutex_trylock(cfgMutex) == 0)
+    /*
+     * Wait for the events the current opMode handler needs, or for a new
+     * configuration. An empty mask means the handler has work to do right
+     * away, in this case the pending events are only collected.
+     */
+    uint32_t mask   = currMode->waitEvents(&rtxStatus);
+    uint32_t events = waitEvents(mask | RTX_EVT_CONFIG, mask != RTX_EVT_NONE);
+
+    PROFILE_BEGIN(PROF_RTX_TASK);
+
+    // Check if there is a new configuration and, in case, apply the fields
+    // which changed.
+    uint32_t    changes = 0;
+    rtxStatus_t newCfg;
+    if(readConfig(newCfg))
     {
-        if(newCnf != NULL)
+        // Force TX and RX tone squelch to off for OpModes different from FM.
+        if(newCfg.opMode != OPMODE_FM)
         {
-            // Copy new configuration and override opStatus flags
-            uint8_t tmp = rtxStatus.opStatus;
-            memcpy(&rtxStatus, newCnf, sizeof(rtxStatus_t));
-            rtxStatus.opStatus = tmp;
-
-            reconfigure = true;
-            newCnf = NULL;
+            newCfg.txToneEn = 0;
+            newCfg.rxToneEn = 0;
         }
 
-        pthread_mutex_unlock(cfgMutex);
+        // Force inversion of RX phase for MD-3x0 VHF and MD-UV3x0 radios,
+        // before the comparison: the override is not a configuration change.
+        #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
+        const hwInfo_t* hwinfo = platform_getHwInfo();
+        if(hwinfo->vhf_band == 1)
+            newCfg.invertRxPhase = true;
+        else
+            newCfg.invertRxPhase = false;
+        #endif
+
+        // Keep the current opStatus
+        newCfg.opStatus = rtxStatus.opStatus;
+        changes   = diffConfig(rtxStatus, newCfg);
+        rtxStatus = newCfg;
     }
 
+    bool reconfigure = (changes != 0);
     if(reconfigure)
     {
-        // Force TX and RX tone squelch to off for OpModes different from FM.
-        if(rtxStatus.opMode != OPMODE_FM)
-        {
-            rtxStatus.txToneEn = 0;
-            rtxStatus.rxToneEn = 0;
-        }
-
         /*
          * Handle change of opMode:
          * - deactivate current opMode and switch operating status to "OFF";
@@ -156,14 +455,16 @@ void rtx_task()
         }
 
         // Tell radio driver that there was a change in its configuration.
-        radio_updateConfiguration();
+        if((changes & RADIO_CFG_FIELDS) != 0)
+            radio_updateConfiguration(changes);
     }
 
     /*
      * RSSI update block, run only when radio is in RX mode.
      *
      * RSSI value is passed through a filter with a time constant of 60ms
-     * (cut-off frequency of 15Hz) at an update rate of 33.3Hz.
+     * (cut-off frequency of 15Hz) at an update rate of 33.3Hz, given by the
+     * RTX timer events.
      *
      * The low pass filter skips an update step if a new configuration has
      * just been applied. This is a workaround for the AT1846S returning a
@@ -177,7 +478,7 @@ void rtx_task()
     if(rtxStatus.opStatus == RX)
     {
 
-        if(!reconfigure)
+        if((!reconfigure) && ((events & RTX_EVT_TICK) != 0))
         {
             if(!reinitFilter)
             {
@@ -196,12 +497,16 @@ void rtx_task()
         reinitFilter = true;
     }
 
+    // The opMode handlers wait for new data or sleep inside their update
+    // function, their processing time is covered by dedicated probes.
+    PROFILE_END(PROF_RTX_TASK);
+
     /*
      * Forward the periodic update step to the currently active opMode handler.
      * Call is placed after RSSI update to allow handler's code have a fresh
      * version of the RSSI level.
      */
-    currMode->update(&rtxStatus, reconfigure);
+    currMode->update(&rtxStatus, changes);
 }
 
 float rtx_getRssi()
@@ -81,6 +81,7 @@
 #include <hwconfig.h>
 #include <voicePromptUtils.h>
 #include <beeps.h>
+#include <profiling.h>
 
 #define FUNCTION_LATCH_TIMEOUT 3000
 
@@ -240,7 +241,12 @@ const uint8_t settings_gps_num = sizeof(settings_gps_items)/sizeof(settings_gps_
 #endif
 const uint8_t settings_voice_num = sizeof(settings_voice_items)/sizeof(settings_voice_items[0]);
 const uint8_t backup_restore_num = sizeof(backup_restore_items)/sizeof(backup_restore_items[0]);
+#ifdef ENABLE_PROFILING
+// Execution time probes are listed at the end of the info menu
+const uint8_t info_num = sizeof(info_items)/sizeof(info_items[0]) + PROF_NUM_PROBES;
+#else
 const uint8_t info_num = sizeof(info_items)/sizeof(info_items[0]);
+#endif
 const uint8_t author_num = sizeof(authors)/sizeof(authors[0]);
 
 const color_t color_black = {0, 0, 0, 255};
@@ -1754,6 +1760,8 @@ void ui_updateFSM(bool *sync_rtx)
                     _ui_menuUp(info_num);
                 else if(msg.keys & KEY_DOWN || msg.keys & KNOB_RIGHT)
                     _ui_menuDown(info_num);
+                else if(msg.keys & KEY_ENTER)
+                    profiling_reset();  // Clear execution time statistics
                 else if(msg.keys & KEY_ESC)
                     _ui_menuBack(MENU_TOP);
                 break;
@@ -28,6 +28,7 @@
 #include <interfaces/platform.h>
 #include <interfaces/delays.h>
 #include <memory_profiling.h>
+#include <profiling.h>
 #include <ui/ui_strings.h>
 #include <core/voicePromptUtils.h>
 
@@ -377,6 +378,16 @@ int _ui_getBackupRestoreEntryName(char *buf, uint8_t max_len, uint8_t index)
 int _ui_getInfoEntryName(char *buf, uint8_t max_len, uint8_t index)
 {
     if(index >= info_num) return -1;
+
+    #ifdef ENABLE_PROFILING
+    const uint8_t probeBase = info_num - PROF_NUM_PROBES;
+    if(index >= probeBase)
+    {
+        snprintf(buf, max_len, "%s", profiling_probeName(index - probeBase));
+        return 0;
+    }
+    #endif
+
     snprintf(buf, max_len, "%s", info_items[index]);
     return 0;
 }
@@ -420,6 +431,22 @@ int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
         case 8: // LCD Type
             snprintf(buf, max_len, "%d", hwinfo->lcd_type);
             break;
+        #ifdef ENABLE_PROFILING
+        default: // Execution time probes, average and maximum
+        {
+            profStats_t stats;
+            uint32_t    tpu = profiling_ticksPerUs();
+            profiling_getStats(index - (info_num - PROF_NUM_PROBES), &stats);
+
+            uint32_t avg = 0;
+            if(stats.time.count > 0)
+                avg = (uint32_t) (stats.time.total / stats.time.count);
+
+            snprintf(buf, max_len, "%lu/%luus", (unsigned long) (avg / tpu),
+                     (unsigned long) (stats.time.max / tpu));
+        }
+            break;
+        #endif
     }
     return 0;
 }
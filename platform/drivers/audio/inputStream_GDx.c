@@ -49,6 +49,13 @@ dataBlock_t inputStream_getData(streamId id)
     return block;
 }
 
+void inputStream_setCallback(streamId id, streamCallback_t callback, void *arg)
+{
+    (void) id;
+    (void) callback;
+    (void) arg;
+}
+
 void inputStream_stop(streamId id)
 {
     (void) id;
@@ -36,6 +36,9 @@ static stream_sample_t *bufAddr  = 0;           // Start address of data buffer,
 static stream_sample_t *bufCurr  = 0;           // Buffer address to be returned to application.
 static size_t          bufLen    = 0;           // Buffer length.
 static uint8_t         bufMode   = BUF_LINEAR;  // Buffer management mode.
+static bool            bufReady  = false;       // A half buffer is ready and not yet returned.
+static streamCallback_t blockCb  = 0;           // Block completion callback.
+static void            *blockArg = 0;           // Argument of the block completion callback.
 
 void __attribute__((used)) DmaHandlerImpl()
 {
@@ -55,6 +58,7 @@ void __attribute__((used)) DmaHandlerImpl()
                     bufCurr = bufAddr;                   // Return first half
                 else
                     bufCurr = bufAddr + (bufLen / 2);    // Return second half
+                bufReady = true;
                 break;
 
             default:
@@ -70,6 +74,9 @@ void __attribute__((used)) DmaHandlerImpl()
                 Scheduler::IRQfindNextThread();
             sWaiting = 0;
         }
+
+        // Notify the block completion, called with interrupts disabled
+        if(blockCb != 0) blockCb(blockArg);
     }
 
     DMA2->LIFCR |= DMA_LIFCR_CTEIF2    // Clear transfer error flag (not handled)
@@ -107,9 +114,10 @@ streamId inputStream_start(const enum AudioSource source,
         inUse = true;
     }
 
-    bufMode = mode;
-    bufAddr = buf;
-    bufLen  = bufLength;
+    bufMode  = mode;
+    bufAddr  = buf;
+    bufLen   = bufLength;
+    bufReady = false;
 
     RCC->APB2ENR |= RCC_APB2ENR_ADC2EN;    // Enable ADC
     RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;    // Enable conv. timebase timer
@@ -245,20 +253,27 @@ dataBlock_t inputStream_getData(streamId id)
     }
 
     /*
-     * Put the calling thread in waiting status until data is ready.
+     * Put the calling thread in waiting status until data is ready. In double
+     * buffered mode, an half buffer completed since the last call is returned
+     * without waiting.
      */
     {
         FastInterruptDisableLock dLock;
-        sWaiting = Thread::IRQgetCurrentThread();
-        do
+        if(bufReady == false)
         {
-            Thread::IRQwait();
+            sWaiting = Thread::IRQgetCurrentThread();
+            do
             {
-                FastInterruptEnableLock eLock(dLock);
-                Thread::yield();
-            }
+                Thread::IRQwait();
+                {
+                    FastInterruptEnableLock eLock(dLock);
+                    Thread::yield();
+                }
+
+            }while(sWaiting);
+        }
 
-        }while(sWaiting);
+        bufReady = false;
     }
 
     block.data = bufCurr;
@@ -268,6 +283,15 @@ dataBlock_t inputStream_getData(streamId id)
     return block;
 }
 
+void inputStream_setCallback(streamId id, streamCallback_t callback, void *arg)
+{
+    if(id < 0) return;
+
+    FastInterruptDisableLock dLock;
+    blockCb  = callback;
+    blockArg = arg;
+}
+
 void inputStream_stop(streamId id)
 {
     if(id < 0) return;
@@ -287,6 +311,7 @@ void inputStream_stop(streamId id)
         inUse   = false;
         bufCurr = 0;
         bufLen  = 0;
+        blockCb = 0;
         if(sWaiting != 0) sWaiting->IRQwakeup();
     }
 }
@@ -17,20 +17,33 @@
 
 #include <hwconfig.h>
 #include <interfaces/audio_stream.h>
+#include <inputStream_linux.h>
+#include <virtual_clock.h>
+#include <fcntl.h>
 #include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
-#include <cassert>
-#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 
 streamId gNextAvailableStreamId = 0;
 
+// Replay as fast as the consumer reads the data, instead of following the
+// virtual time
+static std::atomic<bool> gConsumerPaced(false);
+
 class InputStream
 {
    public:
@@ -49,8 +62,6 @@ class InputStream
             return;
         }
 
-        m_db_ready[0] = m_db_ready[1] = false;
-
         std::string sourceString;
         switch (source)
         {
@@ -67,25 +78,35 @@ class InputStream
                 break;
         }
 
-        m_fp = fopen((sourceString + ".raw").c_str(), "rb");
-        if (!m_fp)
+        m_fd = open((sourceString + ".raw").c_str(), O_RDONLY);
+        if (m_fd < 0)
         {
             fprintf(stderr, "InputStream error: cannot open: %s.raw\n",
                     sourceString.c_str());
             return;
         }
 
-        fseek(m_fp, 0, SEEK_END);
-        m_size = ftell(m_fp);
-        fseek(m_fp, 0, SEEK_SET);
-        if (m_size % 2 || m_size == 0)
+        struct stat st;
+        if (fstat(m_fd, &st) < 0 || st.st_size % 2 || st.st_size == 0)
         {
             fprintf(stderr, "InputStream error: invalid file: %s.raw\n",
                     sourceString.c_str());
             return;
         }
 
-        m_valid = true;
+        // Map the whole file, the emulated ADC copies the samples from here
+        void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (data == MAP_FAILED)
+        {
+            fprintf(stderr, "InputStream error: cannot map: %s.raw\n",
+                    sourceString.c_str());
+            return;
+        }
+
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        m_data    = static_cast<const stream_sample_t*>(data);
+        m_samples = st.st_size / sizeof(stream_sample_t);
+        m_valid   = true;
 
         changeId();
         setStreamData(priority, buf, bufLength, mode, sampleRate);
@@ -100,7 +121,9 @@ class InputStream
     {
         stopThread();
 
-        if (m_fp) fclose(m_fp);
+        if (m_data) munmap(const_cast<stream_sample_t*>(m_data),
+                           m_samples * sizeof(stream_sample_t));
+        if (m_fd >= 0) close(m_fd);
     }
 
     dataBlock_t getDataBlock()
@@ -121,19 +144,29 @@ class InputStream
             {
                 // If this mode is selected, wait for the readiness of the
                 // current slice and return it
+                std::unique_lock<std::mutex> lock(m_mutex);
 
-                int id = m_db_curread;
+                // Calling again this function releases the slice returned
+                // by the previous call
+                m_db_inuse = -1;
+                vclock_blockEnd(&m_producerBlock);
+                m_cond.notify_all();
 
-                // Wait for `m_buf` to be ready
-                while (!m_db_ready[id] && m_run_thread)
+                int id     = m_db_curread;
+                auto ready = [&] { return m_db_ready[id] || !m_run_thread; };
+                if (!ready())
                 {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    vclock_blockBegin(&m_consumerBlock);
+                    m_cond.wait(lock, ready);
+                    vclock_blockEnd(&m_consumerBlock);
                 }
+
                 if (!m_run_thread) return {NULL, 0};
 
                 // Return the buffer contents
                 auto* pos      = m_buf + id * (m_bufLength / 2);
-                m_db_ready[id] = 0;
+                m_db_ready[id] = false;
+                m_db_inuse     = id;
 
                 // Update the read buffer
                 m_db_curread = (id + 1) % 2;
@@ -160,6 +193,13 @@ class InputStream
         gNextAvailableStreamId += 1;
     }
 
+    void setCallback(streamCallback_t callback, void* arg)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_callback = callback;
+        m_cbArg    = arg;
+    }
+
     void setStreamData(AudioPriority priority,
                        stream_sample_t* buf,
                        size_t bufLength,
@@ -169,9 +209,16 @@ class InputStream
         if (!m_valid) return;
 
         stopThread();
-        m_run_thread = true;  // set it as runnable again
 
-        // HERE stop thread
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_run_thread  = true;  // set it as runnable again
+            m_db_ready[0] = m_db_ready[1] = false;
+            m_db_inuse    = -1;
+            m_db_curread  = 0;
+            m_callback    = nullptr;
+        }
+
         m_prio       = priority;
         m_buf        = buf;
         m_bufLength  = bufLength;
@@ -181,20 +228,23 @@ class InputStream
         switch (m_mode)
         {
             case BufMode::BUF_LINEAR:
-                // TODO: stop a running thread
                 break;
             case BufMode::BUF_CIRC_DOUBLE:
                 m_thread =
                     std::thread(std::bind(&InputStream::threadFunc, this));
-                // TODO: start thread
                 break;
         }
     }
 
    private:
-    bool m_valid    = false;
-    FILE* m_fp      = nullptr;
-    uint64_t m_size = 0;
+    // Maximum sleep of the emulated ADC before checking for a stop request
+    static constexpr int64_t STOP_CHECK_NS = 10000000;
+
+    bool m_valid                  = false;
+    int m_fd                      = -1;
+    const stream_sample_t* m_data = nullptr;
+    size_t m_samples              = 0;
+    size_t m_pos                  = 0;
 
     streamId m_id;
     AudioPriority m_prio;
@@ -204,98 +254,153 @@ class InputStream
     stream_sample_t* m_buf = nullptr;
     size_t m_bufLength     = 0;
 
-    size_t m_db_curwrite = 0;
-    size_t m_db_curread  = 0;
-    std::atomic<bool> m_db_ready[2];
-    std::atomic<bool> m_run_thread;
-    std::atomic<bool> m_func_running;
+    // All the fields below are protected by m_mutex, waiting threads are
+    // woken up through m_cond
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_db_curread = 0;
+    int m_db_inuse      = -1;
+    bool m_db_ready[2]  = {false, false};
+    bool m_run_thread;
+    bool m_func_running;
+    int64_t m_deadline = 0;
+    streamCallback_t m_callback = nullptr;
+    void* m_cbArg               = nullptr;
+    vclockBlock_t m_consumerBlock = {false};
+    vclockBlock_t m_producerBlock = {false};
     std::thread m_thread;
 
     // Emulate an ADC that reads to the circular buffer
     void threadFunc()
     {
-        m_db_ready[0] = m_db_ready[1] = false;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const size_t half = m_bufLength / 2;
+        int id            = 0;
+
+        m_deadline = vclock_now();
         while (m_run_thread)
         {
-            m_db_ready[0] = false;
-            m_db_curwrite = 0;
-            fillBuffer(m_buf, m_bufLength / 2);
-            m_db_ready[0] = true;
-            if (!m_run_thread) break;
-
-            m_db_curwrite = 1;
-            m_db_ready[1] = false;
-            fillBuffer(m_buf + m_bufLength / 2, m_bufLength / 2);
-            m_db_ready[1] = true;
+            // When running as fast as the consumer, do not overwrite the
+            // slice until it has been read and released
+            auto released = [&]
+            {
+                return (!m_run_thread) || (!gConsumerPaced) ||
+                       ((!m_db_ready[id]) && (m_db_inuse != id));
+            };
+
+            if (!released())
+            {
+                vclock_blockBegin(&m_producerBlock);
+                m_cond.wait(lock, released);
+                vclock_blockEnd(&m_producerBlock);
+            }
+
+            if (!waitSampling(lock, half)) break;
+
+            m_db_ready[id] = false;
+            readSamples(m_buf + id * half, half);
+            m_db_ready[id] = true;
+            vclock_blockEnd(&m_consumerBlock);
+            m_cond.notify_all();
+
+            // Notify the block completion, outside of the critical section
+            streamCallback_t callback = m_callback;
+            void* arg                 = m_cbArg;
+            if (callback != nullptr)
+            {
+                lock.unlock();
+                callback(arg);
+                lock.lock();
+            }
+
+            id = (id + 1) % 2;
         }
     }
 
     // This is a blocking function that emulates an ADC writing to the
-    // specified memory region. It takes the same time that an ADC would take
-    // to sample the same quantity of data.
+    // specified memory region. It takes the same virtual time that an ADC
+    // would take to sample the same quantity of data.
     bool fillBuffer(stream_sample_t* dest, size_t sz)
     {
-        size_t i = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
         if (!m_run_thread) return false;
 
-        assert(m_func_running == false);
         m_func_running = true;
+        m_deadline     = vclock_now();
 
-        auto reset_func_running = [&]()
-        {
-            assert(m_func_running == true);
-            m_func_running = false;
-        };
+        bool ok = waitSampling(lock, sz);
+        if (ok) readSamples(dest, sz);
 
-        using std::chrono::microseconds;
+        m_func_running = false;
+        m_cond.notify_all();
 
-        if (m_sampleRate > 0)
-        {
-            // Do a piecewise-sleep so that it's easily interruptible
-            uint64_t microsec = sz * 1000000 / m_sampleRate;
-            while (microsec > 10000)
-            {
-                if (!m_run_thread)
-                {
-                    // Early exit if the class is being deallocated
-                    reset_func_running();
-                    return false;
-                }
+        return ok;
+    }
 
-                std::this_thread::sleep_for(microseconds(10000));
-                microsec -= 10000;
-            }
-            std::this_thread::sleep_for(microseconds(microsec));
+    // Wait for the time needed to sample the given number of samples,
+    // counted from the end of the previous acquisition. Time is measured by
+    // the virtual clock, sleeping in slices so that the wait can be
+    // interrupted. Returns early, with false, if the stream is being stopped.
+    bool waitSampling(std::unique_lock<std::mutex>& lock, size_t samples)
+    {
+        if (m_sampleRate == 0 || gConsumerPaced)
+        {
+            m_deadline = vclock_now();
+            return m_run_thread;
         }
 
-        if (!m_run_thread)
+        m_deadline += (samples * 1000000000.0) / m_sampleRate;
+
+        while (m_run_thread)
         {
-            // Early exit if the class is being deallocated
-            reset_func_running();
-            return false;
+            int64_t now = vclock_now();
+            if (now >= m_deadline) break;
+
+            lock.unlock();
+            vclock_sleepUntil(std::min(m_deadline, now + STOP_CHECK_NS));
+            lock.lock();
         }
 
-        // Fill the buffer
-        while (i < sz)
+        return m_run_thread;
+    }
+
+    // Copy samples from the mapped file, restarting from the beginning when
+    // its end is reached
+    void readSamples(stream_sample_t* dest, size_t sz)
+    {
+        while (sz > 0)
         {
-            auto n = fread(dest + i, 2, sz - i, m_fp);
-            if (n < (sz - i)) fseek(m_fp, 0, SEEK_SET);
-            i += n;
-        }
+            size_t n = std::min(sz, m_samples - m_pos);
+            memcpy(dest, m_data + m_pos, n * sizeof(stream_sample_t));
 
-        assert(i == sz);
-        reset_func_running();
-        return true;
+            dest  += n;
+            sz    -= n;
+            m_pos += n;
+            if (m_pos >= m_samples) m_pos = 0;
+        }
     }
 
     void stopThread()
     {
-        m_run_thread = false;
-
-        while (m_func_running)
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_run_thread = false;
+            m_cond.notify_all();
+
+            // Wait for a linear acquisition running on another thread
+            vclockBlock_t block = {false};
+            vclock_blockBegin(&block);
+            m_cond.wait(lock, [&] { return !m_func_running; });
+            vclock_blockEnd(&block);
+        }
 
-        if (m_thread.joinable()) m_thread.join();
+        if (m_thread.joinable())
+        {
+            vclockBlock_t block = {false};
+            vclock_blockBegin(&block);
+            m_thread.join();
+            vclock_blockEnd(&block);
+        }
     }
 };
 
@@ -348,6 +453,16 @@ dataBlock_t inputStream_getData(streamId id)
     return stream->getDataBlock();
 }
 
+void inputStream_setCallback(streamId id, streamCallback_t callback, void* arg)
+{
+    for (auto& i : gOpenStreams)
+        if (i.second->id() == id)
+        {
+            i.second->setCallback(callback, arg);
+            break;
+        }
+}
+
 void inputStream_stop(streamId id)
 {
     AudioSource src;
@@ -364,3 +479,18 @@ void inputStream_stop(streamId id)
 
     gOpenStreams.erase(src);
 }
+
+void inputStream_setTimeScale(const float scale)
+{
+    if (scale < 0.0f) return;
+
+    gConsumerPaced = (scale == 0.0f);
+    if (scale > 0.0f) vclock_setScale(scale);
+}
+
+float inputStream_getTimeScale()
+{
+    if (gConsumerPaced) return 0.0f;
+
+    return vclock_getScale();
+}
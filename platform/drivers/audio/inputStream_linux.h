@@ -0,0 +1,62 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef INPUTSTREAM_LINUX_H
+#define INPUTSTREAM_LINUX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Linux only extension of the input stream interface, controlling the speed
+ * at which the emulated ADC replays the <SOURCE>.raw files.
+ *
+ * Sampling time is measured by the virtual clock of the Linux build, thus the
+ * replay speed is the one of the virtual time, set by the OPENRTX_CLOCK
+ * environment variable. The time scale is the ratio between the replay speed
+ * and the real time one: 1.0 is real time, 4.0 is four times faster than real
+ * time and so on. A time scale of zero replays the data as fast as the
+ * consumer reads it: in circular buffer mode the emulated ADC waits for each
+ * half of the buffer to be released by the consumer instead of overwriting it.
+ */
+
+/**
+ * Set the time scale of the emulated ADC. A value greater than zero changes
+ * the speed of the virtual clock, see vclock_setScale(), the change applies
+ * immediately also to the streams already running. Negative values are
+ * ignored.
+ *
+ * @param scale: new time scale, zero for "as fast as the consumer".
+ */
+void inputStream_setTimeScale(const float scale);
+
+/**
+ * Get the current time scale of the emulated ADC.
+ *
+ * @return current time scale, zero when replaying as fast as the consumer.
+ */
+float inputStream_getTimeScale();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INPUTSTREAM_LINUX_H */
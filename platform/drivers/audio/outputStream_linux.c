@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include <interfaces/audio_stream.h>
+#include <virtual_clock.h>
 #include <pulse/pulseaudio.h>
 #include <pulse/simple.h>
 #include <pulse/error.h>
@@ -49,8 +50,12 @@ static stream_sample_t   *playBuf    = NULL;        // Buffer being reproduced
 static stream_sample_t   *idleBuf    = NULL;        // Idle buffer available to be filled
 static pa_simple         *paInstance = NULL;        // Pulseaudio instance
 static size_t             remaining  = 0;
-static pthread_cond_t     barrier;
-static pthread_mutex_t    mutex;
+static pthread_cond_t     barrier    = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t    mutex      = PTHREAD_MUTEX_INITIALIZER;
+static bool               simulated  = false;       // Emulated DAC in use
+static uint32_t           rate       = 0;           // Sample rate, emulated DAC
+static pthread_t          dacThread;                // Emulated DAC thread
+static vclockBlock_t      syncBlock;                // Wait in outputStream_sync()
 
 static void buf_circ_write_cb(pa_stream* s, size_t length, void* userdata)
 {
@@ -95,6 +100,39 @@ static void buf_circ_write_cb(pa_stream* s, size_t length, void* userdata)
     }
 }
 
+/**
+ * \internal Emulated DAC, used in place of PulseAudio when the virtual clock
+ * does not run in real time: "plays" the two halves of the buffer in turn,
+ * taking the time a DAC would take with respect to the virtual clock.
+ */
+static void *dacThreadFunc(void *arg)
+{
+    (void) arg;
+
+    int64_t halfTime = ((int64_t) (bufLen / 2) * 1000000000LL) / rate;
+    int64_t deadline = vclock_now();
+
+    while(running)
+    {
+        deadline += halfTime;
+        vclock_sleepUntil(deadline);
+
+        pthread_mutex_lock(&mutex);
+
+        // Swap idle and play buffers
+        stream_sample_t *tmp = playBuf;
+        playBuf = idleBuf;
+        idleBuf = tmp;
+
+        // Unlock waiting threads
+        vclock_blockEnd(&syncBlock);
+        pthread_cond_signal(&barrier);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    return NULL;
+}
+
 streamId outputStream_start(const enum AudioSink destination,
                             const enum AudioPriority prio,
                             stream_sample_t* const buffer,
@@ -124,6 +162,27 @@ streamId outputStream_start(const enum AudioSink destination,
     bufLen    = length;
     remaining = length/2;
 
+    // Bypass PulseAudio when not running in real time
+    simulated = (vclock_isWallClock() == false);
+    if(simulated)
+    {
+        rate = sampleRate;
+
+        if(mode == BUF_LINEAR)
+        {
+            int64_t duration = ((int64_t) length * 1000000000LL) / rate;
+            vclock_sleepUntil(vclock_now() + duration);
+        }
+        else if(pthread_create(&dacThread, NULL, dacThreadFunc, NULL) != 0)
+        {
+            running  = false;
+            priority = PRIO_BEEP;
+            return -1;
+        }
+
+        return 0;
+    }
+
     int  paError = 0;
     bool success = true;
 
@@ -146,11 +205,6 @@ streamId outputStream_start(const enum AudioSink destination,
 
             success = false;
         }
-        else
-        {
-            pthread_mutex_init(&mutex, NULL);
-            pthread_cond_init(&barrier, NULL);
-        }
     }
 
     switch(mode)
@@ -230,7 +284,9 @@ bool outputStream_sync(const streamId id, const bool bufChanged)
     if(bufMode == BUF_CIRC_DOUBLE)
     {
         pthread_mutex_lock(&mutex);
+        vclock_blockBegin(&syncBlock);
         pthread_cond_wait(&barrier, &mutex);
+        vclock_blockEnd(&syncBlock);
         pthread_mutex_unlock(&mutex);
     }
 
@@ -241,10 +297,40 @@ bool outputStream_sync(const streamId id, const bool bufChanged)
     return true;
 }
 
+/**
+ * \internal Stop the emulated DAC, waking up any thread waiting on it.
+ */
+static void stopSimulated()
+{
+    running = false;
+
+    if(bufMode == BUF_CIRC_DOUBLE)
+    {
+        vclockBlock_t block = {false};
+        vclock_blockBegin(&block);
+        pthread_join(dacThread, NULL);
+        vclock_blockEnd(&block);
+
+        pthread_mutex_lock(&mutex);
+        vclock_blockEnd(&syncBlock);
+        pthread_cond_broadcast(&barrier);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    priority  = PRIO_BEEP;
+    simulated = false;
+}
+
 void outputStream_stop(const streamId id)
 {
     (void) id;
 
+    if(simulated)
+    {
+        stopSimulated();
+        return;
+    }
+
     int error = 0;
     if (pa_simple_flush(paInstance, &error) < 0)
     {
@@ -260,13 +346,15 @@ void outputStream_terminate(const streamId id)
 {
     (void) id;
 
+    if(simulated)
+        stopSimulated();
+
     running  = false;
     priority = PRIO_BEEP;
 
     if(paInstance != NULL)
     {
         pa_simple_free(paInstance);
-        pthread_mutex_destroy(&mutex);
-        pthread_cond_destroy(&barrier);
+        paInstance = NULL;
     }
 }
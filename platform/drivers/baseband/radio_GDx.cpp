@@ -242,7 +242,7 @@ void radio_disableRtx()
     radioStatus = OFF;
 }
 
-void radio_updateConfiguration()
+void radio_updateConfiguration(const uint32_t changes)
 {
     currRxBand = getBandFromFrequency(config->rxFrequency);
     currTxBand = getBandFromFrequency(config->txFrequency);
@@ -254,85 +254,98 @@ void radio_updateConfiguration()
      */
     const bandCalData_t *cal = &(calData->data[currRxBand]);
 
-    at1846s.setRxAudioGain(cal->rxDacGain, cal->rxVoiceGain);
-
-    if(config->bandwidth == BW_12_5)
+    if(changes & (RTX_CFG_RX_FREQ | RTX_CFG_BANDWIDTH))
     {
-        at1846s.setNoise1Thresholds(cal->noise1_HighTsh_Nb, cal->noise1_LowTsh_Nb);
-        at1846s.setNoise2Thresholds(cal->noise2_HighTsh_Nb, cal->noise2_LowTsh_Nb);
-        at1846s.setRssiThresholds(cal->rssi_HighTsh_Nb, cal->rssi_LowTsh_Nb);
-    }
-    else
-    {
-        at1846s.setNoise1Thresholds(cal->noise1_HighTsh_Wb, cal->noise1_LowTsh_Wb);
-        at1846s.setNoise2Thresholds(cal->noise2_HighTsh_Wb, cal->noise2_LowTsh_Wb);
-        at1846s.setRssiThresholds(cal->rssi_HighTsh_Wb, cal->rssi_LowTsh_Wb);
-    }
+        at1846s.setRxAudioGain(cal->rxDacGain, cal->rxVoiceGain);
 
-    C6000.writeCfgRegister(0x37, cal->digAudioGain);    // DACDATA gain
+        if(config->bandwidth == BW_12_5)
+        {
+            at1846s.setNoise1Thresholds(cal->noise1_HighTsh_Nb, cal->noise1_LowTsh_Nb);
+            at1846s.setNoise2Thresholds(cal->noise2_HighTsh_Nb, cal->noise2_LowTsh_Nb);
+            at1846s.setRssiThresholds(cal->rssi_HighTsh_Nb, cal->rssi_LowTsh_Nb);
+        }
+        else
+        {
+            at1846s.setNoise1Thresholds(cal->noise1_HighTsh_Wb, cal->noise1_LowTsh_Wb);
+            at1846s.setNoise2Thresholds(cal->noise2_HighTsh_Wb, cal->noise2_LowTsh_Wb);
+            at1846s.setRssiThresholds(cal->rssi_HighTsh_Wb, cal->rssi_LowTsh_Wb);
+        }
 
-    uint8_t sqlTresh = 0;
-    if(currRxBand == BND_VHF)
-    {
-        sqlTresh = interpCalParameter(config->rxFrequency, calData->vhfCalPoints,
-                                      cal->analogSqlThresh, 8);
-    }
-    else
-    {
-        sqlTresh = interpCalParameter(config->rxFrequency, calData->uhfCalPoints,
-                                      cal->analogSqlThresh, 8);
-    }
+        C6000.writeCfgRegister(0x37, cal->digAudioGain);    // DACDATA gain
 
-    at1846s.setAnalogSqlThresh(sqlTresh);
+        uint8_t sqlTresh = 0;
+        if(currRxBand == BND_VHF)
+        {
+            sqlTresh = interpCalParameter(config->rxFrequency, calData->vhfCalPoints,
+                                          cal->analogSqlThresh, 8);
+        }
+        else
+        {
+            sqlTresh = interpCalParameter(config->rxFrequency, calData->uhfCalPoints,
+                                          cal->analogSqlThresh, 8);
+        }
+
+        at1846s.setAnalogSqlThresh(sqlTresh);
+    }
 
     /*
      * Parameters dependent on TX frequency only
      */
-    at1846s.setPgaGain(calData->data[currTxBand].PGA_gain);
-    at1846s.setMicGain(calData->data[currTxBand].analogMicGain);
-    at1846s.setAgcGain(calData->data[currTxBand].rxAGCgain);
-    at1846s.setPaDrive(calData->data[currTxBand].PA_drv);
-
-    uint8_t mod1Amp  = 0;
-    uint8_t txpwr_lo = 0;
-    uint8_t txpwr_hi = 0;
+    if(changes & RTX_CFG_TX_FREQ)
+    {
+        at1846s.setPgaGain(calData->data[currTxBand].PGA_gain);
+        at1846s.setMicGain(calData->data[currTxBand].analogMicGain);
+        at1846s.setAgcGain(calData->data[currTxBand].rxAGCgain);
+        at1846s.setPaDrive(calData->data[currTxBand].PA_drv);
+    }
 
-    if(currTxBand == BND_VHF)
+    // Modulation amplitude and APC voltage, the former being calibrated on
+    // the RX band
+    if(changes & (RTX_CFG_TX_FREQ | RTX_CFG_RX_FREQ | RTX_CFG_TX_POWER))
     {
-        /* VHF band */
-        txpwr_lo = interpCalParameter(config->txFrequency, calData->vhfCalPoints,
-                                      calData->data[currTxBand].txLowPower, 8);
+        uint8_t mod1Amp  = 0;
+        uint8_t txpwr_lo = 0;
+        uint8_t txpwr_hi = 0;
 
-        txpwr_hi = interpCalParameter(config->txFrequency, calData->vhfCalPoints,
-                                      calData->data[currTxBand].txHighPower, 8);
+        if(currTxBand == BND_VHF)
+        {
+            /* VHF band */
+            txpwr_lo = interpCalParameter(config->txFrequency, calData->vhfCalPoints,
+                                          calData->data[currTxBand].txLowPower, 8);
 
-        mod1Amp = interpCalParameter(config->txFrequency, calData->vhfCalPoints,
-                                     cal->mod1Amplitude, 8);
-    }
-    else
-    {
-        /* UHF band */
-        txpwr_lo = interpCalParameter(config->txFrequency, calData->uhfPwrCalPoints,
-                                      calData->data[currTxBand].txLowPower, 16);
+            txpwr_hi = interpCalParameter(config->txFrequency, calData->vhfCalPoints,
+                                          calData->data[currTxBand].txHighPower, 8);
+
+            mod1Amp = interpCalParameter(config->txFrequency, calData->vhfCalPoints,
+                                         cal->mod1Amplitude, 8);
+        }
+        else
+        {
+            /* UHF band */
+            txpwr_lo = interpCalParameter(config->txFrequency, calData->uhfPwrCalPoints,
+                                          calData->data[currTxBand].txLowPower, 16);
 
-        txpwr_hi = interpCalParameter(config->txFrequency, calData->uhfPwrCalPoints,
-                                      calData->data[currTxBand].txHighPower, 16);
+            txpwr_hi = interpCalParameter(config->txFrequency, calData->uhfPwrCalPoints,
+                                          calData->data[currTxBand].txHighPower, 16);
 
-        mod1Amp = interpCalParameter(config->txFrequency, calData->uhfCalPoints,
-                                     cal->mod1Amplitude, 8);
-    }
+            mod1Amp = interpCalParameter(config->txFrequency, calData->uhfCalPoints,
+                                         cal->mod1Amplitude, 8);
+        }
 
-    C6000.setModAmplitude(0, mod1Amp);
+        C6000.setModAmplitude(0, mod1Amp);
 
-    // Calculate APC voltage, constraining output power between 1W and 5W.
-    float power = std::max(std::min(config->txPower, 5.0f), 1.0f);
-    float pwrHi = static_cast< float >(txpwr_hi);
-    float pwrLo = static_cast< float >(txpwr_lo);
-    float apc   = pwrLo + (pwrHi - pwrLo)/4.0f*(power - 1.0f);
-    apcVoltage  = static_cast< uint16_t >(apc) * 16;
+        // Calculate APC voltage, constraining output power between 1W and 5W.
+        float power = std::max(std::min(config->txPower, 5.0f), 1.0f);
+        float pwrHi = static_cast< float >(txpwr_hi);
+        float pwrLo = static_cast< float >(txpwr_lo);
+        float apc   = pwrLo + (pwrHi - pwrLo)/4.0f*(power - 1.0f);
+        apcVoltage  = static_cast< uint16_t >(apc) * 16;
+    }
 
-    // Set bandwidth, only for analog FM mode
-    if(config->opMode == OPMODE_FM)
+    // Set bandwidth, only for analog FM mode. TX deviation depends also on
+    // the TX band.
+    if((changes & (RTX_CFG_BANDWIDTH | RTX_CFG_OPMODE | RTX_CFG_TX_FREQ)) &&
+       (config->opMode == OPMODE_FM))
     {
         switch(config->bandwidth)
         {
@@ -354,12 +367,12 @@ void radio_updateConfiguration()
 
     /*
      * Update VCO frequency and tuning parameters if current operating status
-     * is different from OFF.
+     * is different from OFF and the parameters it depends on changed.
      * This is done by calling again the corresponding functions, which is safe
      * to do and avoids code duplication.
      */
-    if(radioStatus == RX) radio_enableRx();
-    if(radioStatus == TX) radio_enableTx();
+    if((radioStatus == RX) && (changes & RADIO_RX_FIELDS)) radio_enableRx();
+    if((radioStatus == TX) && (changes & RADIO_TX_FIELDS)) radio_enableTx();
 }
 
 float radio_getRssi()
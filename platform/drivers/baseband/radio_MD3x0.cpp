@@ -330,53 +330,66 @@ void radio_disableRtx()
     radioStatus = OFF;
 }
 
-void radio_updateConfiguration()
+void radio_updateConfiguration(const uint32_t changes)
 {
     // Tuning voltage for RX input filter
-    vtune_rx = interpCalParameter(config->rxFrequency, calData->rxFreq,
-                                  calData->rxSensitivity, 9);
+    if(changes & RTX_CFG_RX_FREQ)
+    {
+        vtune_rx = interpCalParameter(config->rxFrequency, calData->rxFreq,
+                                      calData->rxSensitivity, 9);
+    }
 
     // APC voltage for TX output power control
-    txpwr_lo = interpCalParameter(config->txFrequency, calData->txFreq,
-                                  calData->txLowPower, 9);
+    if(changes & RTX_CFG_TX_FREQ)
+    {
+        txpwr_lo = interpCalParameter(config->txFrequency, calData->txFreq,
+                                      calData->txLowPower, 9);
 
-    txpwr_hi = interpCalParameter(config->txFrequency, calData->txFreq,
-                                  calData->txHighPower, 9);
+        txpwr_hi = interpCalParameter(config->txFrequency, calData->txFreq,
+                                      calData->txHighPower, 9);
+    }
 
     // HR_C5000 modulation amplitude
-    const uint8_t *Ical = calData->sendIrange;
-    const uint8_t *Qcal = calData->sendQrange;
-
-    if(config->opMode == OPMODE_FM)
+    if(changes & (RTX_CFG_TX_FREQ | RTX_CFG_OPMODE))
     {
-        Ical = calData->analogSendIrange;
-        Qcal = calData->analogSendQrange;
-    }
+        const uint8_t *Ical = calData->sendIrange;
+        const uint8_t *Qcal = calData->sendQrange;
 
-    uint8_t I = interpCalParameter(config->txFrequency, calData->txFreq, Ical, 9);
-    uint8_t Q = interpCalParameter(config->txFrequency, calData->txFreq, Qcal, 9);
+        if(config->opMode == OPMODE_FM)
+        {
+            Ical = calData->analogSendIrange;
+            Qcal = calData->analogSendQrange;
+        }
+
+        uint8_t I = interpCalParameter(config->txFrequency, calData->txFreq, Ical, 9);
+        uint8_t Q = interpCalParameter(config->txFrequency, calData->txFreq, Qcal, 9);
 
-    C5000.setModAmplitude(I, Q);
+        C5000.setModAmplitude(I, Q);
+    }
 
     // Set bandwidth, only for analog FM mode
-    if(config->opMode == OPMODE_FM)
+    if((changes & (RTX_CFG_BANDWIDTH | RTX_CFG_OPMODE)) &&
+       (config->opMode == OPMODE_FM))
     {
         enum bandwidth bw = static_cast< enum bandwidth >(config->bandwidth);
         _setBandwidth(bw);
     }
 
     // Set CTCSS tone
-    float tone = static_cast< float >(config->txTone) / 10.0f;
-    toneGen_setToneFreq(tone);
+    if(changes & RTX_CFG_TX_TONE)
+    {
+        float tone = static_cast< float >(config->txTone) / 10.0f;
+        toneGen_setToneFreq(tone);
+    }
 
     /*
      * Update VCO frequency and tuning parameters if current operating status
-     * is different from OFF.
+     * is different from OFF and the parameters it depends on changed.
      * This is done by calling again the corresponding functions, which is safe
      * to do and avoids code duplication.
      */
-    if(radioStatus == RX) radio_enableRx();
-    if(radioStatus == TX) radio_enableTx();
+    if((radioStatus == RX) && (changes & RADIO_RX_FIELDS)) radio_enableRx();
+    if((radioStatus == TX) && (changes & RADIO_TX_FIELDS)) radio_enableTx();
 }
 
 float radio_getRssi()
@@ -71,9 +71,9 @@ void radio_disableRtx()
 
 }
 
-void radio_updateConfiguration()
+void radio_updateConfiguration(const uint32_t changes)
 {
-
+    (void) changes;
 }
 
 float radio_getRssi()
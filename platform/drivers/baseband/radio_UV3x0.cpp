@@ -276,7 +276,7 @@ void radio_disableRtx()
     radioStatus = OFF;
 }
 
-void radio_updateConfiguration()
+void radio_updateConfiguration(const uint32_t changes)
 {
     currRxBand = getBandFromFrequency(config->rxFrequency);
     currTxBand = getBandFromFrequency(config->txFrequency);
@@ -292,43 +292,47 @@ void radio_updateConfiguration()
     if(currRxBand == BND_UHF) rxModBias = calData->uhfCal.freqAdjustMid;
     if(currTxBand == BND_UHF) txModBias = calData->uhfCal.freqAdjustMid;
 
-    /*
-     * Discarding "const" qualifier to suppress compiler warnings.
-     * This operation is safe anyway because calibration data is only read.
-     */
-    mduv3x0Calib_t *cal  = const_cast< mduv3x0Calib_t * >(calData);
-    uint8_t calPoints    = 5;
-    freq_t  *txCalPoints = cal->vhfCal.txFreq;
-    uint8_t *loPwrCal    = cal->vhfCal.txLowPower;
-    uint8_t *hiPwrCal    = cal->vhfCal.txHighPower;
-    uint8_t *qRangeCal   = (config->opMode == OPMODE_FM)
-                         ? cal->vhfCal.analogSendQrange
-                         : cal->vhfCal.sendQrange;
-
-    if(currTxBand == BND_UHF)
+    if(changes & (RTX_CFG_TX_FREQ | RTX_CFG_OPMODE))
     {
-        calPoints   = 9;
-        txCalPoints = cal->uhfCal.txFreq;
-        loPwrCal    = cal->uhfCal.txLowPower;
-        hiPwrCal    = cal->uhfCal.txHighPower;
-        qRangeCal   = (config->opMode == OPMODE_FM)
-                    ? cal->uhfCal.analogSendQrange
-                    : cal->uhfCal.sendQrange;
-    }
+        /*
+         * Discarding "const" qualifier to suppress compiler warnings.
+         * This operation is safe anyway because calibration data is only read.
+         */
+        mduv3x0Calib_t *cal  = const_cast< mduv3x0Calib_t * >(calData);
+        uint8_t calPoints    = 5;
+        freq_t  *txCalPoints = cal->vhfCal.txFreq;
+        uint8_t *loPwrCal    = cal->vhfCal.txLowPower;
+        uint8_t *hiPwrCal    = cal->vhfCal.txHighPower;
+        uint8_t *qRangeCal   = (config->opMode == OPMODE_FM)
+                             ? cal->vhfCal.analogSendQrange
+                             : cal->vhfCal.sendQrange;
+
+        if(currTxBand == BND_UHF)
+        {
+            calPoints   = 9;
+            txCalPoints = cal->uhfCal.txFreq;
+            loPwrCal    = cal->uhfCal.txLowPower;
+            hiPwrCal    = cal->uhfCal.txHighPower;
+            qRangeCal   = (config->opMode == OPMODE_FM)
+                        ? cal->uhfCal.analogSendQrange
+                        : cal->uhfCal.sendQrange;
+        }
 
-    // APC voltage for TX output power control
-    txpwr_lo = interpCalParameter(config->txFrequency, txCalPoints, loPwrCal,
-                                                                    calPoints);
-    txpwr_hi = interpCalParameter(config->txFrequency, txCalPoints, hiPwrCal,
-                                                                    calPoints);
+        // APC voltage for TX output power control
+        txpwr_lo = interpCalParameter(config->txFrequency, txCalPoints, loPwrCal,
+                                                                        calPoints);
+        txpwr_hi = interpCalParameter(config->txFrequency, txCalPoints, hiPwrCal,
+                                                                        calPoints);
 
-    // HR_C6000 modulation amplitude
-    uint8_t Q = interpCalParameter(config->txFrequency, txCalPoints, qRangeCal,
-                                                                     calPoints);
-    C6000.setModAmplitude(0, Q);
+        // HR_C6000 modulation amplitude
+        uint8_t Q = interpCalParameter(config->txFrequency, txCalPoints, qRangeCal,
+                                                                         calPoints);
+        C6000.setModAmplitude(0, Q);
+    }
 
     // Set bandwidth, only for analog FM mode
-    if(config->opMode == OPMODE_FM)
+    if((changes & (RTX_CFG_BANDWIDTH | RTX_CFG_OPMODE)) &&
+       (config->opMode == OPMODE_FM))
     {
         switch(config->bandwidth)
         {
@@ -348,12 +352,12 @@ void radio_updateConfiguration()
 
     /*
      * Update VCO frequency and tuning parameters if current operating status
-     * is different from OFF.
+     * is different from OFF and the parameters it depends on changed.
      * This is done by calling again the corresponding functions, which is safe
      * to do and avoids code duplication.
      */
-    if(radioStatus == RX) radio_enableRx();
-    if(radioStatus == TX) radio_enableTx();
+    if((radioStatus == RX) && (changes & RADIO_RX_FIELDS)) radio_enableRx();
+    if((radioStatus == TX) && (changes & RADIO_TX_FIELDS)) radio_enableTx();
 }
 
 float radio_getRssi()
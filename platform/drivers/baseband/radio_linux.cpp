@@ -73,9 +73,9 @@ void radio_disableRtx()
     puts("radio_linux: disableRtx() called");
 }
 
-void radio_updateConfiguration()
+void radio_updateConfiguration(const uint32_t changes)
 {
-    puts("radio_linux: updateConfiguration() called");
+    printf("radio_linux: updateConfiguration(0x%04x) called\n", changes);
 }
 
 float radio_getRssi()
@@ -1,8 +1,8 @@
 /***************************************************************************
- *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
- *                                Niccolò Izzo IU2KIN                      *
- *                                Frederik Saraci IU2NRO                   *
- *                                Silvano Seva IU2KWO                      *
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
  *                                                                         *
  *   This program is free software; you can redistribute it and/or modify  *
  *   it under the terms of the GNU General Public License as published by  *
@@ -18,20 +18,24 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
-#include <crc.h>
+#ifndef WAIT_HOOK_H
+#define WAIT_HOOK_H
 
-uint16_t crc_ccitt(const void *data, const size_t len)
-{
-    uint16_t x   = 0;
-    uint16_t crc = 0;
-    const uint8_t *buf = ((const uint8_t *) data);
+/**
+ * Platform hook marking the blocking waits of the shared queues, see
+ * ringbuf.hpp. Nothing to do here: the threads wait on the kernel scheduler.
+ */
+
+typedef struct { } waitHook_t;
 
-    for(size_t i = 0; i < len; i++)
-    {
-        x   = (crc >> 8) ^ buf[i];
-        x  ^= x >> 4;
-        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
-    }
+static inline void waitHook_begin(waitHook_t *hook)
+{
+    (void) hook;
+}
 
-    return crc;
+static inline void waitHook_end(waitHook_t *hook)
+{
+    (void) hook;
 }
+
+#endif /* WAIT_HOOK_H */
@@ -0,0 +1,41 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef WAIT_HOOK_H
+#define WAIT_HOOK_H
+
+/**
+ * Platform hook marking the blocking waits of the shared queues, see
+ * ringbuf.hpp. Nothing to do here: the threads wait on the kernel scheduler.
+ */
+
+typedef struct { } waitHook_t;
+
+static inline void waitHook_begin(waitHook_t *hook)
+{
+    (void) hook;
+}
+
+static inline void waitHook_end(waitHook_t *hook)
+{
+    (void) hook;
+}
+
+#endif /* WAIT_HOOK_H */
@@ -16,22 +16,21 @@
  ***************************************************************************/
 
 #include <interfaces/delays.h>
-#include <sys/time.h>
-#include <unistd.h>
-#include <stdio.h>
+#include <virtual_clock.h>
 
 /**
- * Implementation of the delay functions for x86_64.
+ * Implementation of the delay functions for x86_64, on top of the virtual
+ * clock of the Linux build.
  */
 
 void delayUs(unsigned int useconds)
 {
-    usleep(useconds);
+    vclock_sleepUntil(vclock_now() + (useconds * 1000LL));
 }
 
 void delayMs(unsigned int mseconds)
 {
-    usleep(mseconds*1000);
+    vclock_sleepUntil(vclock_now() + (mseconds * 1000000LL));
 }
 
 void sleepFor(unsigned int seconds, unsigned int mseconds)
@@ -42,9 +41,7 @@ void sleepFor(unsigned int seconds, unsigned int mseconds)
 
 void sleepUntil(long long timestamp)
 {
-    long long delta = timestamp - getTick();
-    if(delta <= 0) return;
-    delayMs(delta);
+    vclock_sleepUntil(timestamp * 1000000LL);
 }
 
 long long getTick()
@@ -54,8 +51,5 @@ long long getTick()
      * having a tick rate of 1kHz.
      */
 
-    struct timeval te;
-    gettimeofday(&te, NULL);
-    long long milliseconds = te.tv_sec*1000LL + te.tv_usec/1000;
-    return milliseconds;
+    return vclock_now() / 1000000LL;
 }
@@ -28,6 +28,11 @@
 #include <readline/readline.h>
 #include <readline/history.h>
 
+#include <interfaces/delays.h>
+#include <virtual_clock.h>
+#include <trace.h>
+#include <profiling.h>
+
 #include "emulator.h"
 #include "sdl_engine.h"
 
@@ -118,7 +123,7 @@ static int shell_ready(void *_self, int _argc, char **_argv)
 
     while(_skq_in > _skq_out)
     {
-        usleep(10 * 1000); //sleep until keyboard is caught up
+        delayMs(10); //sleep until keyboard is caught up
     }
     return SH_CONTINUE;
 }
@@ -295,6 +300,117 @@ static int toggleVariable(void *_self, int _argc, char **_argv)
     return SH_CONTINUE; // continue
 }
 
+#ifdef ENABLE_TRACE
+static bool traceWrite(const void *data, const size_t len, void *arg)
+{
+    return fwrite(data, 1, len, (FILE *) arg) == len;
+}
+#endif
+
+static int shell_trace(void *_self, int _argc, char **_argv)
+{
+    (void) _self;
+
+    #ifndef ENABLE_TRACE
+    (void) _argc;
+    (void) _argv;
+    printf("Tracing not compiled in, build with ENABLE_TRACE\n");
+    return SH_ERR;
+    #else
+    if(! _argc || _argv[0] == NULL)
+    {
+        printf("Tracing %s%s\n", trace_isEnabled() ? "enabled" : "disabled",
+               trace_isTriggered() ? ", triggered" : "");
+        return SH_CONTINUE;
+    }
+
+    if(strcmp(_argv[0], "on") == 0)
+    {
+        trace_enable(true);
+    }
+    else if(strcmp(_argv[0], "off") == 0)
+    {
+        trace_enable(false);
+    }
+    else if(strcmp(_argv[0], "dump") == 0)
+    {
+        char *filename = "trace.bin";
+        if((_argc > 1) && (_argv[1] != NULL))
+            filename = _argv[1];
+
+        FILE *file = fopen(filename, "wb");
+        if(file == NULL)
+        {
+            perror(filename);
+            return SH_ERR;
+        }
+
+        size_t records = trace_dump(traceWrite, file);
+        fclose(file);
+        printf("%zu records written to %s\n", records, filename);
+    }
+    else
+    {
+        printf("Usage: trace [on|off|dump [trace.bin]]\n");
+        return SH_ERR;
+    }
+
+    return SH_CONTINUE;
+    #endif
+}
+
+static int shell_profile(void *_self, int _argc, char **_argv)
+{
+    (void) _self;
+
+    #ifndef ENABLE_PROFILING
+    (void) _argc;
+    (void) _argv;
+    printf("Profiling not compiled in, build with ENABLE_PROFILING\n");
+    return SH_ERR;
+    #else
+    if(_argc && (_argv[0] != NULL))
+    {
+        if(strcmp(_argv[0], "reset") != 0)
+        {
+            printf("Usage: profile [reset]\n");
+            return SH_ERR;
+        }
+
+        profiling_reset();
+        return SH_CONTINUE;
+    }
+
+    uint32_t tpu = profiling_ticksPerUs();
+
+    printf("%-12s %8s %8s %8s %8s  histogram (<4us, <16us, ... >=16ms)\n",
+           "probe", "count", "min[us]", "avg[us]", "max[us]");
+
+    for(uint8_t i = 0; i < PROF_NUM_PROBES; i++)
+    {
+        profStats_t stats;
+        profiling_getStats(i, &stats);
+        if(stats.time.count == 0)
+        {
+            printf("%-12s %8d\n", profiling_probeName(i), 0);
+            continue;
+        }
+
+        printf("%-12s %8u %8.1f %8.1f %8.1f ", profiling_probeName(i),
+               stats.time.count, (float) stats.time.min / tpu,
+               (float) stats.time.total / stats.time.count / tpu,
+               (float) stats.time.max / tpu);
+
+        for(int j = 0; j < PROFILING_HIST_BINS; j++)
+            printf(" %u", stats.hist[j]);
+
+        printf("\n");
+    }
+
+    return SH_CONTINUE;
+    #endif
+}
+
 static int shell_sleep(void *_self, int _argc, char **_argv)
 {
     (void) _self;
@@ -305,8 +421,9 @@ static int shell_sleep(void *_self, int _argc, char **_argv)
         return SH_ERR;
     }
 
-    useconds_t sleepus = atoi(_argv[0]) * 1000;
-    usleep(sleepus);
+    // Sleep on the virtual clock, so that scripts follow its time
+    unsigned int sleepms = atoi(_argv[0]);
+    sleepFor(sleepms / 1000, sleepms % 1000);
     return SH_CONTINUE;
 }
 
@@ -365,6 +482,10 @@ static _climenu_option _options[] =
     {"screenshot", "[screenshot.bmp] Save screenshot to first arg or screenshot.bmp if none given",
                                 NULL,   screenshot
     },
+    {"trace",   "[on|off|dump [trace.bin]] Control the binary event tracing",
+                                NULL,   shell_trace },
+    {"profile", "[reset] Show or clear the execution time statistics",
+                                NULL,   shell_profile },
     {"sleep",   "Wait some number of ms",           NULL,   shell_sleep },
     {"help",    "Print this help",                  NULL,   shell_help },
     {"nop",     "Do nothing (useful for comments)", NULL,   shell_nop},
@@ -483,9 +604,20 @@ void *startCLIMenu()
     using_history();
     read_history(histfile);
 
+    /*
+     * With the fast forward clock, time stands still while a script is being
+     * read, so that only its sleep commands make time advance. Time keeps
+     * running while waiting for an interactive user.
+     */
+    bool interactive = isatty(STDIN_FILENO);
+    vclock_registerThread();
+
     do
     {
+        vclockBlock_t block = {false};
+        if(interactive) vclock_blockBegin(&block);
         char *r = readline(">");
+        vclock_blockEnd(&block);
 
         if(r == NULL)
         {
@@ -0,0 +1,351 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <virtual_clock.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+
+#define NSEC_PER_SEC     1000000000LL
+#define FAST_ORIGIN      NSEC_PER_SEC       // Start time in fast forward mode
+#define STALL_WARNING    1000000000LL       // Stall diagnostic, real time
+
+/**
+ * \internal Thread sleeping in fast forward mode. Waiters are kept in a list
+ * sorted by wakeup time.
+ */
+typedef struct waiter
+{
+    int64_t        deadline;
+    bool           woken;
+    struct waiter *next;
+}
+waiter_t;
+
+static pthread_once_t  initOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t mutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  cond     = PTHREAD_COND_INITIALIZER;
+static pthread_key_t   threadKey;
+
+static vclockMode_t    mode;
+static double          scale;
+static int64_t         realOrigin;      // Host monotonic time at clock start
+static int64_t         virtOrigin;      // Virtual time at clock start
+static int64_t         virtNow;         // Current time, fast forward mode
+static unsigned int    participants;    // Threads using the clock
+static unsigned int    idle;            // Threads sleeping or blocked
+static waiter_t       *waiters;         // Sleeping threads
+
+
+static int64_t hostTime(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+
+    return (ts.tv_sec * NSEC_PER_SEC) + ts.tv_nsec;
+}
+
+static struct timespec toTimespec(int64_t time)
+{
+    struct timespec ts;
+    ts.tv_sec  = time / NSEC_PER_SEC;
+    ts.tv_nsec = time % NSEC_PER_SEC;
+
+    return ts;
+}
+
+/**
+ * \internal Set the clock configuration and restart it, to be called with the
+ * mutex held.
+ */
+static void configure(const vclockMode_t newMode, const float newScale)
+{
+    mode       = newMode;
+    scale      = (newScale > 0.0f) ? newScale : 1.0f;
+    realOrigin = hostTime(CLOCK_MONOTONIC);
+
+    // In real time mode the clock starts from the wall clock time, as the
+    // previous gettimeofday() based implementation of getTick() did.
+    if(mode == VCLOCK_REALTIME)
+        virtOrigin = hostTime(CLOCK_REALTIME);
+    else
+        virtOrigin = FAST_ORIGIN;
+
+    virtNow = virtOrigin;
+}
+
+/**
+ * \internal Advance the fast forward clock to the earliest wakeup time if all
+ * the threads are idle, waking up the threads whose deadline expired. To be
+ * called with the mutex held.
+ */
+static void advance()
+{
+    if(waiters == NULL)
+        return;
+
+    if(idle < participants)
+        return;
+
+    if(waiters->deadline > virtNow)
+        virtNow = waiters->deadline;
+
+    // Woken threads are immediately accounted as running, so that time does
+    // not advance again before they get scheduled.
+    while((waiters != NULL) && (waiters->deadline <= virtNow))
+    {
+        waiters->woken = true;
+        waiters        = waiters->next;
+        idle--;
+    }
+
+    pthread_cond_broadcast(&cond);
+}
+
+static void threadExit(void *arg)
+{
+    (void) arg;
+
+    pthread_mutex_lock(&mutex);
+    participants--;
+    advance();
+    pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * \internal Register the calling thread as a participant of the clock, to be
+ * called with the mutex held.
+ */
+static void registerThread()
+{
+    if(pthread_getspecific(threadKey) != NULL)
+        return;
+
+    pthread_setspecific(threadKey, &threadKey);
+    participants++;
+}
+
+static void initialise()
+{
+    pthread_key_create(&threadKey, threadExit);
+
+    vclockMode_t envMode  = VCLOCK_REALTIME;
+    float        envScale = 1.0f;
+    const char  *env      = getenv("OPENRTX_CLOCK");
+
+    if(env != NULL)
+    {
+        if(strcmp(env, "fast") == 0)
+            envMode = VCLOCK_FAST_FORWARD;
+        else if(strncmp(env, "realtime:", 9) == 0)
+            envScale = strtof(env + 9, NULL);
+        else if(strcmp(env, "realtime") != 0)
+            fprintf(stderr, "Invalid OPENRTX_CLOCK value: %s\n", env);
+    }
+
+    configure(envMode, envScale);
+}
+
+
+void vclock_init(const vclockMode_t clockMode, const float clockScale)
+{
+    pthread_once(&initOnce, initialise);
+
+    pthread_mutex_lock(&mutex);
+    configure(clockMode, clockScale);
+    pthread_mutex_unlock(&mutex);
+}
+
+void vclock_setScale(const float newScale)
+{
+    pthread_once(&initOnce, initialise);
+
+    if(newScale <= 0.0f)
+        return;
+
+    pthread_mutex_lock(&mutex);
+
+    // Restart the real time clock from the current time, keeping it
+    // continuous across the change of speed
+    int64_t realNow = hostTime(CLOCK_MONOTONIC);
+    virtOrigin     += (int64_t) ((realNow - realOrigin) * scale);
+    realOrigin      = realNow;
+    scale           = newScale;
+
+    pthread_mutex_unlock(&mutex);
+}
+
+float vclock_getScale()
+{
+    pthread_once(&initOnce, initialise);
+
+    pthread_mutex_lock(&mutex);
+    float ret = (float) scale;
+    pthread_mutex_unlock(&mutex);
+
+    return ret;
+}
+
+bool vclock_isWallClock()
+{
+    pthread_once(&initOnce, initialise);
+
+    pthread_mutex_lock(&mutex);
+    bool ret = (mode == VCLOCK_REALTIME) && (scale == 1.0);
+    pthread_mutex_unlock(&mutex);
+
+    return ret;
+}
+
+int64_t vclock_now()
+{
+    pthread_once(&initOnce, initialise);
+
+    pthread_mutex_lock(&mutex);
+
+    int64_t now = virtNow;
+    if(mode == VCLOCK_REALTIME)
+    {
+        int64_t elapsed = hostTime(CLOCK_MONOTONIC) - realOrigin;
+        now = virtOrigin + (int64_t) (elapsed * scale);
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    return now;
+}
+
+void vclock_sleepUntil(const int64_t deadline)
+{
+    pthread_once(&initOnce, initialise);
+
+    if(mode == VCLOCK_REALTIME)
+    {
+        // Relative sleeps, clock_nanosleep() is not available on macOS. A
+        // change of scale applies to the sleeps started afterwards.
+        pthread_mutex_lock(&mutex);
+        int64_t realDeadline = realOrigin
+                             + (int64_t) ((deadline - virtOrigin) / scale);
+        pthread_mutex_unlock(&mutex);
+
+        int64_t delta        = realDeadline - hostTime(CLOCK_MONOTONIC);
+
+        while(delta > 0)
+        {
+            struct timespec ts = toTimespec(delta);
+            nanosleep(&ts, NULL);
+            delta = realDeadline - hostTime(CLOCK_MONOTONIC);
+        }
+
+        return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    registerThread();
+
+    if(deadline <= virtNow)
+    {
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+
+    // Insert in the waiting list, keeping it sorted
+    waiter_t   waiter = { deadline, false, NULL };
+    waiter_t **pos    = &waiters;
+    while((*pos != NULL) && ((*pos)->deadline <= deadline))
+        pos = &(*pos)->next;
+
+    waiter.next = *pos;
+    *pos        = &waiter;
+    idle++;
+
+    advance();
+
+    bool warned = false;
+    while(waiter.woken == false)
+    {
+        int64_t before     = virtNow;
+        struct timespec ts = toTimespec(hostTime(CLOCK_REALTIME) + STALL_WARNING);
+        int ret            = pthread_cond_timedwait(&cond, &mutex, &ts);
+
+        // Time has not been moving for a while: some thread is running for
+        // long or it is blocked without being marked as such. Only report it,
+        // forcing the time forward would make the simulation not repeatable.
+        if((ret == ETIMEDOUT) && (waiter.woken == false) &&
+           (virtNow == before) && (warned == false))
+        {
+            fprintf(stderr, "Virtual clock stalled: %u of %u threads running\n",
+                    participants - idle, participants);
+            warned = true;
+        }
+    }
+
+    pthread_mutex_unlock(&mutex);
+}
+
+void vclock_registerThread()
+{
+    pthread_once(&initOnce, initialise);
+
+    pthread_mutex_lock(&mutex);
+    registerThread();
+    pthread_mutex_unlock(&mutex);
+}
+
+void vclock_blockBegin(vclockBlock_t *block)
+{
+    pthread_once(&initOnce, initialise);
+
+    if(mode == VCLOCK_REALTIME)
+        return;
+
+    pthread_mutex_lock(&mutex);
+    registerThread();
+
+    if(block->idle == false)
+    {
+        block->idle = true;
+        idle++;
+        advance();
+    }
+
+    pthread_mutex_unlock(&mutex);
+}
+
+void vclock_blockEnd(vclockBlock_t *block)
+{
+    pthread_once(&initOnce, initialise);
+
+    if(mode == VCLOCK_REALTIME)
+        return;
+
+    pthread_mutex_lock(&mutex);
+
+    if(block->idle)
+    {
+        block->idle = false;
+        idle--;
+    }
+
+    pthread_mutex_unlock(&mutex);
+}
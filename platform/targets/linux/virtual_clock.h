@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Virtual time source of the Linux build, backing getTick(), sleepFor(),
+ * sleepUntil(), the delay functions and the timing of the emulated audio
+ * streams.
+ *
+ * In real time mode the virtual time is locked to the monotonic clock of the
+ * host, optionally running faster or slower by a constant factor.
+ *
+ * In fast forward mode the virtual time is a discrete event clock: it stands
+ * still while any thread using the clock is running and, when all of them are
+ * either sleeping or blocked, it jumps to the earliest pending wakeup. Threads
+ * take part in the clock as soon as they sleep on it for the first time, or
+ * when they call vclock_registerThread(). A thread blocking on something
+ * other than the clock must mark the wait with vclock_blockBegin() and
+ * vclock_blockEnd(), otherwise time stops: a warning is printed when it does
+ * not advance for one second of real time, but time is never forced forward
+ * so that a simulation always gives the same results.
+ *
+ * The clock is configured by the OPENRTX_CLOCK environment variable, set
+ * either to "realtime", "realtime:<scale>" or "fast", defaulting to real time
+ * when not set. This is the only speed setting of the Linux build: the
+ * emulated audio streams follow the virtual time.
+ */
+
+/**
+ * Operating modes of the virtual clock.
+ */
+typedef enum
+{
+    VCLOCK_REALTIME     = 0,    ///< Locked to real time, scaled.
+    VCLOCK_FAST_FORWARD = 1     ///< Discrete event, advances when all idle.
+}
+vclockMode_t;
+
+/**
+ * Marker for a wait on a synchronisation primitive other than the clock. It
+ * has to be initialised to zero.
+ */
+typedef struct
+{
+    bool idle;
+}
+vclockBlock_t;
+
+/**
+ * Configure the virtual clock, overriding the configuration taken from the
+ * environment. Has to be called before any thread uses the clock.
+ *
+ * @param mode: clock operating mode.
+ * @param scale: speed of virtual time with respect to real time, used only
+ * in real time mode.
+ */
+void vclock_init(const vclockMode_t mode, const float scale);
+
+/**
+ * Change the speed of the virtual time in real time mode, keeping the time
+ * continuous. The sleeps already in progress keep the previous speed.
+ *
+ * @param scale: speed of virtual time with respect to real time, values not
+ * greater than zero are ignored.
+ */
+void vclock_setScale(const float scale);
+
+/**
+ * @return speed of the virtual time with respect to real time, used only in
+ * real time mode.
+ */
+float vclock_getScale();
+
+/**
+ * @return true if the virtual time runs exactly as the real one, that is in
+ * real time mode with unitary scale.
+ */
+bool vclock_isWallClock();
+
+/**
+ * @return current virtual time, in nanoseconds.
+ */
+int64_t vclock_now();
+
+/**
+ * Suspend the calling thread until the virtual time reaches the given value.
+ *
+ * @param deadline: wakeup time, in nanoseconds.
+ */
+void vclock_sleepUntil(const int64_t deadline);
+
+/**
+ * Make the calling thread take part in the fast forward clock, so that time
+ * does not advance while it is running.
+ */
+void vclock_registerThread();
+
+/**
+ * Mark the calling thread as blocked waiting for another thread, allowing
+ * the fast forward clock to advance. Must be called with the lock protecting
+ * the wait condition held.
+ *
+ * @param block: marker of the wait.
+ */
+void vclock_blockBegin(vclockBlock_t *block);
+
+/**
+ * End a wait marked with vclock_blockBegin(). The thread satisfying the wait
+ * condition should call this function before waking the waiting thread, so
+ * that the clock does not advance in the meantime; subsequent calls have no
+ * effect.
+ *
+ * @param block: marker of the wait.
+ */
+void vclock_blockEnd(vclockBlock_t *block);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VIRTUAL_CLOCK_H */
@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef WAIT_HOOK_H
+#define WAIT_HOOK_H
+
+#include <stddef.h>
+#include <virtual_clock.h>
+
+/**
+ * Platform hook marking the blocking waits of the shared queues, see
+ * ringbuf.hpp. On Linux the waits are reported to the virtual clock, so that
+ * fast forward time keeps running while a thread sleeps on a queue.
+ *
+ * waitHook_begin() is called by the waiting thread with the queue lock held,
+ * waitHook_end() both by the waiting thread when it resumes and by the thread
+ * waking it, before signalling.
+ *
+ * The clock functions are referenced weakly: programs using the queues
+ * without linking the virtual clock, like the standalone tests, need no
+ * marking at all.
+ */
+
+#pragma weak vclock_blockBegin
+#pragma weak vclock_blockEnd
+
+typedef vclockBlock_t waitHook_t;
+
+static inline void waitHook_begin(waitHook_t *hook)
+{
+    if(vclock_blockBegin != NULL) vclock_blockBegin(hook);
+}
+
+static inline void waitHook_end(waitHook_t *hook)
+{
+    if(vclock_blockEnd != NULL) vclock_blockEnd(hook);
+}
+
+#endif /* WAIT_HOOK_H */
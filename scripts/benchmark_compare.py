@@ -0,0 +1,41 @@
+#! /usr/bin/env python3
+
+# Compare two JSON result files produced by the benchmark suite, reporting the
+# change of the median time of each case. Exits with an error if any case got
+# slower than the given tolerance.
+#
+# Usage: benchmark_compare.py <baseline.json> <current.json> [tolerance %]
+
+import json
+from sys import argv, exit
+
+if len(argv) < 3:
+    print("Usage: %s <baseline.json> <current.json> [tolerance %%]" % argv[0])
+    exit(-1)
+
+with open(argv[1]) as f:
+    baseline = {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+with open(argv[2]) as f:
+    current = json.load(f)["benchmarks"]
+
+tolerance   = float(argv[3]) if len(argv) > 3 else 10.0
+regressions = 0
+
+print("%-32s | %12s | %12s | %8s" % ("benchmark", "base [ns]", "curr [ns]", "change"))
+for b in current:
+    if b["name"] not in baseline:
+        print("%-32s | %12s | %12.1f |" % (b["name"], "-", b["median_ns"]))
+        continue
+
+    base   = baseline[b["name"]]["median_ns"]
+    change = 100.0 * (b["median_ns"] - base) / base
+    flag   = ""
+    if change > tolerance:
+        flag = "  <-- regression"
+        regressions += 1
+
+    print("%-32s | %12.1f | %12.1f | %+7.1f%%%s" % (b["name"], base,
+          b["median_ns"], change, flag))
+
+exit(1 if regressions > 0 else 0)
@@ -0,0 +1,321 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Offline M17 decoder: feeds a baseband recording straight into the M17
+ * demodulator and frame decoder, as fast as the CPU allows, and reports the
+ * decoded frames together with lock and throughput statistics.
+ *
+ * Input files are raw, signed 16 bit little endian samples, taken either at
+ * 24kHz (the native RX sample rate) or at 48kHz. Stream payload can optionally
+ * be decoded with codec2 to a raw 8kHz audio file.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <unistd.h>
+#include <codec2.h>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17FrameDecoder.hpp>
+
+using namespace std;
+
+static constexpr size_t BLOCK_SIZE = 480;       // Half of an M17 frame at 24kHz
+static constexpr size_t READ_SIZE  = 65536;     // Samples read at each time
+
+struct options
+{
+    unsigned int sampleRate = 24000;            // Input file sample rate
+    bool         invert     = false;            // Invert baseband phase
+    bool         quiet      = false;            // Do not print decoded frames
+    bool         soft       = true;             // Use soft decision decoding
+    const char  *audioFile  = nullptr;          // Codec2 decoded audio output
+};
+
+struct decodeStats
+{
+    size_t samples    = 0;                      // Input samples, at 24kHz
+    size_t frames     = 0;                      // Frames from demodulator
+    size_t lsfFrames  = 0;                      // Valid LSF frames
+    size_t lsfErrors  = 0;                      // LSF frames with bad CRC
+    size_t strFrames  = 0;                      // Stream frames
+    size_t unkFrames  = 0;                      // Unknown frames
+    size_t locks      = 0;                      // Lock acquisitions
+    size_t lockedBlks = 0;                      // Blocks processed while locked
+    double elapsed    = 0.0;                    // Processing time, seconds
+};
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options] <baseband file> [<baseband file> ...]\n", name);
+    printf("Options:\n");
+    printf("  -r <rate>   input sample rate, 24000 (default) or 48000\n");
+    printf("  -i          invert baseband phase\n");
+    printf("  -H          use hard decision decoding\n");
+    printf("  -a <file>   decode stream audio to a raw 8kHz file\n");
+    printf("  -q          quiet, print only statistics\n");
+}
+
+/**
+ * Read a whole baseband file, decimating it to 24kHz if needed.
+ */
+static bool loadBaseband(const char *path, const unsigned int sampleRate,
+                         vector< int16_t >& baseband)
+{
+    FILE *file = fopen(path, "rb");
+    if(file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    size_t decim = sampleRate / 24000;
+    vector< int16_t > buf(READ_SIZE * decim);
+
+    baseband.clear();
+    size_t read;
+    while((read = fread(buf.data(), sizeof(int16_t), buf.size(), file)) > 0)
+    {
+        for(size_t i = 0; i + decim <= read; i += decim)
+            baseband.push_back(buf[i]);
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+static void printFrame(M17::M17FrameType type, M17::M17FrameDecoder& decoder)
+{
+    if(type == M17::M17FrameType::LINK_SETUP)
+    {
+        M17::M17LinkSetupFrame lsf = decoder.getLsf();
+        if(lsf.valid() == false)
+        {
+            printf("LSF    CRC error\n");
+            return;
+        }
+
+        printf("LSF    %s -> %s\n", lsf.getSource().c_str(),
+                                    lsf.getDestination().c_str());
+    }
+    else if(type == M17::M17FrameType::STREAM)
+    {
+        M17::M17StreamFrame sf = decoder.getStreamFrame();
+        printf("STREAM %04x%s", sf.getFrameNumber() & 0x7FFF,
+                                sf.isLastFrame() ? " (last)" : "       ");
+        for(auto byte : sf.payload())
+            printf(" %02x", byte);
+
+        printf("\n");
+    }
+}
+
+static decodeStats decodeFile(vector< int16_t >& baseband, const options& opts,
+                              struct CODEC2 *codec2, FILE *audio)
+{
+    M17::M17Demodulator  demodulator;
+    M17::M17FrameDecoder decoder;
+    decodeStats          stats;
+    bool                 locked = false;
+
+    vector< int16_t > speech;
+    if(codec2 != NULL)
+        speech.resize(codec2_samples_per_frame(codec2));
+
+    demodulator.init();
+    demodulator.invertPhase(opts.invert);
+
+    auto start = chrono::steady_clock::now();
+
+    for(size_t pos = 0; pos < baseband.size(); pos += BLOCK_SIZE)
+    {
+        size_t      len   = min(BLOCK_SIZE, baseband.size() - pos);
+        dataBlock_t block = { &baseband[pos], len };
+        bool newFrame     = demodulator.update(block);
+        bool lock         = demodulator.isLocked();
+
+        // Reset frame decoder when transitioning from unlocked to locked state
+        if((lock == true) && (locked == false))
+        {
+            decoder.reset();
+            stats.locks++;
+        }
+
+        locked = lock;
+        if(locked) stats.lockedBlks++;
+
+        if((locked == false) || (newFrame == false))
+            continue;
+
+        M17::M17FrameType type;
+        if(opts.soft)
+        {
+            auto& soft  = demodulator.getSoftFrame();
+            auto& frame = demodulator.getFrame();
+            type        = decoder.decodeFrame(frame, soft);
+        }
+        else
+        {
+            type = decoder.decodeFrame(demodulator.getFrame());
+        }
+
+        stats.frames++;
+
+        switch(type)
+        {
+            case M17::M17FrameType::LINK_SETUP:
+                if(decoder.getLsf().valid())
+                    stats.lsfFrames++;
+                else
+                    stats.lsfErrors++;
+
+                break;
+
+            case M17::M17FrameType::STREAM:
+                stats.strFrames++;
+                break;
+
+            default:
+                stats.unkFrames++;
+                continue;
+        }
+
+        if(opts.quiet == false)
+            printFrame(type, decoder);
+
+        if((type == M17::M17FrameType::STREAM) && (codec2 != NULL))
+        {
+            M17::M17StreamFrame sf = decoder.getStreamFrame();
+            for(size_t i = 0; i < sf.payload().size(); i += 8)
+            {
+                codec2_decode(codec2, speech.data(), sf.payload().data() + i);
+                fwrite(speech.data(), sizeof(int16_t), speech.size(), audio);
+            }
+        }
+    }
+
+    auto end = chrono::steady_clock::now();
+
+    demodulator.terminate();
+
+    stats.samples = baseband.size();
+    stats.elapsed = chrono::duration< double >(end - start).count();
+
+    return stats;
+}
+
+static void printStats(const char *name, const decodeStats& stats)
+{
+    double duration = static_cast< double >(stats.samples) / 24000.0;
+    double blocks   = static_cast< double >(stats.samples) / BLOCK_SIZE;
+
+    printf("%s:\n", name);
+    printf("  duration     %.2f s, processed in %.3f s (%.1fx real time)\n",
+           duration, stats.elapsed, duration / stats.elapsed);
+    printf("  frames       %zu (%.0f frames/s), LSF %zu (%zu bad), stream %zu, unknown %zu\n",
+           stats.frames, stats.frames / stats.elapsed, stats.lsfFrames,
+           stats.lsfErrors, stats.strFrames, stats.unkFrames);
+    printf("  lock         %zu acquisitions, locked %.1f%% of the time\n",
+           stats.locks, (blocks > 0.0) ? 100.0 * stats.lockedBlks / blocks : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    options opts;
+    int     opt;
+
+    while((opt = getopt(argc, argv, "r:iHa:qh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'r': opts.sampleRate = atoi(optarg); break;
+            case 'i': opts.invert     = true;         break;
+            case 'H': opts.soft       = false;        break;
+            case 'a': opts.audioFile  = optarg;       break;
+            case 'q': opts.quiet      = true;         break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : -1;
+        }
+    }
+
+    if((optind >= argc) ||
+       ((opts.sampleRate != 24000) && (opts.sampleRate != 48000)))
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    struct CODEC2 *codec2 = NULL;
+    FILE          *audio  = NULL;
+    if(opts.audioFile != nullptr)
+    {
+        audio = fopen(opts.audioFile, "wb");
+        if(audio == NULL)
+        {
+            perror(opts.audioFile);
+            return -1;
+        }
+
+        codec2 = codec2_create(CODEC2_MODE_3200);
+    }
+
+    decodeStats total;
+    vector< int16_t > baseband;
+    int ret = 0;
+
+    for(int i = optind; i < argc; i++)
+    {
+        if(loadBaseband(argv[i], opts.sampleRate, baseband) == false)
+        {
+            ret = -1;
+            continue;
+        }
+
+        auto stats = decodeFile(baseband, opts, codec2, audio);
+        printStats(argv[i], stats);
+
+        total.samples    += stats.samples;
+        total.frames     += stats.frames;
+        total.lsfFrames  += stats.lsfFrames;
+        total.lsfErrors  += stats.lsfErrors;
+        total.strFrames  += stats.strFrames;
+        total.unkFrames  += stats.unkFrames;
+        total.locks      += stats.locks;
+        total.lockedBlks += stats.lockedBlks;
+        total.elapsed    += stats.elapsed;
+    }
+
+    if((argc - optind) > 1)
+        printStats("Total", total);
+
+    if(codec2 != NULL)
+    {
+        codec2_destroy(codec2);
+        fclose(audio);
+    }
+
+    return ret;
+}
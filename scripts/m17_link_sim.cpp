@@ -0,0 +1,492 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * End-to-end M17 link simulator: a transmission is generated with the frame
+ * encoder and the modulator, passed through a channel model and received with
+ * the demodulator and the frame decoder, measuring bit and frame error rates
+ * and the time needed to lock on the signal over a sweep of SNR values.
+ *
+ * The channel model works on the FM discriminator output and covers additive
+ * white gaussian noise, carrier frequency offset (seen by the receiver as a DC
+ * offset proportional to the frequency error), a plain DC offset, the drift
+ * between the transmitter and receiver sample clocks and phase inversion.
+ *
+ * The transmission is modulated once, then each SNR point is simulated by a
+ * pool of worker threads, repeating the reception several times with
+ * different noise and a random delay of the start of the transmission.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17Modulator.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace std;
+
+static constexpr size_t   BLOCK_SIZE  = 480;    // Half of an M17 frame at 24kHz
+static constexpr uint32_t TX_RATE     = 48000;  // Modulator sample rate
+static constexpr uint32_t RX_RATE     = 24000;  // Demodulator sample rate
+static constexpr float    SYM_DEV     = 800.0f; // Deviation of a unit symbol, Hz
+static constexpr float    RX_GAIN     = 0.25f;  // Channel gain, headroom for noise
+
+struct options
+{
+    float    snrStart  = 0.0f;                  // First SNR point, dB
+    float    snrStop   = 12.0f;                 // Last SNR point, dB
+    float    snrStep   = 1.0f;                  // SNR step, dB
+    size_t   frames    = 100;                   // Stream frames per transmission
+    size_t   trials    = 4;                     // Transmissions per SNR point
+    size_t   threads   = thread::hardware_concurrency();
+    float    freqOfs   = 0.0f;                  // Carrier frequency offset, Hz
+    float    dcOfs     = 0.0f;                  // DC offset, sample units
+    float    clockPpm  = 0.0f;                  // Rx sample clock error, ppm
+    bool     invert    = false;                 // Invert phase in the channel
+    bool     rxInvert  = false;                 // Invert phase in the receiver
+    bool     csv       = false;                 // Print results as CSV
+    unsigned seed      = 1;                     // Random seed
+};
+
+/**
+ * Transmitted signal, together with the data it carries.
+ */
+struct transmission
+{
+    vector< int16_t >        baseband;          // 48kHz, from the modulator
+    vector< M17::payload_t > payloads;          // Stream frame payloads
+    float                    level;             // Amplitude of a unit symbol
+};
+
+/**
+ * Results of the simulation of an SNR point, summed over all the trials.
+ */
+struct linkStats
+{
+    size_t frames    = 0;                       // Stream frames transmitted
+    size_t received  = 0;                       // Stream frames received
+    size_t bits      = 0;                       // Payload bits received
+    size_t bitErrors = 0;                       // Payload bit errors
+    size_t frmErrors = 0;                       // Lost or corrupted frames
+    size_t locks     = 0;                       // Lock acquisitions
+    size_t lockedTx  = 0;                       // Transmissions decoded
+    double lockTime  = 0.0;                     // Sum of the times to lock, s
+    double maxLock   = 0.0;                     // Worst time to lock, s
+};
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n", name);
+    printf("Options:\n");
+    printf("  -s <a:b:c>  SNR sweep from a to b dB in steps of c (default 0:12:1)\n");
+    printf("  -n <n>      stream frames per transmission (default 100)\n");
+    printf("  -t <n>      transmissions per SNR point (default 4)\n");
+    printf("  -j <n>      number of worker threads (default: number of cores)\n");
+    printf("  -f <Hz>     carrier frequency offset\n");
+    printf("  -d <value>  DC offset, in sample units\n");
+    printf("  -p <ppm>    receiver sample clock error\n");
+    printf("  -i          invert the signal phase in the channel\n");
+    printf("  -I          invert the signal phase in the receiver\n");
+    printf("  -c          print results in CSV format\n");
+    printf("  -r <seed>   random seed (default 1)\n");
+}
+
+template < size_t N >
+static size_t hammingDistance(const array< uint8_t, N >& a,
+                              const array< uint8_t, N >& b)
+{
+    size_t dist = 0;
+    for(size_t i = 0; i < N; i++)
+        dist += __builtin_popcount(a[i] ^ b[i]);
+
+    return dist;
+}
+
+/**
+ * Generate a complete transmission, LSF, stream frames with random payload
+ * and EOT, through the frame encoder and the modulator.
+ */
+static transmission transmit(const options& opts)
+{
+    default_random_engine rng(opts.seed);
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+
+    transmission           tx;
+    M17::M17FrameEncoder   encoder;
+    M17::M17Modulator      modulator;
+    M17::M17LinkSetupFrame lsf;
+    M17::frame_t           frame;
+    vector< int8_t >       symbols;
+
+    modulator.init();
+    modulator.setBasebandCallback([&](const int16_t *data, size_t len)
+    {
+        tx.baseband.insert(tx.baseband.end(), data, data + len);
+    });
+
+    auto send = [&](const M17::frame_t& frame)
+    {
+        for(auto byte : frame)
+        {
+            auto sym = M17::byteToSymbols(byte);
+            symbols.insert(symbols.end(), sym.begin(), sym.end());
+        }
+
+        modulator.send(frame);
+    };
+
+    // Preamble, two frames of alternated +3 and -3 symbols
+    modulator.start();
+    for(size_t i = 0; i < 2 * M17::M17_FRAME_SYMBOLS; i += 2)
+    {
+        symbols.push_back(+3);
+        symbols.push_back(-3);
+    }
+
+    lsf.clear();
+    lsf.setSource("IU2KWO");
+    lsf.setDestination("ALL");
+    lsf.updateCrc();
+
+    encoder.reset();
+    encoder.encodeLsf(lsf, frame);
+    send(frame);
+
+    for(size_t i = 0; i < opts.frames; i++)
+    {
+        M17::payload_t payload;
+        for(auto& byte : payload)
+            byte = rndValue(rng);
+
+        encoder.encodeStreamFrame(payload, frame, i == (opts.frames - 1));
+        send(frame);
+        tx.payloads.push_back(payload);
+    }
+
+    encoder.encodeEotFrame(frame);
+    send(frame);
+
+    /*
+     * Amplitude of a unit symbol, by least squares fit of the transmitted
+     * symbols on the baseband samples, searching for the filter delay giving
+     * the best fit.
+     */
+    static constexpr size_t SPS = TX_RATE / M17::M17_SYMBOL_RATE;
+    double bestCorr = 0.0;
+    tx.level        = 0.0f;
+
+    for(size_t delay = 0; delay < 10 * SPS; delay++)
+    {
+        double corr = 0.0;
+        double pwr  = 0.0;
+        for(size_t i = 0; (i * SPS) + delay < tx.baseband.size(); i++)
+        {
+            corr += symbols[i] * static_cast< double >(tx.baseband[(i * SPS) + delay]);
+            pwr  += symbols[i] * symbols[i];
+        }
+
+        if(fabs(corr) > fabs(bestCorr))
+        {
+            bestCorr = corr;
+            tx.level = static_cast< float >(corr / pwr);
+        }
+    }
+
+    return tx;
+}
+
+/**
+ * Channel model: apply the impairments and resample the transmitted signal at
+ * the receiver sample rate, with a random initial delay.
+ */
+static vector< int16_t > channel(const transmission& tx, const options& opts,
+                                 const float snr, default_random_engine& rng,
+                                 size_t& txStart)
+{
+    // Signal power at the receiver, without offsets
+    double power = 0.0;
+    for(auto s : tx.baseband)
+        power += static_cast< double >(s) * s;
+
+    power *= RX_GAIN * RX_GAIN / tx.baseband.size();
+
+    float sigma  = sqrt(power / pow(10.0, snr / 10.0));
+    float offset = opts.dcOfs + (opts.freqOfs * RX_GAIN * tx.level / SYM_DEV);
+    float sign   = opts.invert ? -1.0f : 1.0f;
+    normal_distribution< float > noise(0.0f, sigma);
+
+    // Leading silence, up to one frame, plus two frames of trailing silence
+    // to flush the demodulator.
+    uniform_int_distribution< size_t > rndDelay(0, 2 * BLOCK_SIZE);
+    txStart          = rndDelay(rng);
+    size_t txSamples = tx.baseband.size() * RX_RATE / TX_RATE;
+    size_t length    = txStart + txSamples + (4 * BLOCK_SIZE);
+
+    // Receiver sample times, in transmitter samples
+    double step  = (static_cast< double >(TX_RATE) / RX_RATE) * (1.0 + opts.clockPpm * 1e-6);
+    double start = -static_cast< double >(txStart) * step;
+
+    vector< int16_t > rx(length);
+    for(size_t i = 0; i < length; i++)
+    {
+        double t    = start + i * step;
+        float  s    = 0.0f;
+        double ip   = floor(t);
+        size_t idx  = static_cast< size_t >(ip);
+
+        if((t >= 0.0) && ((idx + 1) < tx.baseband.size()))
+        {
+            float frac = static_cast< float >(t - ip);
+            s = (1.0f - frac) * tx.baseband[idx] + frac * tx.baseband[idx + 1];
+            s = sign * ((RX_GAIN * s) + offset);
+        }
+        else
+        {
+            s = sign * offset;
+        }
+
+        s += noise(rng);
+        if(s >  32767.0f) s =  32767.0f;
+        if(s < -32768.0f) s = -32768.0f;
+        rx[i] = static_cast< int16_t >(lrintf(s));
+    }
+
+    return rx;
+}
+
+/**
+ * Receive a signal, accumulating the statistics against the transmitted data.
+ */
+static void receive(vector< int16_t >& baseband, const size_t txStart,
+                    const transmission& tx, const options& opts,
+                    linkStats& stats)
+{
+    M17::M17Demodulator  demodulator;
+    M17::M17FrameDecoder decoder;
+    vector< bool >       received(tx.payloads.size(), false);
+    bool                 locked   = false;
+    bool                 hasLock  = false;
+    size_t               lockPos  = 0;
+    size_t               lastFn   = SIZE_MAX;
+
+    demodulator.init();
+    demodulator.invertPhase(opts.rxInvert);
+
+    for(size_t pos = 0; pos + BLOCK_SIZE <= baseband.size(); pos += BLOCK_SIZE)
+    {
+        dataBlock_t block = { &baseband[pos], BLOCK_SIZE };
+        bool newFrame     = demodulator.update(block);
+        bool lock         = demodulator.isLocked();
+
+        if((lock == true) && (locked == false))
+        {
+            decoder.reset();
+            stats.locks++;
+            lockPos = pos + BLOCK_SIZE;
+            lastFn  = SIZE_MAX;
+        }
+
+        locked = lock;
+        if((locked == false) || (newFrame == false))
+            continue;
+
+        auto& frame = demodulator.getFrame();
+        auto& soft  = demodulator.getSoftFrame();
+        auto  type  = decoder.decodeFrame(frame, soft);
+
+        /*
+         * A lock counts only once the frames carry the transmitted data: a
+         * valid LSF or two stream frames in sequence. With an inverted phase
+         * the LSF syncword becomes the stream one, the demodulator locks but
+         * the frames are garbage.
+         */
+        M17::M17StreamFrame sf      = decoder.getStreamFrame();
+        size_t              fn      = sf.getFrameNumber() & 0x7FFF;
+        bool                decoded = false;
+
+        if(type == M17::M17FrameType::LINK_SETUP)
+        {
+            decoded = decoder.getLsf().valid();
+        }
+        else if(type == M17::M17FrameType::STREAM)
+        {
+            decoded = (lastFn != SIZE_MAX) && (fn == lastFn + 1);
+            lastFn  = fn;
+        }
+
+        // Time to lock, from the start of the transmission to the end of the
+        // block where the lock has been acquired.
+        if((decoded == true) && (hasLock == false))
+        {
+            double time = static_cast< double >(lockPos - txStart) / RX_RATE;
+            stats.lockTime += time;
+            stats.maxLock   = max(stats.maxLock, time);
+            stats.lockedTx++;
+            hasLock = true;
+        }
+
+        if(type != M17::M17FrameType::STREAM)
+            continue;
+
+        if((fn >= tx.payloads.size()) || received[fn])
+            continue;
+
+        size_t errors = hammingDistance(sf.payload(), tx.payloads[fn]);
+        received[fn]  = true;
+
+        stats.received  += 1;
+        stats.bits      += sf.payload().size() * 8;
+        stats.bitErrors += errors;
+        stats.frmErrors += (errors != 0) ? 1 : 0;
+    }
+
+    demodulator.terminate();
+
+    // Frames never received count as frame errors
+    stats.frames    += tx.payloads.size();
+    for(bool r : received)
+        stats.frmErrors += r ? 0 : 1;
+}
+
+static bool parseSweep(const char *str, options& opts)
+{
+    return sscanf(str, "%f:%f:%f", &opts.snrStart, &opts.snrStop,
+                  &opts.snrStep) == 3 && (opts.snrStep > 0.0f);
+}
+
+int main(int argc, char *argv[])
+{
+    options opts;
+    int     opt;
+
+    while((opt = getopt(argc, argv, "s:n:t:j:f:d:p:iIcr:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 's':
+                if(parseSweep(optarg, opts) == false)
+                {
+                    usage(argv[0]);
+                    return -1;
+                }
+                break;
+
+            case 'n': opts.frames   = atoi(optarg); break;
+            case 't': opts.trials   = atoi(optarg); break;
+            case 'j': opts.threads  = atoi(optarg); break;
+            case 'f': opts.freqOfs  = atof(optarg); break;
+            case 'd': opts.dcOfs    = atof(optarg); break;
+            case 'p': opts.clockPpm = atof(optarg); break;
+            case 'i': opts.invert   = true;         break;
+            case 'I': opts.rxInvert = true;         break;
+            case 'c': opts.csv      = true;         break;
+            case 'r': opts.seed     = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : -1;
+        }
+    }
+
+    if((opts.frames == 0) || (opts.trials == 0))
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    if(opts.threads == 0)
+        opts.threads = 1;
+
+    vector< float > snrs;
+    for(float snr = opts.snrStart; snr <= opts.snrStop + 1e-3f; snr += opts.snrStep)
+        snrs.push_back(snr);
+
+    // The modulator uses a shared interpolator: generate the transmission
+    // once, the channel and the receiver run in parallel.
+    const transmission tx = transmit(opts);
+
+    vector< linkStats > results(snrs.size());
+    atomic< size_t >    next(0);
+    vector< thread >    workers;
+
+    for(size_t i = 0; i < min(opts.threads, snrs.size()); i++)
+    {
+        workers.emplace_back([&]
+        {
+            size_t point;
+            while((point = next++) < snrs.size())
+            {
+                for(size_t trial = 0; trial < opts.trials; trial++)
+                {
+                    default_random_engine rng(opts.seed + (point * opts.trials) + trial);
+
+                    size_t txStart;
+                    auto   rx = channel(tx, opts, snrs[point], rng, txStart);
+                    receive(rx, txStart, tx, opts, results[point]);
+                }
+            }
+        });
+    }
+
+    for(auto& w : workers)
+        w.join();
+
+    if(opts.csv)
+        printf("snr,frames,received,ber,fer,locked,lock_avg,lock_max,locks\n");
+    else
+        printf(" SNR [dB] | frames |    BER     |   FER   | locked | lock avg [ms] | lock max [ms] | locks\n");
+
+    for(size_t i = 0; i < snrs.size(); i++)
+    {
+        auto&  st  = results[i];
+        double ber = (st.bits > 0) ? static_cast< double >(st.bitErrors) / st.bits : 1.0;
+        double fer = static_cast< double >(st.frmErrors) / st.frames;
+        double avg = (st.lockedTx > 0) ? 1000.0 * st.lockTime / st.lockedTx : 0.0;
+
+        if(opts.csv)
+        {
+            printf("%.1f,%zu,%zu,%.3e,%.4f,%zu,%.1f,%.1f,%zu\n", snrs[i],
+                   st.frames, st.received, ber, fer, st.lockedTx, avg,
+                   1000.0 * st.maxLock, st.locks);
+        }
+        else
+        {
+            printf(" %8.1f | %6zu | %10.2e | %7.4f | %2zu/%-3zu | %13.1f | %13.1f | %5zu\n",
+                   snrs[i], st.frames, ber, fer, st.lockedTx, opts.trials,
+                   avg, 1000.0 * st.maxLock, st.locks);
+        }
+    }
+
+    // Lock acquired on every transmission and not a single frame decoded, even
+    // at the highest SNR: the receiver is working on the inverted signal.
+    auto& last = results.back();
+    if((opts.csv == false) && (last.lockedTx == 0) && (last.locks >= opts.trials))
+        printf("Locked without decoding any frame: signal phase is inverted\n");
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Multi-channel M17 monitor: receives M17 from several baseband inputs in
+ * parallel, using the multi-channel receive engine. Each input file or FIFO is
+ * a channel; alternatively a single multichannel stream, with the samples of
+ * the channels interleaved, can be given.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <M17/M17RxEngine.hpp>
+
+using namespace std;
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options] <input> [<input> ...]\n", name);
+    printf("Options:\n");
+    printf("  -j <n>      number of worker threads (default: number of cores)\n");
+    printf("  -r <rate>   input sample rate, 24000 (default) or 48000\n");
+    printf("  -m <n>      single input with <n> interleaved channels\n");
+    printf("  -v          print the decoded frames\n");
+}
+
+int main(int argc, char *argv[])
+{
+    size_t   threads    = thread::hardware_concurrency();
+    uint32_t sampleRate = 24000;
+    size_t   interleave = 0;
+    bool     verbose    = false;
+    int      opt;
+
+    while((opt = getopt(argc, argv, "j:r:m:vh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'j': threads    = atoi(optarg); break;
+            case 'r': sampleRate = atoi(optarg); break;
+            case 'm': interleave = atoi(optarg); break;
+            case 'v': verbose    = true;         break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : -1;
+        }
+    }
+
+    if((optind >= argc) || ((sampleRate != 24000) && (sampleRate != 48000)))
+    {
+        usage(argv[0]);
+        return -1;
+    }
+
+    M17::M17RxEngine engine(threads);
+
+    if(interleave > 0)
+    {
+        auto sources = M17::M17InterleavedStream::open(argv[optind], interleave,
+                                                       sampleRate);
+        if(sources.empty())
+        {
+            perror(argv[optind]);
+            return -1;
+        }
+
+        for(auto& src : sources)
+            engine.addChannel(move(src));
+    }
+    else
+    {
+        for(int i = optind; i < argc; i++)
+        {
+            unique_ptr< M17::M17FileSource > src(new M17::M17FileSource(argv[i],
+                                                                       sampleRate));
+            if(src->isOpen() == false)
+            {
+                perror(argv[i]);
+                return -1;
+            }
+
+            engine.addChannel(move(src));
+        }
+    }
+
+    mutex printMutex;
+    if(verbose)
+    {
+        engine.setFrameCallback([&](const size_t channel,
+                                    const M17::M17FrameType type,
+                                    M17::M17FrameDecoder& decoder)
+        {
+            lock_guard< mutex > lock(printMutex);
+
+            if(type == M17::M17FrameType::LINK_SETUP)
+            {
+                M17::M17LinkSetupFrame lsf = decoder.getLsf();
+                if(lsf.valid())
+                    printf("[%3zu] LSF    %s -> %s\n", channel,
+                           lsf.getSource().c_str(), lsf.getDestination().c_str());
+            }
+            else if(type == M17::M17FrameType::STREAM)
+            {
+                M17::M17StreamFrame sf = decoder.getStreamFrame();
+                printf("[%3zu] STREAM %04x\n", channel, sf.getFrameNumber() & 0x7FFF);
+            }
+        });
+    }
+
+    engine.run();
+
+    size_t totSamples = 0;
+    size_t totFrames  = 0;
+    double totBusy    = 0.0;
+
+    printf("chan | duration [s] | frames | LSF | stream | locks | locked\n");
+    for(size_t i = 0; i < engine.numChannels(); i++)
+    {
+        auto& st   = engine.getStats(i);
+        size_t blk = (st.samples + 479) / 480;
+        printf("%4zu | %12.2f | %6zu | %3zu | %6zu | %5zu | %5.1f%%\n", i,
+               st.samples / 24000.0, st.frames, st.lsfFrames, st.streamFrames,
+               st.locks, (blk > 0) ? (100.0 * st.lockedBlocks / blk) : 0.0);
+
+        totSamples += st.samples;
+        totFrames  += st.frames;
+        totBusy    += st.busyTime;
+    }
+
+    double elapsed  = engine.getElapsedTime();
+    double duration = totSamples / 24000.0;
+    printf("%zu channels, %zu threads: %.2f s of baseband in %.3f s, "
+           "%.0f frames/s, %.1fx real time (%.1fx per busy core second)\n",
+           engine.numChannels(), threads, duration, elapsed, totFrames / elapsed,
+           duration / elapsed, duration / totBusy);
+
+    return 0;
+}
@@ -1,22 +1,33 @@
 #! /usr/bin/env python3
 
+# Plot the M17 demodulator trace, as converted to CSV by trace_decode.py.
+# Usage: plot_m17_demod_csv.py <trace.csv> [dump number]
+
 import pandas as pd
 from matplotlib import pyplot as plt
 from sys import argv
 
 plt.rcParams["figure.autolayout"] = True
 df = pd.read_csv(argv[1])
+dump = int(argv[2]) if len(argv) > 2 else 0
+df = df[df.dump == dump]
 print("Contents in csv file:\n", df)
-plt.plot(df.index, df.Sample,              label="Sample")
-plt.plot(df.index, df.Convolution / 10,    label="Conv")
-plt.plot(df.index, df.Threshold / 10,      label="Conv. Th+")
-plt.plot(df.index, df.Threshold * -1 / 10, label="Conv. Th-")
-plt.plot(df.index, df.Index,               label="Index")
-plt.plot(df.index, df.Max,                 label="Qnt. avg. +")
-plt.plot(df.index, df.Min,                 label="Qnt. avg. -")
-plt.plot(df.index, df.Symbol * 10,         label="Symbol")
-plt.plot(df.index, df.I,                   label="I")
-plt.plot(df.index, df.Flags * 100,         label="Flags")
+
+corr = df[df.event == "M17_CORRELATION"]
+sym  = df[df.event == "M17_SYMBOL"]
+th   = df[df.event == "M17_THRESHOLDS"]
+sync = df[df.event == "M17_SYNC"]
+
+plt.plot(corr.time_us, corr.arg1,          label="Sample")
+plt.plot(corr.time_us, corr.arg2 / 10,     label="Conv")
+plt.plot(th.time_us,   th.arg1,            label="Qnt. avg. +")
+plt.plot(th.time_us,   th.arg2,            label="Qnt. avg. -")
+plt.scatter(sym.time_us, sym.arg1, s=4, c="black", label="Symbol sample")
+plt.scatter(sync.time_us, sync.arg1 / 10, marker="x", c="red", label="Sync")
+for ev, color in (("M17_LOCK", "green"), ("M17_UNLOCK", "red")):
+    for t in df[df.event == ev].time_us:
+        plt.axvline(t, color=color, linestyle="--")
+plt.xlabel("Time [us]")
 plt.grid(True)
 plt.legend(loc="upper left")
 plt.suptitle(argv[1])
@@ -0,0 +1,130 @@
+#! /usr/bin/env python3
+
+# Convert the binary dumps of the event tracing (see openrtx/include/core/trace.h)
+# to CSV. The input is either a file, as written by the emulator, or a serial
+# port receiving the dumps sent by a radio over the USB virtual COM port; in the
+# latter case the port is read until interrupted with Ctrl+C.
+#
+# Each dump is written as a group of rows, sorted by time. Times are in
+# microseconds, relative to the moment the dump was taken.
+#
+# Usage: trace_decode.py <trace.bin | /dev/ttyACM0> [output.csv]
+
+import os
+import struct
+import sys
+import termios
+
+MAGIC       = 0x43525452
+HEADER      = struct.Struct("<IHHIIII")
+RECORD      = struct.Struct("<IBBhii")
+
+EVENTS = {
+    1: "M17_CORRELATION",
+    2: "M17_SYNC",
+    3: "M17_SWEEP",
+    4: "M17_SYMBOL",
+    5: "M17_THRESHOLDS",
+    6: "M17_TIMING",
+    7: "M17_LOCK",
+    8: "M17_UNLOCK",
+    9: "M17_FRAME",
+}
+
+
+def open_input(path):
+    """
+    Open the input file, configuring it in raw mode if it is a serial port.
+    """
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        attrs = termios.tcgetattr(fd)
+        attrs[0] = 0                                # iflag
+        attrs[1] = 0                                # oflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0                                # lflag
+        attrs[4] = attrs[5] = termios.B115200
+        attrs[6][termios.VMIN]  = 1
+        attrs[6][termios.VTIME] = 0
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+
+    return os.fdopen(fd, "rb", buffering=0)
+
+
+def read_exact(f, size):
+    data = b""
+    while len(data) < size:
+        chunk = f.read(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+
+    return data
+
+
+def find_header(f):
+    """
+    Read up to the next dump header, skipping anything in between.
+    """
+    window = b""
+    magic  = struct.pack("<I", MAGIC)
+    while True:
+        byte = f.read(1)
+        if not byte:
+            return None
+
+        window = (window + byte)[-4:]
+        if window == magic:
+            rest = read_exact(f, HEADER.size - 4)
+            if rest is None:
+                return None
+
+            return HEADER.unpack(magic + rest)
+
+
+def decode(f, out):
+    out.write("dump,time_us,thread,event,arg0,arg1,arg2\n")
+    dumps = 0
+
+    while True:
+        header = find_header(f)
+        if header is None:
+            break
+
+        _, version, recsize, timebase, dumptime, count, dropped = header
+        if version != 1 or recsize != RECORD.size:
+            sys.stderr.write("Unsupported trace version %d\n" % version)
+            continue
+
+        data = read_exact(f, count * recsize)
+        if data is None:
+            sys.stderr.write("Truncated dump\n")
+            break
+
+        rows = []
+        for time, event, thread, a0, a1, a2 in RECORD.iter_unpack(data):
+            # Cycle counter is 32 bit wide, times are relative to the dump
+            age  = (dumptime - time) & 0xFFFFFFFF
+            usec = -age * 1e6 / timebase
+            rows.append((usec, thread, EVENTS.get(event, str(event)), a0, a1, a2))
+
+        rows.sort(key=lambda r: r[0])
+        for row in rows:
+            out.write("%d,%.3f,%d,%s,%d,%d,%d\n" % ((dumps,) + row))
+
+        sys.stderr.write("Dump %d: %d records, %d dropped\n" % (dumps, count, dropped))
+        out.flush()
+        dumps += 1
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print("Usage: %s <trace.bin | /dev/ttyACM0> [output.csv]" % sys.argv[0])
+        sys.exit(-1)
+
+    out = open(sys.argv[2], "w") if len(sys.argv) > 2 else sys.stdout
+    try:
+        with open_input(sys.argv[1]) as f:
+            decode(f, out)
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,186 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <M17/M17ConvolutionalEncoder.hpp>
+#include <M17/M17CodePuncturing.hpp>
+
+using namespace std;
+using namespace M17;
+
+/**
+ * Previous implementation of the convolutional encoder, shifting the input one
+ * bit at a time, kept as a reference for the benchmark.
+ */
+class LegacyEncoder
+{
+public:
+
+    void encode(const void *data, void *convolved, const size_t len)
+    {
+        const uint8_t  *src  = reinterpret_cast< const uint8_t * >(data);
+        uint16_t       *dest = reinterpret_cast< uint16_t * >(convolved);
+
+        for(size_t i = 0; i < len; i++)
+            dest[i] = convolveByte(src[i]);
+    }
+
+    uint16_t flush()
+    {
+        return convolveByte(0x00);
+    }
+
+    void reset()
+    {
+        memory = 0;
+    }
+
+private:
+
+    uint16_t convolveByte(uint8_t value)
+    {
+        uint16_t result = 0;
+
+        for(uint8_t i = 0; i < 8; i++)
+        {
+            memory  = (memory << 1) | ((value & 0x80) >> 7);
+            memory &= 0x1F;
+            result  = (result << 1) | (__builtin_popcount(memory & 0x19) & 0x01);
+            result  = (result << 1) | (__builtin_popcount(memory & 0x17) & 0x01);
+            value <<= 1;
+        }
+
+        return __builtin_bswap16(result);
+    }
+
+    uint8_t memory = 0;
+};
+
+static constexpr size_t NUM_FRAMES = 2000;
+static constexpr size_t REPEAT     = 100;
+
+static volatile uint8_t sink;
+
+template < typename F >
+static double measure(F func)
+{
+    auto start = chrono::steady_clock::now();
+    for(size_t r = 0; r < REPEAT; r++)
+        func();
+    auto stop = chrono::steady_clock::now();
+
+    return (REPEAT * NUM_FRAMES) / chrono::duration< double >(stop - start).count();
+}
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+
+    // Stream frame data: frame number and payload
+    vector< array< uint8_t, 18 > > frames(NUM_FRAMES);
+    for(auto& f : frames)
+    {
+        for(auto& byte : f)
+            byte = rndValue(rng);
+    }
+
+    LegacyEncoder           legacy;
+    M17ConvolutionalEncoder encoder;
+
+    // Check equivalence with the previous implementation
+    size_t mismatch = 0;
+    for(auto& f : frames)
+    {
+        array< uint8_t, 37 > encOld;
+        array< uint8_t, 37 > encNew;
+        array< uint8_t, 34 > punctOld;
+        array< uint8_t, 34 > punctNew;
+
+        legacy.reset();
+        legacy.encode(f.data(), encOld.data(), f.size());
+        encOld[36] = legacy.flush();
+        puncture(encOld, punctOld, DATA_PUNCTURE);
+
+        encoder.reset();
+        encoder.encode(f.data(), encNew.data(), f.size());
+        encNew[36] = encoder.flush();
+        if(encNew != encOld) mismatch++;
+
+        encoder.reset();
+        encoder.encodePunctured(f.data(), f.size(), punctNew, DATA_PUNCTURE);
+        if(punctNew != punctOld) mismatch++;
+    }
+
+    printf("%zu mismatches with previous encoder over %zu frames\n", mismatch,
+           NUM_FRAMES);
+
+    // Throughput of stream frame encoding
+    double tOld = measure([&]
+    {
+        for(auto& f : frames)
+        {
+            array< uint8_t, 37 > encoded;
+            array< uint8_t, 34 > punctured;
+            legacy.reset();
+            legacy.encode(f.data(), encoded.data(), f.size());
+            encoded[36] = legacy.flush();
+            puncture(encoded, punctured, DATA_PUNCTURE);
+            sink = punctured[0];
+        }
+    });
+
+    double tTable = measure([&]
+    {
+        for(auto& f : frames)
+        {
+            array< uint8_t, 37 > encoded;
+            array< uint8_t, 34 > punctured;
+            encoder.reset();
+            encoder.encode(f.data(), encoded.data(), f.size());
+            encoded[36] = encoder.flush();
+            puncture(encoded, punctured, DATA_PUNCTURE);
+            sink = punctured[0];
+        }
+    });
+
+    double tFused = measure([&]
+    {
+        for(auto& f : frames)
+        {
+            array< uint8_t, 34 > punctured;
+            encoder.reset();
+            encoder.encodePunctured(f.data(), f.size(), punctured, DATA_PUNCTURE);
+            sink = punctured[0];
+        }
+    });
+
+    printf("Previous encoder + puncture: %.0f frames/s\n", tOld);
+    printf("Table encoder + puncture:    %.0f frames/s (x%.2f)\n", tTable,
+           tTable / tOld);
+    printf("Fused encode and puncture:   %.0f frames/s (x%.2f)\n", tFused,
+           tFused / tOld);
+
+    return (mismatch == 0) ? 0 : -1;
+}
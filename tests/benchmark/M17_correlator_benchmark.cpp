@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+// Access private members of the demodulator
+#define private public
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <M17/M17Demodulator.hpp>
+
+using namespace std;
+using namespace M17;
+
+static constexpr size_t BLOCK_SIZE = 480;   // Half of an M17 frame at 24kHz
+static constexpr size_t NUM_BLOCKS = 5000;
+static constexpr size_t SPS        = 5;     // Samples per symbol at 24kHz
+static constexpr size_t SYNC_LEN   = 8;     // Syncword length, in symbols
+
+static constexpr int8_t syncword[SYNC_LEN] = { -3, -3, -3, -3, +3, +3, -3, +3 };
+
+static volatile int32_t sink;
+
+/**
+ * Previous syncword search: per-offset convolution selecting between bridge
+ * and block buffer on every tap, threshold computed with a square root.
+ */
+static int32_t legacySearch(const int16_t *bridge, const int16_t *data,
+                            int32_t bridgeLen, int32_t len, float& emvar)
+{
+    int32_t detections = 0;
+    int32_t maxLen = len - static_cast< int32_t >(SPS * SYNC_LEN);
+
+    for(int32_t i = -bridgeLen; i < maxLen; i++)
+    {
+        int32_t conv = 0;
+        for(size_t j = 0; j < SYNC_LEN; j++)
+        {
+            int32_t idx = i + j * SPS;
+            int16_t sample = (idx < 0) ? bridge[bridgeLen + idx] : data[idx];
+            conv += static_cast< int32_t >(syncword[j]) * sample;
+        }
+
+        float incr = 0.005f * static_cast< float >(conv);
+        emvar = (1.0f - 0.005f) * (emvar + static_cast< float >(conv) * incr);
+
+        float th = sqrt(emvar) * 3.40f;
+        if((conv > th) || (conv < -th)) detections++;
+    }
+
+    return detections;
+}
+
+/**
+ * New syncword search: sliding correlation over the contiguous window and
+ * squared threshold, as done by the demodulator.
+ */
+static int32_t windowSearch(M17Demodulator& demod)
+{
+    int32_t detections = 0;
+    int32_t offset     = -M17Demodulator::M17_BRIDGE_SIZE;
+
+    while(true)
+    {
+        sync_t sync = demod.nextFrameSync(offset);
+        if(sync.index == -1) break;
+
+        offset = sync.index + 1;
+        detections++;
+    }
+
+    return detections;
+}
+
+int main()
+{
+    default_random_engine rng;
+    normal_distribution< float > noise(0.0f, 3000.0f);
+
+    // Idle channel: gaussian noise only
+    vector< int16_t > input(BLOCK_SIZE * NUM_BLOCKS);
+    for(auto& s : input) s = static_cast< int16_t >(noise(rng));
+
+    M17Demodulator demod;
+    demod.init();
+
+    // Prime the working window
+    vector< int16_t > block(input.begin(), input.begin() + BLOCK_SIZE);
+    demod.update({ block.data(), BLOCK_SIZE });
+
+    const int16_t *data   = demod.baseband.data;
+    const int16_t *bridge = data - M17Demodulator::M17_BRIDGE_SIZE;
+    int32_t len           = demod.baseband.len;
+
+    // Syncword search kernels over the same block
+    float emvar = 40000000.0f;
+    auto start  = chrono::steady_clock::now();
+    for(size_t i = 0; i < NUM_BLOCKS; i++)
+        sink = legacySearch(bridge, data, M17Demodulator::M17_BRIDGE_SIZE,
+                            len, emvar);
+    auto stop = chrono::steady_clock::now();
+    double tLegacy = chrono::duration< double >(stop - start).count();
+
+    demod.resetCorrelationStats();
+    start = chrono::steady_clock::now();
+    for(size_t i = 0; i < NUM_BLOCKS; i++)
+        sink = windowSearch(demod);
+    stop = chrono::steady_clock::now();
+    double tWindow = chrono::duration< double >(stop - start).count();
+
+    double offsets = static_cast< double >(NUM_BLOCKS)
+                   * (len + M17Demodulator::M17_BRIDGE_SIZE - SPS * SYNC_LEN);
+    printf("Syncword search: legacy %.2f Moffsets/s, window %.2f Moffsets/s (x%.2f)\n",
+           offsets / tLegacy / 1e6, offsets / tWindow / 1e6, tLegacy / tWindow);
+
+    // Whole demodulator update on idle channel
+    demod.init();
+    start = chrono::steady_clock::now();
+    for(size_t i = 0; i < NUM_BLOCKS; i++)
+    {
+        block.assign(input.begin() + i * BLOCK_SIZE,
+                     input.begin() + (i + 1) * BLOCK_SIZE);
+        demod.update({ block.data(), BLOCK_SIZE });
+    }
+    stop = chrono::steady_clock::now();
+    double tUpdate = chrono::duration< double >(stop - start).count();
+
+    // Each block corresponds to 20ms of baseband signal
+    double usPerBlock = tUpdate / NUM_BLOCKS * 1e6;
+    printf("Idle channel update: %.2f us/block, %.3f%% of real time\n",
+           usPerBlock, usPerBlock / 20000.0 * 100.0);
+
+    return 0;
+}
@@ -0,0 +1,281 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <M17/M17Interleaver.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace std;
+using namespace M17;
+
+/**
+ * Previous implementation of the interleaver, computing the permutation
+ * polynomial and moving the data one bit at a time, kept as a reference for
+ * the benchmark.
+ */
+namespace legacy
+{
+
+template < size_t N >
+void interleave(std::array< uint8_t, N >& data)
+{
+    std::array< uint8_t, N > interleaved;
+
+    static constexpr size_t F1 = 45;
+    static constexpr size_t F2 = 92;
+    static constexpr size_t NB = N*8;
+
+    for(size_t i = 0; i < NB; i++)
+    {
+        size_t index = ((F1 * i) + (F2 * i * i)) % NB;
+        setBit(interleaved, index, getBit(data, i));
+    }
+
+    std::copy(interleaved.begin(), interleaved.end(), data.begin());
+}
+
+template < size_t N >
+void deinterleave(std::array< uint8_t, N >& data)
+{
+    std::array< uint8_t, N > deinterleaved;
+
+    static constexpr size_t F1 = 45;
+    static constexpr size_t F2 = 92;
+    static constexpr size_t NB = N*8;
+
+    for(size_t i = 0; i < NB; i++)
+    {
+        size_t index = ((F1 * i) + (F2 * i * i)) % NB;
+        setBit(deinterleaved, i, getBit(data, index));
+    }
+
+    std::copy(deinterleaved.begin(), deinterleaved.end(), data.begin());
+}
+
+template < size_t N >
+void deinterleave(std::array< uint16_t, N >& data)
+{
+    std::array< uint16_t, N > deinterleaved;
+
+    static constexpr size_t F1 = 45;
+    static constexpr size_t F2 = 92;
+
+    for(size_t i = 0; i < N; i++)
+    {
+        size_t index = ((F1 * i) + (F2 * i * i)) % N;
+        deinterleaved[i] = data[index];
+    }
+
+    std::copy(deinterleaved.begin(), deinterleaved.end(), data.begin());
+}
+
+}      // namespace legacy
+
+/**
+ * Deinterleave a section of a frame straight into the buffers of the decoding
+ * stages, reading each bit through the shared index table. This is the access
+ * pattern of the deframer, which fuses it with decorrelation and depuncturing.
+ */
+namespace sectioned
+{
+
+template < size_t N, size_t M >
+void deinterleave(const std::array< uint8_t, N >& in,
+                  std::array< uint8_t, M >& out, const size_t offset = 0)
+{
+    static_assert(M <= N, "Output exceeds input block size");
+
+    const auto& forward = Interleaver< N*8 >::table.forward;
+
+    for(size_t i = 0; i < M; i++)
+    {
+        const uint16_t *idx = &forward[offset + (8 * i)];
+        uint8_t byte = 0;
+        for(size_t j = 0; j < 8; j++)
+            byte = (byte << 1) | getBit(in, idx[j]);
+
+        out[i] = byte;
+    }
+}
+
+template < size_t N, size_t M >
+void deinterleave(const std::array< uint16_t, N >& in,
+                  std::array< uint16_t, M >& out, const size_t offset = 0)
+{
+    static_assert(M <= N, "Output exceeds input block size");
+
+    const auto& forward = Interleaver< N >::table.forward;
+
+    for(size_t i = 0; i < M; i++)
+        out[i] = in[forward[offset + i]];
+}
+
+}      // namespace sectioned
+
+static constexpr size_t NUM_FRAMES = 2000;
+static constexpr size_t REPEAT     = 100;
+
+struct testFrame
+{
+    array< uint8_t, 46 >   hard;
+    array< uint16_t, 368 > soft;
+};
+
+static volatile uint16_t sink;
+
+template < typename F >
+static double measure(F func)
+{
+    auto start = chrono::steady_clock::now();
+    for(size_t r = 0; r < REPEAT; r++)
+        func();
+    auto stop = chrono::steady_clock::now();
+
+    return (REPEAT * NUM_FRAMES) / chrono::duration< double >(stop - start).count();
+}
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< uint16_t > rndValue(0, 0xFFFF);
+
+    vector< testFrame > frames(NUM_FRAMES);
+    for(auto& f : frames)
+    {
+        for(auto& byte : f.hard)
+            byte = rndValue(rng) & 0xFF;
+
+        for(auto& bit : f.soft)
+            bit = rndValue(rng);
+    }
+
+    // Check equivalence with the previous implementation
+    size_t mismatch = 0;
+    for(auto& f : frames)
+    {
+        auto hNew = f.hard;
+        auto hOld = f.hard;
+        interleave(hNew);
+        legacy::interleave(hOld);
+        if(hNew != hOld) mismatch++;
+
+        deinterleave(hNew);
+        legacy::deinterleave(hOld);
+        if((hNew != hOld) || (hNew != f.hard)) mismatch++;
+
+        // Deinterleave straight into the LICH and Viterbi input buffers
+        array< uint8_t, 12 > lich;
+        array< uint8_t, 34 > punctured;
+        sectioned::deinterleave(f.hard, lich);
+        sectioned::deinterleave(f.hard, punctured, 96);
+        hOld = f.hard;
+        legacy::deinterleave(hOld);
+        if(!equal(lich.begin(), lich.end(), hOld.begin()) ||
+           !equal(punctured.begin(), punctured.end(), hOld.begin() + 12))
+            mismatch++;
+
+        array< uint16_t, 368 > sNew;
+        auto sOld = f.soft;
+        sectioned::deinterleave(f.soft, sNew);
+        legacy::deinterleave(sOld);
+        if(sNew != sOld) mismatch++;
+
+        array< uint16_t, 272 > softPunctured;
+        sectioned::deinterleave(f.soft, softPunctured, 96);
+        if(!equal(softPunctured.begin(), softPunctured.end(), sOld.begin() + 96))
+            mismatch++;
+    }
+
+    printf("%zu mismatches with previous interleaver over %zu frames\n",
+           mismatch, NUM_FRAMES);
+
+    // Throughput
+    double tIntOld = measure([&]
+    {
+        for(auto& f : frames)
+            legacy::interleave(f.hard);
+        sink = frames[0].hard[0];
+    });
+
+    double tIntNew = measure([&]
+    {
+        for(auto& f : frames)
+            interleave(f.hard);
+        sink = frames[0].hard[0];
+    });
+
+    double tDeintOld = measure([&]
+    {
+        for(auto& f : frames)
+        {
+            array< uint8_t, 46 > data = f.hard;
+            array< uint8_t, 34 > punctured;
+            legacy::deinterleave(data);
+            copy(data.begin() + 12, data.end(), punctured.begin());
+            sink = punctured[0];
+        }
+    });
+
+    double tDeintNew = measure([&]
+    {
+        for(auto& f : frames)
+        {
+            array< uint8_t, 34 > punctured;
+            sectioned::deinterleave(f.hard, punctured, 96);
+            sink = punctured[0];
+        }
+    });
+
+    double tSoftOld = measure([&]
+    {
+        for(auto& f : frames)
+        {
+            array< uint16_t, 368 > data = f.soft;
+            array< uint16_t, 272 > punctured;
+            legacy::deinterleave(data);
+            copy(data.begin() + 96, data.end(), punctured.begin());
+            sink = punctured[0];
+        }
+    });
+
+    double tSoftNew = measure([&]
+    {
+        for(auto& f : frames)
+        {
+            array< uint16_t, 272 > punctured;
+            sectioned::deinterleave(f.soft, punctured, 96);
+            sink = punctured[0];
+        }
+    });
+
+    printf("Interleave:         previous %.0f frames/s, table %.0f frames/s (x%.2f)\n",
+           tIntOld, tIntNew, tIntNew / tIntOld);
+    printf("Deinterleave, hard: previous %.0f frames/s, fused %.0f frames/s (x%.2f)\n",
+           tDeintOld, tDeintNew, tDeintNew / tDeintOld);
+    printf("Deinterleave, soft: previous %.0f frames/s, fused %.0f frames/s (x%.2f)\n",
+           tSoftOld, tSoftNew, tSoftNew / tSoftOld);
+
+    return (mismatch == 0) ? 0 : -1;
+}
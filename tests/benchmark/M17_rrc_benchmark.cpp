@@ -0,0 +1,132 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <M17/M17DSP.hpp>
+
+using namespace std;
+
+/**
+ * Previous implementation of the FIR filter, using a circular history buffer,
+ * kept as a reference for the benchmark.
+ */
+template < size_t N >
+class LegacyFir
+{
+public:
+
+    LegacyFir(const std::array< float, N >& taps) : taps(taps), pos(0)
+    {
+        hist.fill(0);
+    }
+
+    float operator()(const float& input)
+    {
+        hist[pos] = input;
+        pos = (pos + 1) % N;
+
+        float  result = 0.0;
+        size_t index  = pos;
+
+        for(size_t i = 0; i < N; i++)
+        {
+            index   = (index != 0 ? index - 1 : N - 1);
+            result += hist[index] * taps[i];
+        }
+
+        return result;
+    }
+
+private:
+
+    const std::array< float, N >& taps;
+    std::array< float, N >        hist;
+    size_t                        pos;
+};
+
+static constexpr size_t BLOCK_SIZE = 960;   // One M17 half-frame at 24kHz
+static constexpr size_t NUM_BLOCKS = 2000;
+
+static volatile int16_t sink;
+
+template < size_t N >
+bool benchmark(const char *name, const std::array< float, N >& taps,
+               const vector< int16_t >& input)
+{
+    LegacyFir< N > legacy(taps);
+    Fir< N >       block(taps);
+    vector< int16_t > outLegacy(input.size());
+    vector< int16_t > outBlock(input.size());
+
+    auto start = chrono::steady_clock::now();
+    for(size_t b = 0; b < NUM_BLOCKS; b++)
+    {
+        for(size_t i = 0; i < BLOCK_SIZE; i++)
+        {
+            float elem   = static_cast< float >(input[i]);
+            outLegacy[i] = static_cast< int16_t >(legacy(elem));
+        }
+        sink = outLegacy[0];
+    }
+    auto stop = chrono::steady_clock::now();
+    double tLegacy = chrono::duration< double >(stop - start).count();
+
+    start = chrono::steady_clock::now();
+    for(size_t b = 0; b < NUM_BLOCKS; b++)
+    {
+        block(input.data(), outBlock.data(), BLOCK_SIZE);
+        sink = outBlock[0];
+    }
+    stop = chrono::steady_clock::now();
+    double tBlock = chrono::duration< double >(stop - start).count();
+
+    double samples = static_cast< double >(BLOCK_SIZE * NUM_BLOCKS);
+    printf("%s: per-sample %.2f Msamples/s, block %.2f Msamples/s (x%.2f)\n",
+           name, samples / tLegacy / 1e6, samples / tBlock / 1e6,
+           tLegacy / tBlock);
+
+    // Both implementations must produce the same output
+    return outLegacy == outBlock;
+}
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< int16_t > dist(-16384, 16383);
+
+    vector< int16_t > input(BLOCK_SIZE);
+    for(auto& s : input) s = dist(rng);
+
+    bool ok = true;
+    ok &= benchmark("RRC 24kHz (41 taps)", M17::rrc_taps_24k, input);
+    ok &= benchmark("RRC 48kHz (81 taps)", M17::rrc_taps_48k, input);
+
+    if(ok == false)
+    {
+        printf("Error: output mismatch between implementations!\n");
+        return -1;
+    }
+
+    return 0;
+}
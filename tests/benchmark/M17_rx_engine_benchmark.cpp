@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <M17/M17RxEngine.hpp>
+
+using namespace std;
+using namespace M17;
+
+/**
+ * Measure the scaling of the multi-channel receive engine with the number of
+ * worker threads. All the channels demodulate the same baseband, read from
+ * memory so that file I/O does not influence the measure. The result is given
+ * as the number of real time channels each core can sustain.
+ */
+
+static constexpr size_t REPEAT = 4;     // Baseband repetitions per channel
+
+class MemorySource : public M17RxSource
+{
+public:
+
+    MemorySource(const vector< int16_t >& data) : data(data), pos(0), rep(0) { }
+
+    virtual ~MemorySource() { }
+
+    virtual size_t read(int16_t *buf, const size_t len) override
+    {
+        if(pos >= data.size())
+        {
+            if(++rep >= REPEAT) return 0;
+            pos = 0;
+        }
+
+        size_t count = min(len, data.size() - pos);
+        copy_n(data.begin() + pos, count, buf);
+        pos += count;
+
+        return count;
+    }
+
+private:
+
+    const vector< int16_t >& data;
+    size_t pos;
+    size_t rep;
+};
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2)
+    {
+        printf("Usage: %s <baseband file>\n", argv[0]);
+        return -1;
+    }
+
+    FILE *baseband_file = fopen(argv[1], "rb");
+    if(baseband_file == NULL)
+    {
+        perror("Error in reading test baseband");
+        return -1;
+    }
+
+    // Test baseband is sampled at 48kHz, decimate to the 24kHz RX sample rate
+    vector< int16_t > baseband;
+    int16_t sample[2];
+    while(fread(sample, sizeof(int16_t), 2, baseband_file) == 2)
+        baseband.push_back(sample[0]);
+
+    fclose(baseband_file);
+
+    size_t cores    = max(thread::hardware_concurrency(), 1u);
+    size_t channels = 4 * cores;
+    double baseTput = 0.0;
+
+    printf("threads | channels | frames | real time | channels/core | speedup\n");
+
+    // Powers of two up to the number of cores, plus all the cores
+    vector< size_t > numThreads;
+    for(size_t threads = 1; threads < cores; threads *= 2)
+        numThreads.push_back(threads);
+
+    numThreads.push_back(cores);
+
+    for(auto threads : numThreads)
+    {
+        M17RxEngine engine(threads);
+        for(size_t i = 0; i < channels; i++)
+            engine.addChannel(unique_ptr< M17RxSource >(new MemorySource(baseband)));
+
+        engine.run();
+
+        size_t samples = 0;
+        size_t frames  = 0;
+        for(size_t i = 0; i < channels; i++)
+        {
+            samples += engine.getStats(i).samples;
+            frames  += engine.getStats(i).frames;
+        }
+
+        // Throughput in real time channels
+        double tput = (samples / 24000.0) / engine.getElapsedTime();
+        if(threads == 1) baseTput = tput;
+
+        printf("%7zu | %8zu | %6zu | %8.1fx | %13.1f | %6.2fx\n", threads,
+               channels, frames, tput, tput / threads, tput / baseTput);
+    }
+
+    return 0;
+}
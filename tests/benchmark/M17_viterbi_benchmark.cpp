@@ -0,0 +1,275 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <bitset>
+#include <M17/M17ConvolutionalEncoder.hpp>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17Viterbi.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace std;
+using namespace M17;
+
+/**
+ * Previous implementation of the Viterbi decoders, with scalar add-compare-
+ * select and survivors stored in a bitset, kept as a reference for the
+ * benchmark. Only punctured decoding is retained.
+ */
+template < typename T, typename M, T FULL, T ERASURE >
+class LegacyViterbi
+{
+public:
+
+    template < size_t IN, size_t OUT, size_t P >
+    void decodePunctured(const std::array< T, IN >& in,
+                         std::array< uint8_t, OUT >& out,
+                         const std::array< uint8_t, P >& punctureMatrix)
+    {
+        prevMetrics.fill(0);
+        currMetrics.fill(0);
+
+        size_t histPos    = 0;
+        size_t punctIndex = 0;
+        size_t bitPos     = 0;
+
+        while(bitPos < IN)
+        {
+            T sym[2] = {ERASURE, ERASURE};
+
+            for(uint8_t i = 0; i < 2; i++)
+            {
+                if(punctureMatrix[punctIndex++])
+                    sym[i] = in[bitPos++];
+
+                if(punctIndex >= P) punctIndex = 0;
+            }
+
+            decodeBit(sym[0], sym[1], histPos);
+            histPos++;
+        }
+
+        uint8_t state  = 0;
+        size_t  outPos = OUT * 8;
+        while(outPos > 0)
+        {
+            outPos--;
+            histPos--;
+            bool bit = history[histPos].test(state >> 4);
+            state >>= 1;
+            if(bit) state |= 0x80;
+            setBit(out, outPos, bit);
+        }
+    }
+
+private:
+
+    void decodeBit(T s0, T s1, size_t pos)
+    {
+        static constexpr T COST_TABLE_0[] = {0, 0, 0, 0, FULL, FULL, FULL, FULL};
+        static constexpr T COST_TABLE_1[] = {0, FULL, FULL, 0, 0, FULL, FULL, 0};
+        static constexpr M MAX_COST       = 2 * static_cast< M >(FULL);
+
+        for(uint8_t i = 0; i < 8; i++)
+        {
+            M metric = absDiff(COST_TABLE_0[i], s0) + absDiff(COST_TABLE_1[i], s1);
+
+            M m0 = prevMetrics[i]     + metric;
+            M m1 = prevMetrics[i + 8] + (MAX_COST - metric);
+            M m2 = prevMetrics[i]     + (MAX_COST - metric);
+            M m3 = prevMetrics[i + 8] + metric;
+
+            uint8_t i0 = 2 * i;
+            uint8_t i1 = i0 + 1;
+
+            if(m0 >= m1)
+            {
+                history[pos].set(i0, true);
+                currMetrics[i0] = m1;
+            }
+            else
+            {
+                history[pos].set(i0, false);
+                currMetrics[i0] = m0;
+            }
+
+            if(m2 >= m3)
+            {
+                history[pos].set(i1, true);
+                currMetrics[i1] = m3;
+            }
+            else
+            {
+                history[pos].set(i1, false);
+                currMetrics[i1] = m2;
+            }
+        }
+
+        std::swap(currMetrics, prevMetrics);
+    }
+
+    static inline M absDiff(const T v1, const T v2)
+    {
+        return (v2 > v1) ? (v2 - v1) : (v1 - v2);
+    }
+
+    std::array< M, 16 >             prevMetrics;
+    std::array< M, 16 >             currMetrics;
+    std::array< std::bitset< 16 >, 244 > history;
+};
+
+using LegacyHardViterbi = LegacyViterbi< uint8_t,  uint16_t, 2,      1      >;
+using LegacySoftViterbi = LegacyViterbi< uint16_t, uint32_t, 0xFFFF, 0x7FFF >;
+
+static constexpr size_t NUM_FRAMES = 2000;
+static constexpr size_t REPEAT     = 10;
+
+struct testFrame
+{
+    array< uint8_t, 18 >   source;
+    array< uint8_t, 34 >   hard;        // Punctured, with bit errors
+    array< uint8_t, 272 >  hardBits;    // Same data, one bit per element
+    array< uint16_t, 272 > soft;        // Punctured, with gaussian noise
+};
+
+static volatile uint8_t sink;
+
+template < typename F >
+static double measure(F func)
+{
+    auto start = chrono::steady_clock::now();
+    for(size_t r = 0; r < REPEAT; r++)
+        func();
+    auto stop = chrono::steady_clock::now();
+
+    return (REPEAT * NUM_FRAMES) / chrono::duration< double >(stop - start).count();
+}
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+    normal_distribution< float > noise(0.0f, 0.30f);
+
+    // Stream frames with noise, as seen by the frame decoder
+    vector< testFrame > frames(NUM_FRAMES);
+    for(auto& f : frames)
+    {
+        for(auto& byte : f.source)
+            byte = rndValue(rng);
+
+        array< uint8_t, 37 > encoded;
+        M17ConvolutionalEncoder encoder;
+        encoder.reset();
+        encoder.encode(f.source.data(), encoded.data(), f.source.size());
+        encoded[36] = encoder.flush();
+
+        array< uint8_t, 34 > punctured;
+        puncture(encoded, punctured, DATA_PUNCTURE);
+
+        for(size_t i = 0; i < f.soft.size(); i++)
+        {
+            float val = (getBit(punctured, i) ? 1.0f : 0.0f) + noise(rng);
+            if(val < 0.0f) val = 0.0f;
+            if(val > 1.0f) val = 1.0f;
+
+            f.soft[i]     = static_cast< uint16_t >(val * 65535.0f);
+            f.hardBits[i] = (val >= 0.5f) ? 2 : 0;
+            setBit(f.hard, i, val >= 0.5f);
+        }
+    }
+
+    // Check equivalence with the previous implementation
+    M17HardViterbi    hard;
+    M17SoftViterbi    soft;
+    LegacyHardViterbi legacyHard;
+    LegacySoftViterbi legacySoft;
+
+    size_t hardMismatch = 0;
+    size_t softMismatch = 0;
+    size_t hardErrors   = 0;
+    size_t softErrors   = 0;
+    size_t legacyErrors = 0;
+
+    for(auto& f : frames)
+    {
+        array< uint8_t, 18 > outNew;
+        array< uint8_t, 18 > outOld;
+
+        hard.decodePunctured(f.hard, outNew, DATA_PUNCTURE);
+        legacyHard.decodePunctured(f.hardBits, outOld, DATA_PUNCTURE);
+        if(outNew != outOld) hardMismatch++;
+        if(outNew != f.source) hardErrors++;
+
+        soft.decodePunctured(f.soft, outNew, DATA_PUNCTURE);
+        legacySoft.decodePunctured(f.soft, outOld, DATA_PUNCTURE);
+        if(outNew != outOld) softMismatch++;
+        if(outNew != f.source) softErrors++;
+        if(outOld != f.source) legacyErrors++;
+    }
+
+    printf("Hard decision: %zu/%zu frames differ from previous decoder, %zu frame errors\n",
+           hardMismatch, NUM_FRAMES, hardErrors);
+    printf("Soft decision: %zu/%zu frames differ from previous decoder, "
+           "%zu frame errors (previous %zu)\n", softMismatch, NUM_FRAMES,
+           softErrors, legacyErrors);
+
+    // Throughput
+    array< uint8_t, 18 > out;
+
+    double tHardOld = measure([&]
+    {
+        for(auto& f : frames)
+            legacyHard.decodePunctured(f.hardBits, out, DATA_PUNCTURE);
+        sink = out[0];
+    });
+
+    double tHardNew = measure([&]
+    {
+        for(auto& f : frames)
+            hard.decodePunctured(f.hard, out, DATA_PUNCTURE);
+        sink = out[0];
+    });
+
+    double tSoftOld = measure([&]
+    {
+        for(auto& f : frames)
+            legacySoft.decodePunctured(f.soft, out, DATA_PUNCTURE);
+        sink = out[0];
+    });
+
+    double tSoftNew = measure([&]
+    {
+        for(auto& f : frames)
+            soft.decodePunctured(f.soft, out, DATA_PUNCTURE);
+        sink = out[0];
+    });
+
+    printf("Hard decision: legacy %.0f decodes/s, vector ACS %.0f decodes/s (x%.2f)\n",
+           tHardOld, tHardNew, tHardNew / tHardOld);
+    printf("Soft decision: legacy %.0f decodes/s, vector ACS %.0f decodes/s (x%.2f)\n",
+           tSoftOld, tSoftNew, tSoftNew / tSoftOld);
+
+    return (hardMismatch == 0) ? 0 : -1;
+}
@@ -0,0 +1,517 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+
+/**
+ * Host benchmark suite for the DSP and protocol hot paths of the firmware.
+ * Each case is calibrated to run for a minimum time per repetition, warmed up
+ * and then measured over several repetitions. Results are printed as a table
+ * and, optionally, written to a JSON file to be compared between builds.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <M17/M17ConvolutionalEncoder.hpp>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17Interleaver.hpp>
+#include <M17/M17Deframer.hpp>
+#include <M17/M17Viterbi.hpp>
+#include <M17/M17Golay.hpp>
+#include <M17/M17Utils.hpp>
+#include <M17/M17DSP.hpp>
+#include <graphics.h>
+#include <dsp_chain.hpp>
+#include <codec2.h>
+#include <dsp.h>
+
+using namespace std;
+using namespace M17;
+
+struct benchResult
+{
+    string name;
+    string unit;
+    size_t calls;       // Calls per repetition
+    double minNs;       // Time per item, in nanoseconds
+    double medianNs;
+    double meanNs;
+    double maxNs;
+    double itemsPerSec; // Throughput, from the median
+};
+
+class BenchmarkSuite
+{
+public:
+
+    BenchmarkSuite(const size_t warmup, const size_t reps, const double minTime,
+                   const char *filter) : warmup(warmup), reps(reps),
+                   minTime(minTime), filter(filter) { }
+
+    /**
+     * Run a benchmark case, if not excluded by the name filter.
+     *
+     * @param name: case name.
+     * @param unit: name of the items processed by each call.
+     * @param items: number of items processed by each call.
+     * @param func: function to be benchmarked.
+     */
+    void run(const string& name, const string& unit, const size_t items,
+             function< void() > func)
+    {
+        if((filter != nullptr) && (name.find(filter) == string::npos))
+            return;
+
+        // Calibrate the number of calls per repetition
+        size_t calls = 1;
+        while(timeCalls(func, calls) < minTime)
+            calls *= 2;
+
+        for(size_t i = 0; i < warmup; i++)
+            timeCalls(func, calls);
+
+        vector< double > samples;
+        for(size_t i = 0; i < reps; i++)
+            samples.push_back(timeCalls(func, calls) * 1e9 / (calls * items));
+
+        sort(samples.begin(), samples.end());
+
+        benchResult res;
+        res.name        = name;
+        res.unit        = unit;
+        res.calls       = calls;
+        res.minNs       = samples.front();
+        res.maxNs       = samples.back();
+        res.medianNs    = samples[samples.size() / 2];
+        res.meanNs      = 0.0;
+        for(auto s : samples) res.meanNs += s;
+        res.meanNs     /= samples.size();
+        res.itemsPerSec = 1e9 / res.medianNs;
+
+        printf("%-32s | %12.1f | %12.1f | %12.1f | %14.0f %s/s\n",
+               name.c_str(), res.minNs, res.medianNs, res.maxNs,
+               res.itemsPerSec, unit.c_str());
+        fflush(stdout);
+
+        results.push_back(res);
+    }
+
+    /**
+     * Write the results in JSON format.
+     *
+     * @param path: output file path.
+     * @return true on success.
+     */
+    bool writeJson(const char *path)
+    {
+        FILE *out = fopen(path, "w");
+        if(out == NULL)
+            return false;
+
+        fprintf(out, "{\n");
+        fprintf(out, "  \"version\": \"%s\",\n", GIT_VERSION);
+        fprintf(out, "  \"warmup\": %zu,\n", warmup);
+        fprintf(out, "  \"repetitions\": %zu,\n", reps);
+        fprintf(out, "  \"benchmarks\": [\n");
+
+        for(size_t i = 0; i < results.size(); i++)
+        {
+            auto& r = results[i];
+            fprintf(out, "    {\"name\": \"%s\", \"unit\": \"%s\", \"calls\": %zu, "
+                         "\"min_ns\": %.3f, \"median_ns\": %.3f, \"mean_ns\": %.3f, "
+                         "\"max_ns\": %.3f, \"items_per_s\": %.1f}%s\n",
+                    r.name.c_str(), r.unit.c_str(), r.calls, r.minNs, r.medianNs,
+                    r.meanNs, r.maxNs, r.itemsPerSec,
+                    (i + 1 < results.size()) ? "," : "");
+        }
+
+        fprintf(out, "  ]\n}\n");
+        fclose(out);
+
+        return true;
+    }
+
+private:
+
+    static double timeCalls(function< void() >& func, const size_t calls)
+    {
+        auto start = chrono::steady_clock::now();
+        for(size_t i = 0; i < calls; i++)
+            func();
+        auto stop = chrono::steady_clock::now();
+
+        return chrono::duration< double >(stop - start).count();
+    }
+
+    size_t               warmup;    // Warmup repetitions
+    size_t               reps;      // Measured repetitions
+    double               minTime;   // Minimum duration of a repetition, in s
+    const char          *filter;    // Name filter
+    vector< benchResult > results;
+};
+
+static volatile uint32_t sink;
+
+static constexpr size_t BLOCK_SIZE = 480;   // Half M17 frame at 24kHz
+static constexpr size_t NUM_FRAMES = 64;
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n", name);
+    printf("Options:\n");
+    printf("  -w <n>      warmup repetitions (default: 3)\n");
+    printf("  -r <n>      measured repetitions (default: 10)\n");
+    printf("  -t <ms>     minimum duration of a repetition (default: 10)\n");
+    printf("  -f <name>   run only the cases whose name contains <name>\n");
+    printf("  -o <file>   write the results in JSON format to <file>\n");
+}
+
+int main(int argc, char *argv[])
+{
+    size_t      warmup  = 3;
+    size_t      reps    = 10;
+    double      minTime = 0.010;
+    const char *filter  = nullptr;
+    const char *outFile = nullptr;
+    int         opt;
+
+    while((opt = getopt(argc, argv, "w:r:t:f:o:h")) != -1)
+    {
+        switch(opt)
+        {
+            case 'w': warmup  = atoi(optarg);          break;
+            case 'r': reps    = max(atoi(optarg), 1);  break;
+            case 't': minTime = atof(optarg) / 1000.0; break;
+            case 'f': filter  = optarg;                break;
+            case 'o': outFile = optarg;                break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : -1;
+        }
+    }
+
+    default_random_engine rng;
+    uniform_int_distribution< uint16_t > rndByte(0, 255);
+    normal_distribution< float > noise(0.0f, 0.15f);
+
+    // Test data: random baseband and encoded stream frames
+    vector< int16_t > baseband(2 * BLOCK_SIZE);
+    for(auto& s : baseband)
+        s = static_cast< int16_t >(noise(rng) * 10000.0f);
+
+    M17LinkSetupFrame lsf;
+    lsf.clear();
+    lsf.setSource("N0CALL");
+    lsf.setDestination("ALL");
+    streamType_t type;
+    type.value           = 0;
+    type.fields.stream   = 1;   // Stream mode
+    type.fields.dataType = 2;   // Voice data
+    lsf.setType(type);
+    lsf.updateCrc();
+
+    M17FrameEncoder encoder;
+    encoder.reset();
+    frame_t lsfFrame;
+    encoder.encodeLsf(lsf, lsfFrame);
+
+    vector< frame_t >      frames(NUM_FRAMES);
+    vector< soft_frame_t > softFrames(NUM_FRAMES);
+    vector< payload_t >    payloads(NUM_FRAMES);
+    for(size_t i = 0; i < NUM_FRAMES; i++)
+    {
+        for(auto& b : payloads[i])
+            b = rndByte(rng);
+
+        encoder.encodeStreamFrame(payloads[i], frames[i]);
+
+        for(size_t j = 0; j < softFrames[i].size(); j++)
+        {
+            float val = (getBit(frames[i], j + 16) ? 1.0f : 0.0f) + noise(rng);
+            val = min(max(val, 0.0f), 1.0f);
+            softFrames[i][j] = static_cast< uint16_t >(val * 65535.0f);
+        }
+    }
+
+    BenchmarkSuite suite(warmup, reps, minTime, filter);
+
+    printf("%-32s | %12s | %12s | %12s | throughput\n", "benchmark",
+           "min [ns]", "median [ns]", "max [ns]");
+
+    // RRC filters, per sample
+    {
+        vector< float > in(baseband.begin(), baseband.end());
+        vector< float > out(in.size());
+        Fir< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc24(rrc_taps_24k);
+        Fir< std::tuple_size< decltype(rrc_taps_48k) >::value > rrc48(rrc_taps_48k);
+        FirQ15< std::tuple_size< decltype(rrc_taps_24k_q15) >::value > rrcQ15(rrc_taps_24k_q15);
+        vector< int16_t > outQ15(baseband.size());
+
+        suite.run("rrc_24k_float", "sample", in.size(), [&]
+        {
+            rrc24(in.data(), out.data(), in.size(), 1.0f);
+            sink = out[0];
+        });
+
+        suite.run("rrc_48k_float", "sample", in.size(), [&]
+        {
+            rrc48(in.data(), out.data(), in.size(), 1.0f);
+            sink = out[0];
+        });
+
+        suite.run("rrc_24k_q15", "sample", baseband.size(), [&]
+        {
+            rrcQ15(baseband.data(), outQ15.data(), baseband.size(), false);
+            sink = outQ15[0];
+        });
+    }
+
+    // Demodulator syncword search, on noise so that it never locks
+    {
+        M17Demodulator demod;
+        demod.init();
+
+        suite.run("syncword_search", "sample", BLOCK_SIZE, [&]
+        {
+            dataBlock_t block = { baseband.data(), BLOCK_SIZE };
+            sink = demod.update(block);
+        });
+
+        demod.terminate();
+    }
+
+    // Viterbi decoders, per stream frame payload
+    {
+        M17HardViterbi hard;
+        M17SoftViterbi soft;
+        array< uint8_t, 18 > out;
+        array< uint8_t, 34 > punctured;
+        array< uint8_t,  STREAM_SYMBOLS > hardSym;
+        array< uint16_t, STREAM_SYMBOLS > softSym;
+        copy_n(frames[0].begin() + 14, punctured.size(), punctured.begin());
+        Deframer::stream(frames[0], hardSym);
+        Deframer::stream(softFrames[0], softSym);
+
+        suite.run("viterbi_hard_punctured", "frame", 1, [&]
+        {
+            sink = hard.decodePunctured(punctured, out, DATA_PUNCTURE);
+        });
+
+        suite.run("viterbi_hard_depunctured", "frame", 1, [&]
+        {
+            sink = hard.decodeDepunctured(hardSym, out);
+        });
+
+        suite.run("viterbi_soft_depunctured", "frame", 1, [&]
+        {
+            sink = soft.decodeDepunctured(softSym, out);
+        });
+    }
+
+    // Golay decoding, with random single bit errors
+    {
+        vector< uint32_t > codewords(256);
+        for(size_t i = 0; i < codewords.size(); i++)
+            codewords[i] = golay24_encode(i * 16 + 7) ^ (1 << (i % 24));
+
+        suite.run("golay24_decode", "codeword", codewords.size(), [&]
+        {
+            uint32_t acc = 0;
+            for(auto cw : codewords)
+                acc += golay24_decode(cw);
+            sink = acc;
+        });
+    }
+
+    // Interleaving, per stream frame
+    {
+        array< uint8_t, 46 >  data;
+        array< uint8_t, 46 >  out;
+        copy_n(frames[0].begin() + 2, data.size(), data.begin());
+
+        suite.run("interleave", "frame", 1, [&]
+        {
+            interleave(data);
+            sink = data[0];
+        });
+
+        suite.run("deinterleave", "frame", 1, [&]
+        {
+            out = data;
+            deinterleave(out);
+            sink = out[0];
+        });
+    }
+
+    // Frame encoding and decoding
+    {
+        frame_t out;
+        size_t  idx = 0;
+
+        suite.run("frame_encode_lsf", "frame", 1, [&]
+        {
+            encoder.encodeLsf(lsf, out);
+            sink = out[2];
+        });
+
+        suite.run("frame_encode_stream", "frame", 1, [&]
+        {
+            sink = encoder.encodeStreamFrame(payloads[idx], out);
+            idx  = (idx + 1) % NUM_FRAMES;
+        });
+
+        M17FrameDecoder decoder;
+        decoder.reset();
+        decoder.decodeFrame(lsfFrame);
+
+        suite.run("frame_decode_stream_hard", "frame", 1, [&]
+        {
+            sink = static_cast< uint32_t >(decoder.decodeFrame(frames[idx]));
+            idx  = (idx + 1) % NUM_FRAMES;
+        });
+
+        suite.run("frame_decode_stream_soft", "frame", 1, [&]
+        {
+            sink = static_cast< uint32_t >(decoder.decodeFrame(frames[idx],
+                                                               softFrames[idx]));
+            idx  = (idx + 1) % NUM_FRAMES;
+        });
+    }
+
+    // Codec2 at 3200bps, 20ms frames of 160 samples
+    {
+        struct CODEC2 *codec2 = codec2_create(CODEC2_MODE_3200);
+        vector< int16_t > speech(baseband.begin(), baseband.begin() + 160);
+        uint8_t encoded[8];
+
+        suite.run("codec2_3200_encode", "frame", 1, [&]
+        {
+            codec2_encode(codec2, encoded, speech.data());
+            sink = encoded[0];
+        });
+
+        suite.run("codec2_3200_decode", "frame", 1, [&]
+        {
+            codec2_decode(codec2, speech.data(), encoded);
+            sink = speech[0];
+        });
+
+        codec2_destroy(codec2);
+    }
+
+    // Audio DC removal filters, per sample
+    {
+        vector< audio_sample_t > audio(baseband.begin(), baseband.begin() + BLOCK_SIZE);
+        filter_state_t       state;
+        fixed_filter_state_t fixedState;
+        dsp_resetFilterState(&state);
+        dsp_resetFixedFilterState(&fixedState);
+
+        suite.run("dsp_dcRemoval", "sample", audio.size(), [&]
+        {
+            dsp_dcRemoval(&state, audio.data(), audio.size());
+            sink = audio[0];
+        });
+
+        suite.run("dsp_dcRemovalFixed", "sample", audio.size(), [&]
+        {
+            dsp_dcRemovalFixed(&fixedState, audio.data(), audio.size());
+            sink = audio[0];
+        });
+
+        // Microphone conditioning of the codec2 encoder, as separate passes
+        // and as a fused DSP chain
+        suite.run("mic_conditioning_passes", "sample", audio.size(), [&]
+        {
+            for(auto& smp : audio) smp *= 8;
+            dsp_dcRemoval(&state, audio.data(), audio.size());
+            for(auto& smp : audio) smp *= 4;
+            sink = audio[0];
+        });
+
+        DspChain< DspGain, DspDcRemoval, DspGain > micChain{DspGain(8),
+                                                            DspDcRemoval(),
+                                                            DspGain(4)};
+        suite.run("mic_conditioning_chain", "sample", audio.size(), [&]
+        {
+            micChain.process(audio.data(), audio.data(), audio.size());
+            sink = audio[0];
+        });
+    }
+
+    // Graphics primitives, on the display framebuffer
+    {
+        gfx_init();
+
+        color_t white = {255, 255, 255, 255};
+        color_t black = {0,   0,   0,   255};
+        point_t start = {0, 0};
+        point_t end   = {SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1};
+        point_t text  = {0, SCREEN_HEIGHT / 2};
+
+        suite.run("gfx_fillScreen", "call", 1, [&]
+        {
+            gfx_fillScreen(black);
+        });
+
+        suite.run("gfx_drawLine", "call", 1, [&]
+        {
+            gfx_drawLine(start, end, white);
+        });
+
+        suite.run("gfx_drawRect_filled", "call", 1, [&]
+        {
+            gfx_drawRect(start, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2,
+                         white, true);
+        });
+
+        suite.run("gfx_drawCircle", "call", 1, [&]
+        {
+            gfx_drawCircle(text, SCREEN_HEIGHT / 4, white);
+        });
+
+        suite.run("gfx_print", "call", 1, [&]
+        {
+            gfx_print(text, FONT_SIZE_8PT, TEXT_ALIGN_CENTER, white, "%s",
+                      "M17 N0CALL");
+        });
+
+        gfx_terminate();
+    }
+
+    if((outFile != nullptr) && (suite.writeJson(outFile) == false))
+    {
+        perror(outFile);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <crc.h>
+
+using namespace std;
+
+/**
+ * Previous implementations of the CCITT and M17 CRCs, kept as a reference
+ * for the benchmark.
+ */
+static uint16_t legacyCcitt(const void *data, const size_t len)
+{
+    uint16_t x   = 0;
+    uint16_t crc = 0;
+    const uint8_t *buf = ((const uint8_t *) data);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        x   = (crc >> 8) ^ buf[i];
+        x  ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+static uint16_t legacyM17(const void *data, const size_t len)
+{
+    const uint8_t *ptr = reinterpret_cast< const uint8_t *>(data);
+    uint16_t crc = 0xFFFF;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= (ptr[i] << 8);
+
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            if(crc & 0x8000)
+                crc = (crc << 1) ^ 0x5935;
+            else
+                crc = (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static constexpr size_t XMODEM_BLOCK = 1024;   // xmodem 1K block
+static constexpr size_t LSF_SIZE     = 28;     // LSF bytes covered by CRC
+static constexpr size_t NUM_BLOCKS   = 256;
+static constexpr size_t REPEAT       = 100;
+
+static volatile uint16_t sink;
+
+/**
+ * Measure the throughput of a CRC function over blocks of a given size.
+ *
+ * @return throughput in MB/s.
+ */
+template < typename F >
+static double measure(F crc, const vector< uint8_t >& data, const size_t blockSize)
+{
+    size_t numBlocks = data.size() / blockSize;
+
+    auto start = chrono::steady_clock::now();
+    for(size_t r = 0; r < REPEAT; r++)
+    {
+        for(size_t i = 0; i < numBlocks; i++)
+            sink = crc(data.data() + (i * blockSize), blockSize);
+    }
+    auto stop = chrono::steady_clock::now();
+
+    double bytes = REPEAT * numBlocks * blockSize;
+    return bytes / chrono::duration< double >(stop - start).count() / 1e6;
+}
+
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+
+    vector< uint8_t > data(NUM_BLOCKS * XMODEM_BLOCK);
+    for(auto& byte : data)
+        byte = rndValue(rng);
+
+    double ccittOld = measure(legacyCcitt, data, XMODEM_BLOCK);
+    double ccittNew = measure(crc_ccitt,   data, XMODEM_BLOCK);
+    double m17Old   = measure(legacyM17,   data, LSF_SIZE);
+    double m17New   = measure(crc_m17,     data, LSF_SIZE);
+
+    printf("CCITT, 1kB blocks: previous %.1f MB/s, sliced %.1f MB/s (x%.2f)\n",
+           ccittOld, ccittNew, ccittNew / ccittOld);
+    printf("M17, LSF:          previous %.1f MB/s, sliced %.1f MB/s (x%.2f)\n",
+           m17Old, m17New, m17New / m17Old);
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <ringbuf.hpp>
+
+using namespace std;
+
+/**
+ * Compare the mutex based RingBuffer with the lock-free SPSCRingBuffer. The
+ * single thread test measures the cost of the push/pop handshake alone, as
+ * seen on a single core MCU where producer and consumer never really run in
+ * parallel; the two threads test transfers the same data between a producer
+ * and a consumer with blocking calls.
+ */
+
+static constexpr size_t QUEUE_SIZE   = 64;
+static constexpr size_t NUM_ELEMENTS = 4000000;
+static constexpr size_t BATCH        = 16;
+
+static volatile uint32_t sink;
+
+template < typename F >
+static double measure(F func)
+{
+    auto start = chrono::steady_clock::now();
+    func();
+    auto stop = chrono::steady_clock::now();
+
+    return NUM_ELEMENTS / chrono::duration< double >(stop - start).count();
+}
+
+template < typename Q >
+static double singleThread(Q& queue)
+{
+    return measure([&]
+    {
+        uint32_t acc = 0;
+        uint32_t elem = 0;
+        for(size_t i = 0; i < NUM_ELEMENTS; i++)
+        {
+            queue.push(i, false);
+            queue.pop(elem, false);
+            acc += elem;
+        }
+
+        sink = acc;
+    });
+}
+
+static double singleThreadBatch(SPSCRingBuffer< uint32_t, QUEUE_SIZE >& queue)
+{
+    return measure([&]
+    {
+        uint32_t acc = 0;
+        uint32_t batch[BATCH];
+        for(size_t i = 0; i < NUM_ELEMENTS; i += BATCH)
+        {
+            for(size_t j = 0; j < BATCH; j++)
+                batch[j] = i + j;
+
+            queue.pushN(batch, BATCH, false);
+            queue.popN(batch, BATCH, false);
+            acc += batch[0];
+        }
+
+        sink = acc;
+    });
+}
+
+template < typename Q >
+static double twoThreads(Q& queue)
+{
+    return measure([&]
+    {
+        thread producer([&]
+        {
+            for(size_t i = 0; i < NUM_ELEMENTS; i++)
+                queue.push(i, true);
+        });
+
+        uint32_t acc = 0;
+        uint32_t elem = 0;
+        for(size_t i = 0; i < NUM_ELEMENTS; i++)
+        {
+            queue.pop(elem, true);
+            acc += elem;
+        }
+
+        producer.join();
+        sink = acc;
+    });
+}
+
+static double twoThreadsBatch(SPSCRingBuffer< uint32_t, QUEUE_SIZE >& queue)
+{
+    return measure([&]
+    {
+        thread producer([&]
+        {
+            uint32_t batch[BATCH];
+            for(size_t i = 0; i < NUM_ELEMENTS; i += BATCH)
+            {
+                for(size_t j = 0; j < BATCH; j++)
+                    batch[j] = i + j;
+
+                queue.pushN(batch, BATCH, true);
+            }
+        });
+
+        uint32_t acc = 0;
+        uint32_t batch[BATCH];
+        size_t   count = 0;
+        while(count < NUM_ELEMENTS)
+        {
+            size_t num = queue.popN(batch, BATCH, true);
+            for(size_t j = 0; j < num; j++)
+                acc += batch[j];
+
+            count += num;
+        }
+
+        producer.join();
+        sink = acc;
+    });
+}
+
+int main()
+{
+    static RingBuffer< uint32_t, QUEUE_SIZE >     locked;
+    static SPSCRingBuffer< uint32_t, QUEUE_SIZE > lockFree;
+
+    double lockedSingle = singleThread(locked);
+    double spscSingle   = singleThread(lockFree);
+    double spscSingleB  = singleThreadBatch(lockFree);
+    double lockedTwo    = twoThreads(locked);
+    double spscTwo      = twoThreads(lockFree);
+    double spscBatch    = twoThreadsBatch(lockFree);
+
+    printf("Single thread push/pop: mutex %.0f elem/s, lock-free %.0f elem/s (x%.2f)\n",
+           lockedSingle, spscSingle, spscSingle / lockedSingle);
+    printf("Single thread, batches of %zu: lock-free %.0f elem/s (x%.2f)\n", BATCH,
+           spscSingleB, spscSingleB / lockedSingle);
+    printf("Two threads, blocking:  mutex %.0f elem/s, lock-free %.0f elem/s (x%.2f)\n",
+           lockedTwo, spscTwo, spscTwo / lockedTwo);
+    printf("Two threads, batches of %zu: lock-free %.0f elem/s (x%.2f)\n", BATCH,
+           spscBatch, spscBatch / lockedTwo);
+
+    return 0;
+}
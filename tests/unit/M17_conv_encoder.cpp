@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <array>
+#include <M17/M17ConvolutionalEncoder.hpp>
+#include <M17/M17CodePuncturing.hpp>
+#include <M17/M17Viterbi.hpp>
+#include <M17/M17Utils.hpp>
+
+using namespace std;
+using namespace M17;
+
+default_random_engine rng;
+
+/**
+ * Reference convolutional encoder, bit by bit, the first coded bit is the MSB
+ * of the result.
+ */
+uint16_t refConvolveByte(uint8_t& memory, uint8_t value)
+{
+    uint16_t result = 0;
+
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        memory  = (memory << 1) | ((value & 0x80) >> 7);
+        memory &= 0x1F;
+        result  = (result << 1) | (__builtin_popcount(memory & 0x19) & 0x01);
+        result  = (result << 1) | (__builtin_popcount(memory & 0x17) & 0x01);
+        value <<= 1;
+    }
+
+    return result;
+}
+
+/**
+ * Check the encoder output against the reference one, for all the input byte
+ * values and encoder memory states.
+ */
+bool checkEncoder()
+{
+    for(uint16_t prev = 0; prev < 256; prev++)
+    {
+        for(uint16_t value = 0; value < 256; value++)
+        {
+            uint8_t memory = 0;
+            refConvolveByte(memory, prev);
+            uint16_t expected = refConvolveByte(memory, value);
+
+            uint8_t  data[2] = { static_cast< uint8_t >(prev),
+                                 static_cast< uint8_t >(value) };
+            uint16_t coded[2];
+            M17ConvolutionalEncoder encoder;
+            encoder.reset();
+            encoder.encode(data, coded, 2);
+
+            if(__builtin_bswap16(coded[1]) != expected)
+            {
+                printf("Encoding mismatch for %02x after %02x\n", value, prev);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Encode and puncture random data with the fused encoder, check the result
+ * against separate encoding and puncturing and decode it back.
+ */
+template < size_t IN, size_t OUT, size_t P >
+bool checkRoundTrip(const array< uint8_t, P >& punctureMatrix, const size_t offset)
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+
+    array< uint8_t, IN > source;
+    for(auto& byte : source)
+        byte = rndValue(rng);
+
+    M17ConvolutionalEncoder encoder;
+
+    // Separate encoding and puncturing
+    array< uint8_t, 2*IN + 1 > encoded;
+    array< uint8_t, OUT > expected;
+    encoder.reset();
+    encoder.encode(source.data(), encoded.data(), IN);
+    encoded[2*IN] = encoder.flush();
+    size_t expectedBits = puncture(encoded, expected, punctureMatrix);
+
+    // Fused encoding and puncturing, placed after a header of offset bits
+    array< uint8_t, OUT + 12 > fused;
+    fused.fill(0xA5);
+    encoder.reset();
+    size_t bits = encoder.encodePunctured(source.data(), IN, fused,
+                                          punctureMatrix, offset);
+
+    array< uint8_t, OUT > punctured;
+    copy_n(fused.begin() + offset/8, OUT, punctured.begin());
+
+    if((bits != expectedBits) || (punctured != expected) ||
+       ((offset > 0) && (fused[0] != 0xA5)))
+    {
+        printf("Fused puncturing mismatch\n");
+        return false;
+    }
+
+    array< uint8_t, IN > result;
+    M17HardViterbi decoder;
+    uint16_t errors = decoder.decodePunctured(punctured, result, punctureMatrix);
+
+    if((result != source) || (errors != 0))
+    {
+        printf("Round trip failed, %d errors\n", errors);
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if(checkEncoder() == false)
+        return -1;
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+        // Link setup frames
+        if(checkRoundTrip< 30, 46 >(LSF_PUNCTURE, 0) == false)
+            return -1;
+
+        // Stream frames, placed after the LICH
+        if(checkRoundTrip< 18, 34 >(DATA_PUNCTURE, 96) == false)
+            return -1;
+    }
+
+    return 0;
+}
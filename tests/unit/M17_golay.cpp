@@ -21,13 +21,85 @@
 
 #include <cstdio>
 #include <cstdint>
+#include <chrono>
 #include <random>
-#include "M17/M17Golay.h"
+#include <vector>
+#include <M17/M17Golay.hpp>
 
 using namespace std;
+using namespace M17;
 
 default_random_engine rng;
 
+/*
+ * Reference implementation of the Golay(24,12) codec, computing the checksum
+ * and the error pattern at each call, used to check the codec under test.
+ */
+static constexpr uint16_t encode_matrix[12] =
+{
+    0x8eb, 0x93e, 0xa97, 0xdc6, 0x367, 0x6cd,
+    0xd99, 0x3da, 0x7b4, 0xf68, 0x63b, 0xc75
+};
+
+static constexpr uint16_t decode_matrix[12] =
+{
+    0xc75, 0x49f, 0x93e, 0x6e3, 0xdc6, 0xf13,
+    0xab9, 0x1ed, 0x3da, 0x7b4, 0xf68, 0xa4f
+};
+
+static uint16_t refChecksum(const uint16_t value)
+{
+    uint16_t checksum = 0;
+
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(value & (1 << i))
+            checksum ^= encode_matrix[i];
+    }
+
+    return checksum;
+}
+
+static uint32_t refErrors(const uint32_t codeword)
+{
+    uint16_t syndrome = (codeword & 0xFFF) ^ refChecksum(codeword >> 12);
+
+    if(__builtin_popcount(syndrome) <= 3)
+        return syndrome;
+
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(__builtin_popcount(syndrome ^ encode_matrix[i]) <= 2)
+            return (1 << (i + 12)) | (syndrome ^ encode_matrix[i]);
+    }
+
+    uint16_t inv_syndrome = 0;
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(syndrome & (1 << i))
+            inv_syndrome ^= decode_matrix[i];
+    }
+
+    if(__builtin_popcount(inv_syndrome) <= 3)
+        return inv_syndrome << 12;
+
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(__builtin_popcount(inv_syndrome ^ decode_matrix[i]) <= 2)
+            return ((inv_syndrome ^ decode_matrix[i]) << 12) | (1 << i);
+    }
+
+    return 0xFFFFFFFF;
+}
+
+static uint16_t refDecode(const uint32_t codeword)
+{
+    uint32_t errors = refErrors(codeword);
+    if(errors == 0xFFFFFFFF) return 0xFFFF;
+
+    return ((codeword ^ errors) >> 12) & 0x0FFF;
+}
+
 /**
  * Generate a mask with a random number of bit errors in random positions.
  */
@@ -45,6 +117,99 @@ uint32_t generateErrorMask()
     return errorMask;
 }
 
+/**
+ * Exhaustive equivalence with the reference implementation: encoding of all
+ * the 12-bit values and decoding of all the 2^24 possible received words.
+ */
+bool checkEquivalence()
+{
+    for(uint32_t value = 0; value < 4096; value++)
+    {
+        uint32_t cword = golay24_encode(value);
+        if(cword != ((value << 12) | refChecksum(value)))
+        {
+            printf("Encoding mismatch for value %03x\n", value);
+            return false;
+        }
+    }
+
+    for(uint32_t cword = 0; cword < (1 << 24); cword++)
+    {
+        if(golay24_decode(cword) != refDecode(cword))
+        {
+            printf("Decoding mismatch for codeword %06x\n", cword);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Exhaustive check of error correction: for all the 12-bit values, every
+ * pattern of up to three bit errors must be corrected.
+ */
+bool checkCorrection()
+{
+    vector< uint32_t > masks = { 0 };
+
+    for(uint8_t i = 0; i < 24; i++)
+    {
+        masks.push_back(1 << i);
+        for(uint8_t j = i + 1; j < 24; j++)
+        {
+            masks.push_back((1 << i) | (1 << j));
+            for(uint8_t k = j + 1; k < 24; k++)
+                masks.push_back((1 << i) | (1 << j) | (1 << k));
+        }
+    }
+
+    for(uint32_t value = 0; value < 4096; value++)
+    {
+        uint32_t cword = golay24_encode(value);
+        for(auto mask : masks)
+        {
+            if(golay24_decode(cword ^ mask) != value)
+            {
+                printf("Value %03x, emask %06x not corrected\n", value, mask);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Decoding throughput with random errors, compared to the reference
+ * implementation.
+ */
+void measureThroughput()
+{
+    static constexpr size_t NUM_WORDS = 1 << 20;
+
+    uniform_int_distribution< uint16_t > rndValue(0, 4095);
+    vector< uint32_t > words(NUM_WORDS);
+    for(auto& w : words)
+        w = golay24_encode(rndValue(rng)) ^ generateErrorMask();
+
+    volatile uint16_t sink = 0;
+
+    auto start = chrono::steady_clock::now();
+    for(auto w : words)
+        sink = sink + golay24_decode(w);
+    auto mid   = chrono::steady_clock::now();
+    for(auto w : words)
+        sink = sink + refDecode(w);
+    auto end   = chrono::steady_clock::now();
+
+    double tDec = NUM_WORDS / chrono::duration< double >(mid - start).count();
+    double tRef = NUM_WORDS / chrono::duration< double >(end - mid).count();
+
+    printf("Decoding: %.1f Mwords/s, reference %.1f Mwords/s (x%.2f)\n",
+           tDec / 1e6, tRef / 1e6, tDec / tRef);
+}
+
 int main()
 {
     uniform_int_distribution< uint16_t > rndValue(0, 2047);
@@ -73,16 +238,25 @@ int main()
 
         int input_error_count = __builtin_popcount(emask);
 
-        printf("Value %04x, emask %08x errs %d -> d %s, c %s\n",
-               value,
-               emask,
-               input_error_count,
-               decoding_ok   ? "OK" : "FAIL",
-               correcting_ok ? "OK" : "FAIL");
-
         if(input_error_count <= 4 && (!decoding_ok || !correcting_ok))
+        {
+            printf("Value %04x, emask %08x errs %d -> d %s, c %s\n",
+                   value,
+                   emask,
+                   input_error_count,
+                   decoding_ok   ? "OK" : "FAIL",
+                   correcting_ok ? "OK" : "FAIL");
             return -1;
+        }
     }
 
+    if(checkEquivalence() == false)
+        return -1;
+
+    if(checkCorrection() == false)
+        return -1;
+
+    measureThroughput();
+
     return 0;
 }
@@ -0,0 +1,80 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <M17/M17DSP.hpp>
+
+using namespace std;
+
+static constexpr size_t SAMPLES_PER_SYMBOL = 10;
+static constexpr size_t NUM_SYMBOLS        = 192 * 50;
+static constexpr float  RRC_GAIN           = 23000.0f;
+
+/**
+ * Check that the polyphase RRC interpolator generates the same baseband of a
+ * zero-stuffed symbol stream filtered by a standard FIR.
+ */
+int main()
+{
+    default_random_engine rng;
+    uniform_int_distribution< int > symDist(0, 3);
+    static constexpr int8_t symbols[] = { -3, -1, +1, +3 };
+
+    Fir< std::tuple_size< decltype(M17::rrc_taps_48k) >::value >
+        reference(M17::rrc_taps_48k);
+    FirInterpolator< std::tuple_size< decltype(M17::rrc_taps_48k) >::value,
+                     SAMPLES_PER_SYMBOL > interpolator(M17::rrc_taps_48k);
+
+    uint32_t mismatches = 0;
+    float    maxError   = 0.0f;
+
+    for(size_t i = 0; i < NUM_SYMBOLS; i++)
+    {
+        float sym = static_cast< float >(symbols[symDist(rng)]);
+
+        float interp[SAMPLES_PER_SYMBOL];
+        interpolator(sym * RRC_GAIN, interp);
+
+        for(size_t j = 0; j < SAMPLES_PER_SYMBOL; j++)
+        {
+            float in  = (j == 0) ? sym : 0.0f;
+            float ref = reference(in * RRC_GAIN);
+
+            float err = (ref > interp[j]) ? (ref - interp[j]) : (interp[j] - ref);
+            if(err > maxError) maxError = err;
+
+            if(static_cast< int16_t >(ref) != static_cast< int16_t >(interp[j]))
+                mismatches++;
+        }
+    }
+
+    printf("Max error %f, %u mismatching samples out of %zu\n", maxError,
+           mismatches, NUM_SYMBOLS * SAMPLES_PER_SYMBOL);
+
+    if(mismatches != 0)
+    {
+        printf("Error: interpolator output differs from reference!\n");
+        return -1;
+    }
+
+    return 0;
+}
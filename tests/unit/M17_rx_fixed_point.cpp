@@ -0,0 +1,167 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17FrameDecoder.hpp>
+
+using namespace std;
+
+/**
+ * Decode an M17 baseband file and print one line for each valid LSF or stream
+ * frame decoded.
+ *
+ * This source is built twice, once with the floating point receive pipeline
+ * and once with the fixed point one (M17_RX_FIXED_POINT defined). When the
+ * path of the other build is given as second argument, the output of the two
+ * pipelines is compared.
+ */
+
+static constexpr size_t BLOCK_SIZE = 480;    // Half of an M17 frame at 24kHz
+
+static vector< string > decodeBaseband(const char *path)
+{
+    vector< string > frames;
+
+    FILE *baseband_file = fopen(path, "rb");
+    if(baseband_file == NULL)
+    {
+        perror("Error in reading test baseband");
+        return frames;
+    }
+
+    // Test baseband is sampled at 48kHz, decimate to the 24kHz RX sample rate
+    vector< int16_t > baseband;
+    int16_t sample[2];
+    while(fread(sample, sizeof(int16_t), 2, baseband_file) == 2)
+        baseband.push_back(sample[0]);
+
+    fclose(baseband_file);
+
+    M17::M17Demodulator   demodulator;
+    M17::M17FrameDecoder  decoder;
+    demodulator.init();
+
+    for(size_t pos = 0; pos + BLOCK_SIZE <= baseband.size(); pos += BLOCK_SIZE)
+    {
+        dataBlock_t block = { &baseband[pos], BLOCK_SIZE };
+        if(demodulator.update(block) == false)
+            continue;
+
+        auto type = decoder.decodeFrame(demodulator.getFrame());
+        char line[128];
+
+        if(type == M17::M17FrameType::LINK_SETUP)
+        {
+            M17::M17LinkSetupFrame lsf = decoder.getLsf();
+            if(lsf.valid() == false) continue;
+
+            snprintf(line, sizeof(line), "LSF %s -> %s",
+                     lsf.getSource().c_str(), lsf.getDestination().c_str());
+        }
+        else if(type == M17::M17FrameType::STREAM)
+        {
+            M17::M17StreamFrame sf = decoder.getStreamFrame();
+            int len = snprintf(line, sizeof(line), "STREAM %04x",
+                               sf.getFrameNumber());
+            for(auto byte : sf.payload())
+                len += snprintf(line + len, sizeof(line) - len, " %02x", byte);
+        }
+        else
+        {
+            continue;
+        }
+
+        frames.push_back(line);
+    }
+
+    demodulator.terminate();
+
+    return frames;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2)
+    {
+        printf("Usage: %s <baseband file> [reference decoder]\n", argv[0]);
+        return -1;
+    }
+
+    vector< string > frames = decodeBaseband(argv[1]);
+
+    // No reference: just print the decoded frames
+    if(argc < 3)
+    {
+        for(auto& f : frames)
+            printf("%s\n", f.c_str());
+
+        return frames.empty() ? -1 : 0;
+    }
+
+    string cmd = string(argv[2]) + " " + argv[1];
+    FILE *ref = popen(cmd.c_str(), "r");
+    if(ref == NULL)
+    {
+        perror("Error in running reference decoder");
+        return -1;
+    }
+
+    // The reference decoder is linked with the whole firmware, which may log on
+    // stdout too: keep only the lines of the decoded frames.
+    vector< string > refFrames;
+    char line[128];
+    while(fgets(line, sizeof(line), ref) != NULL)
+    {
+        line[strcspn(line, "\n")] = '\0';
+        if((strncmp(line, "LSF ", 4) == 0) || (strncmp(line, "STREAM ", 7) == 0))
+            refFrames.push_back(line);
+    }
+
+    pclose(ref);
+
+    size_t matching = 0;
+    size_t len      = (frames.size() < refFrames.size()) ? frames.size()
+                                                          : refFrames.size();
+    for(size_t i = 0; i < len; i++)
+    {
+        if(frames[i] == refFrames[i])
+            matching++;
+        else
+            printf("Mismatch at frame %zu:\n  %s\n  %s\n", i,
+                   refFrames[i].c_str(), frames[i].c_str());
+    }
+
+    printf("Decoded %zu frames, reference %zu frames, %zu matching\n",
+           frames.size(), refFrames.size(), matching);
+
+    if((refFrames.empty()) || (frames.size() != refFrames.size()) ||
+       (matching != refFrames.size()))
+    {
+        printf("Error: decoded frames differ from reference!\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,360 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17Utils.hpp>
+#include <M17/M17DSP.hpp>
+
+using namespace std;
+
+/**
+ * Compare hard and soft decision decoding of M17 stream frames over a noisy
+ * channel, in terms of payload bit error rate and frame error rate.
+ *
+ * Two baseband sources are used: a synthetic transmission, generated with the
+ * frame encoder and the RRC interpolator, and the recorded test baseband. For
+ * each source and for each SNR value, white gaussian noise is added to the
+ * signal and the result is demodulated once. Each demodulated frame is then
+ * decoded both with the hard and the soft decision Viterbi decoder.
+ *
+ * Demodulated frames are associated to the transmitted ones by minimum
+ * Hamming distance of the raw channel bits, which does not depend on the
+ * decoding method used.
+ */
+
+static constexpr size_t BLOCK_SIZE  = 480;      // Half of an M17 frame at 24kHz
+static constexpr size_t NUM_FRAMES  = 200;      // Synthetic stream frames
+static constexpr float  SYM_GAIN    = 8000.0f;  // Synthetic baseband gain
+
+struct refFrame
+{
+    M17::frame_t   frame;       // Raw channel bits
+    M17::payload_t payload;     // Payload data
+};
+
+struct errorStats
+{
+    size_t frames    = 0;       // Number of stream frames compared
+    size_t bits      = 0;       // Number of payload bits compared
+    size_t hardBitEr = 0;       // Payload bit errors, hard decision
+    size_t softBitEr = 0;       // Payload bit errors, soft decision
+    size_t hardFrmEr = 0;       // Frame errors, hard decision
+    size_t softFrmEr = 0;       // Frame errors, soft decision
+};
+
+default_random_engine rng;
+
+template < size_t N >
+static size_t hammingDistance(const array< uint8_t, N >& a,
+                              const array< uint8_t, N >& b)
+{
+    size_t dist = 0;
+    for(size_t i = 0; i < N; i++)
+        dist += __builtin_popcount(a[i] ^ b[i]);
+
+    return dist;
+}
+
+/**
+ * Generate the 24kHz baseband of a complete transmission: preamble, LSF,
+ * stream frames with random payload and EOT.
+ */
+static vector< int16_t > generateBaseband(vector< refFrame >& reference)
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 255);
+
+    M17::M17FrameEncoder   encoder;
+    M17::M17LinkSetupFrame lsf;
+    vector< int8_t >       symbols;
+    M17::frame_t           frame;
+
+    // 80ms preamble, alternated +3 and -3 symbols
+    for(size_t i = 0; i < 2 * M17::M17_FRAME_SYMBOLS; i += 2)
+    {
+        symbols.push_back(+3);
+        symbols.push_back(-3);
+    }
+
+    auto appendFrame = [&](const M17::frame_t& frame)
+    {
+        for(auto byte : frame)
+        {
+            auto sym = M17::byteToSymbols(byte);
+            symbols.insert(symbols.end(), sym.begin(), sym.end());
+        }
+    };
+
+    lsf.clear();
+    lsf.setSource("IU2KWO");
+    lsf.setDestination("ALL");
+    lsf.updateCrc();
+
+    encoder.reset();
+    encoder.encodeLsf(lsf, frame);
+    appendFrame(frame);
+
+    for(size_t i = 0; i < NUM_FRAMES; i++)
+    {
+        refFrame ref;
+        for(auto& byte : ref.payload)
+            byte = rndValue(rng);
+
+        encoder.encodeStreamFrame(ref.payload, ref.frame, i == (NUM_FRAMES - 1));
+        appendFrame(ref.frame);
+        reference.push_back(ref);
+    }
+
+    encoder.encodeEotFrame(frame);
+    appendFrame(frame);
+
+    // Trailing silence, to flush the demodulator
+    symbols.insert(symbols.end(), 2 * M17::M17_FRAME_SYMBOLS, 0);
+
+    // Interpolate to 48kHz and decimate by two
+    vector< int16_t > baseband;
+    array< float, 10 > chunk;
+    for(auto sym : symbols)
+    {
+        M17::rrc_48k(static_cast< float >(sym) * SYM_GAIN, chunk.data());
+        for(size_t i = 0; i < chunk.size(); i += 2)
+            baseband.push_back(static_cast< int16_t >(chunk[i]));
+    }
+
+    return baseband;
+}
+
+/**
+ * Load the recorded test baseband, decimated to 24kHz.
+ */
+static vector< int16_t > loadBaseband(const char *path)
+{
+    vector< int16_t > baseband;
+
+    FILE *baseband_file = fopen(path, "rb");
+    if(baseband_file == NULL)
+    {
+        perror("Error in reading test baseband");
+        return baseband;
+    }
+
+    int16_t sample[2];
+    while(fread(sample, sizeof(int16_t), 2, baseband_file) == 2)
+        baseband.push_back(sample[0]);
+
+    fclose(baseband_file);
+
+    return baseband;
+}
+
+/**
+ * Add white gaussian noise to a baseband signal.
+ */
+static vector< int16_t > addNoise(const vector< int16_t >& baseband,
+                                  const float snr)
+{
+    double power = 0.0;
+    for(auto s : baseband)
+        power += static_cast< double >(s) * s;
+
+    power /= baseband.size();
+
+    float sigma = sqrt(power / pow(10.0, snr / 10.0));
+    normal_distribution< float > noise(0.0f, sigma);
+
+    vector< int16_t > noisy(baseband.size());
+    for(size_t i = 0; i < baseband.size(); i++)
+    {
+        float s = static_cast< float >(baseband[i]) + noise(rng);
+        if(s >  32767.0f) s =  32767.0f;
+        if(s < -32768.0f) s = -32768.0f;
+        noisy[i] = static_cast< int16_t >(s);
+    }
+
+    return noisy;
+}
+
+/**
+ * Demodulate a baseband signal, decode it with both the hard and soft decision
+ * decoders and accumulate the error statistics against the reference frames.
+ * When the reference is empty, it is filled with the stream frames decoded.
+ */
+static errorStats compareDecoders(vector< int16_t > baseband,
+                                  vector< refFrame >& reference)
+{
+    M17::M17Demodulator  demodulator;
+    M17::M17FrameDecoder hardDecoder;
+    M17::M17FrameDecoder softDecoder;
+    errorStats           stats;
+
+    bool fillRef = reference.empty();
+    demodulator.init();
+
+    for(size_t pos = 0; pos + BLOCK_SIZE <= baseband.size(); pos += BLOCK_SIZE)
+    {
+        dataBlock_t block = { &baseband[pos], BLOCK_SIZE };
+        if(demodulator.update(block) == false)
+            continue;
+
+        auto& soft     = demodulator.getSoftFrame();
+        auto& frame    = demodulator.getFrame();
+        auto  hardType = hardDecoder.decodeFrame(frame);
+        auto  softType = softDecoder.decodeFrame(frame, soft);
+
+        if((hardType != M17::M17FrameType::STREAM) ||
+           (softType != M17::M17FrameType::STREAM))
+            continue;
+
+        M17::M17StreamFrame hardFrame = hardDecoder.getStreamFrame();
+        M17::M17StreamFrame softFrame = softDecoder.getStreamFrame();
+        M17::payload_t hardPayload    = hardFrame.payload();
+        M17::payload_t softPayload    = softFrame.payload();
+
+        if(fillRef)
+        {
+            reference.push_back({frame, hardPayload});
+            continue;
+        }
+
+        // Find the transmitted frame closest to the received one
+        size_t minDist = frame.size() * 8;
+        size_t index   = 0;
+        for(size_t i = 0; i < reference.size(); i++)
+        {
+            size_t dist = hammingDistance(frame, reference[i].frame);
+            if(dist < minDist)
+            {
+                minDist = dist;
+                index   = i;
+            }
+        }
+
+        size_t hardErrs = hammingDistance(hardPayload, reference[index].payload);
+        size_t softErrs = hammingDistance(softPayload, reference[index].payload);
+
+        stats.frames    += 1;
+        stats.bits      += hardPayload.size() * 8;
+        stats.hardBitEr += hardErrs;
+        stats.softBitEr += softErrs;
+        stats.hardFrmEr += (hardErrs != 0) ? 1 : 0;
+        stats.softFrmEr += (softErrs != 0) ? 1 : 0;
+    }
+
+    demodulator.terminate();
+
+    return stats;
+}
+
+/**
+ * Run an SNR sweep over a baseband signal, returns false if soft decision
+ * decoding performs worse than hard decision decoding.
+ */
+static bool snrSweep(const char *name, const vector< int16_t >& baseband,
+                     vector< refFrame >& reference, const float *snrs,
+                     const size_t numSnrs)
+{
+    size_t totHardBits   = 0;
+    size_t totSoftBits   = 0;
+    size_t totHardFrames = 0;
+    size_t totSoftFrames = 0;
+
+    printf("%s baseband, %zu reference frames\n", name, reference.size());
+    printf("  SNR [dB] | frames |  hard BER  |  soft BER  | hard FER | soft FER\n");
+
+    for(size_t i = 0; i < numSnrs; i++)
+    {
+        auto noisy = addNoise(baseband, snrs[i]);
+        auto stats = compareDecoders(noisy, reference);
+
+        if(stats.frames == 0)
+        {
+            printf("  %8.1f |      0 |          - |          - |        - |        -\n",
+                   snrs[i]);
+            continue;
+        }
+
+        printf("  %8.1f | %6zu | %10.2e | %10.2e | %8.3f | %8.3f\n", snrs[i],
+               stats.frames,
+               static_cast< double >(stats.hardBitEr) / stats.bits,
+               static_cast< double >(stats.softBitEr) / stats.bits,
+               static_cast< double >(stats.hardFrmEr) / stats.frames,
+               static_cast< double >(stats.softFrmEr) / stats.frames);
+
+        totHardBits   += stats.hardBitEr;
+        totSoftBits   += stats.softBitEr;
+        totHardFrames += stats.hardFrmEr;
+        totSoftFrames += stats.softFrmEr;
+    }
+
+    if((totSoftBits > totHardBits) || (totSoftFrames > totHardFrames))
+    {
+        printf("Error: soft decision decoding worse than hard decision!\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    static constexpr float snrs[] = { 12.0f, 10.0f, 8.0f, 6.0f, 5.0f, 4.0f };
+    static constexpr size_t numSnrs = sizeof(snrs) / sizeof(snrs[0]);
+
+    bool ok = true;
+
+    // Synthetic baseband, reference is the transmitted data
+    vector< refFrame > synthRef;
+    auto synthetic = generateBaseband(synthRef);
+
+    // Sanity check: without noise all the frames have to be decoded correctly
+    auto clean = compareDecoders(synthetic, synthRef);
+    if((clean.frames < NUM_FRAMES - 1) || (clean.hardBitEr != 0) ||
+       (clean.softBitEr != 0))
+    {
+        printf("Error: decoding of clean synthetic baseband failed!\n");
+        return -1;
+    }
+
+    ok &= snrSweep("Synthetic", synthetic, synthRef, snrs, numSnrs);
+
+    // Recorded baseband, reference is the decoding of the clean signal
+    if(argc > 1)
+    {
+        vector< refFrame > recordedRef;
+        auto recorded = loadBaseband(argv[1]);
+        compareDecoders(recorded, recordedRef);
+
+        if(recordedRef.empty())
+        {
+            printf("Error: decoding of recorded baseband failed!\n");
+            return -1;
+        }
+
+        ok &= snrSweep("Recorded", recorded, recordedRef, snrs, numSnrs);
+    }
+
+    return ok ? 0 : -1;
+}
@@ -29,6 +29,7 @@
 #include "M17/M17Utils.hpp"
 
 using namespace std;
+using namespace M17;
 
 default_random_engine rng;
 
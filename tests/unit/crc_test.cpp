@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <crc.h>
+
+using namespace std;
+
+default_random_engine rng;
+
+/**
+ * Previous bytewise implementation of the CCITT CRC.
+ */
+static uint16_t refCcitt(const void *data, const size_t len)
+{
+    uint16_t x   = 0;
+    uint16_t crc = 0;
+    const uint8_t *buf = ((const uint8_t *) data);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        x   = (crc >> 8) ^ buf[i];
+        x  ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+/**
+ * Previous bitwise implementation of the M17 CRC.
+ */
+static uint16_t refM17(const void *data, const size_t len)
+{
+    const uint8_t *ptr = reinterpret_cast< const uint8_t *>(data);
+    uint16_t crc = 0xFFFF;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= (ptr[i] << 8);
+
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            if(crc & 0x8000)
+                crc = (crc << 1) ^ 0x5935;
+            else
+                crc = (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+int main()
+{
+    // Check values, from the CRC catalogue and the M17 specification
+    const char *check = "123456789";
+    if(crc_ccitt(check, 9) != 0x31C3)
+    {
+        printf("Wrong CCITT check value: %04x\n", crc_ccitt(check, 9));
+        return -1;
+    }
+
+    if((crc_m17("", 0) != 0xFFFF) || (crc_m17("A", 1) != 0x206E) ||
+       (crc_m17(check, 9) != 0x772B))
+    {
+        printf("Wrong M17 check values\n");
+        return -1;
+    }
+
+    // Random blocks of any length and alignment, computed in one go and
+    // incrementally in random chunks.
+    uniform_int_distribution< uint16_t > rndByte(0, 255);
+    uniform_int_distribution< size_t >   rndLen(0, 2048);
+    uniform_int_distribution< size_t >   rndOffset(0, 7);
+    vector< uint8_t > buffer(2048 + 8);
+
+    for(size_t i = 0; i < 2000; i++)
+    {
+        for(auto& byte : buffer)
+            byte = rndByte(rng);
+
+        size_t len    = rndLen(rng);
+        size_t offset = rndOffset(rng);
+        uint8_t *data = buffer.data() + offset;
+
+        uint16_t ccitt = crc_ccitt(data, len);
+        uint16_t m17   = crc_m17(data, len);
+
+        if((ccitt != refCcitt(data, len)) || (m17 != refM17(data, len)))
+        {
+            printf("CRC mismatch, length %zu, offset %zu\n", len, offset);
+            return -1;
+        }
+
+        uint16_t ccittInc = CRC_CCITT_INIT;
+        uint16_t m17Inc   = CRC_M17_INIT;
+        size_t   pos      = 0;
+        while(pos < len)
+        {
+            uniform_int_distribution< size_t > rndChunk(1, len - pos);
+            size_t chunk = rndChunk(rng);
+            ccittInc = crc_ccitt_update(ccittInc, data + pos, chunk);
+            m17Inc   = crc_m17_update(m17Inc, data + pos, chunk);
+            pos     += chunk;
+        }
+
+        if((ccittInc != ccitt) || (m17Inc != m17))
+        {
+            printf("Incremental CRC mismatch, length %zu\n", len);
+            return -1;
+        }
+    }
+
+    return 0;
+}
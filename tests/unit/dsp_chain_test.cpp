@@ -0,0 +1,194 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <dsp_chain.hpp>
+#include <data_conversion.h>
+#include <M17/M17DSP.hpp>
+
+using namespace std;
+using namespace M17;
+
+/**
+ * Check that the fused processing chains give the same output of the block
+ * processing functions run one after the other, over several blocks.
+ */
+
+static constexpr size_t NUM_BLOCKS = 50;
+static constexpr size_t BLOCK_SIZE = 480;
+
+default_random_engine rng;
+
+static vector< int16_t > randomBlock()
+{
+    normal_distribution< float > noise(1000.0f, 6000.0f);
+    vector< int16_t > block(BLOCK_SIZE);
+    for(auto& s : block)
+    {
+        float val = noise(rng);
+        if(val > 32767.0f)  val = 32767.0f;
+        if(val < -32768.0f) val = -32768.0f;
+        s = static_cast< int16_t >(val);
+    }
+
+    return block;
+}
+
+static bool testMicChain()
+{
+    DspChain< DspGain, DspDcRemoval, DspGain > chain{DspGain(8), DspDcRemoval(),
+                                                     DspGain(4)};
+    filter_state_t state;
+    dsp_resetFilterState(&state);
+
+    for(size_t b = 0; b < NUM_BLOCKS; b++)
+    {
+        auto ref = randomBlock();
+        auto out = ref;
+
+        for(auto& s : ref) s *= 8;
+        dsp_dcRemoval(&state, ref.data(), ref.size());
+        for(auto& s : ref) s *= 4;
+
+        dataBlock_t block = { out.data(), out.size() };
+        chain.process(block);
+
+        if(out != ref) return false;
+    }
+
+    #ifdef DSP_CHAIN_STAGE_PROFILING
+    for(size_t i = 0; i < 3; i++)
+    {
+        if(chain.getStageStats(i).count != NUM_BLOCKS)
+            return false;
+    }
+    #endif
+
+    return chain.getStats().count == NUM_BLOCKS;
+}
+
+static bool testRxChain(const bool invert)
+{
+    DspChain< DspDcRemoval, DspFir< rrc_taps_24k.size() > >
+        chain{DspDcRemoval(), DspFir< rrc_taps_24k.size() >(rrc_taps_24k)};
+    Fir< rrc_taps_24k.size() > rrc(rrc_taps_24k);
+    filter_state_t state;
+    dsp_resetFilterState(&state);
+    chain.stage< 1 >().setInvert(invert);
+
+    for(size_t b = 0; b < NUM_BLOCKS; b++)
+    {
+        auto in  = randomBlock();
+        auto ref = in;
+        vector< int16_t > out(in.size());
+
+        dsp_dcRemoval(&state, ref.data(), ref.size());
+        rrc(ref.data(), ref.data(), ref.size(), invert ? -1.0f : 1.0f);
+        chain.process(in.data(), out.data(), in.size());
+
+        if(out != ref) return false;
+    }
+
+    return true;
+}
+
+static bool testRxChainFixed(const bool invert)
+{
+    DspChain< DspDcRemovalFixed, DspFirQ15< rrc_taps_24k_q15.size() > >
+        chain{DspDcRemovalFixed(), DspFirQ15< rrc_taps_24k_q15.size() >(rrc_taps_24k_q15)};
+    FirQ15< rrc_taps_24k_q15.size() > rrc(rrc_taps_24k_q15);
+    fixed_filter_state_t state;
+    dsp_resetFixedFilterState(&state);
+    chain.stage< 1 >().setInvert(invert);
+
+    for(size_t b = 0; b < NUM_BLOCKS; b++)
+    {
+        auto in  = randomBlock();
+        auto ref = in;
+        vector< int16_t > out(in.size());
+
+        dsp_dcRemovalFixed(&state, ref.data(), ref.size());
+        rrc(ref.data(), ref.data(), ref.size(), invert);
+        chain.process(in.data(), out.data(), in.size());
+
+        if(out != ref) return false;
+    }
+
+    return true;
+}
+
+static bool testConversions()
+{
+    DspChain< DspInvert, DspS16toU12 > toU12{DspInvert(), DspS16toU12()};
+    DspChain< DspS16toU8 >             toU8{DspS16toU8()};
+
+    auto ref12 = randomBlock();
+    ref12[0]   = INT16_MIN;
+    auto ref8  = ref12;
+    auto out12 = ref12;
+    auto out8  = ref12;
+
+    dsp_invertPhase(ref12.data(), ref12.size());
+    ref12[0] = INT16_MAX;   // DspInvert saturates
+    S16toU12(ref12.data(), ref12.size());
+    S16toU8(ref8.data(), ref8.size());
+
+    toU12.process(out12.data(), out12.data(), out12.size());
+    toU8.process(out8.data(), out8.data(), out8.size());
+
+    return (out12 == ref12) && (out8 == ref8);
+}
+
+int main()
+{
+    if(testMicChain() == false)
+    {
+        printf("Gain and DC removal chain mismatch\n");
+        return -1;
+    }
+
+    for(bool invert : {false, true})
+    {
+        if(testRxChain(invert) == false)
+        {
+            printf("DC removal and RRC chain mismatch, invert %d\n", invert);
+            return -1;
+        }
+
+        if(testRxChainFixed(invert) == false)
+        {
+            printf("Fixed point DC removal and RRC chain mismatch, invert %d\n",
+                   invert);
+            return -1;
+        }
+    }
+
+    if(testConversions() == false)
+    {
+        printf("Sample conversion mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
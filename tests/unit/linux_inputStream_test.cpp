@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "interfaces/audio_stream.h"
+#include "inputStream_linux.h"
 
 static const char* files[] = {"MIC.raw", "RTX.raw", "MCU.raw"};
 
@@ -183,6 +184,66 @@ void test_ring_buffer(uint64_t n_bytes,
     }
 }
 
+void test_time_scale(const float scale, const uint64_t n_iter,
+                     const uint64_t buf_size)
+{
+    const uint64_t n_bytes = 1234;
+
+    FILE* fp = fopen(files[0], "wb");
+    CHECK(fp);
+    for (uint64_t i = 0; i < n_bytes; i++)
+    {
+        uint16_t j = i;
+        CHECK(fwrite(&j, sizeof(j), 1, fp) == 1);
+    }
+    fclose(fp);
+
+    inputStream_setTimeScale(scale);
+    CHECK(inputStream_getTimeScale() == scale);
+
+    std::vector<stream_sample_t> tmp(buf_size);
+    auto id = inputStream_start(SOURCE_MIC, AudioPriority::PRIO_BEEP,
+                                tmp.data(), tmp.size(),
+                                BufMode::BUF_CIRC_DOUBLE, 44100);
+    CHECK(id != -1);
+
+    using namespace std::chrono;
+    auto t0 = steady_clock::now();
+
+    // Data must be contiguous, without any slice being skipped
+    uint64_t ctr = 0;
+    for (uint64_t i = 0; i < 2 * n_iter; i++)
+    {
+        auto db = inputStream_getData(id);
+        CHECK(db.len == buf_size / 2);
+        for (uint64_t k = 0; k < db.len; k++)
+        {
+            CHECK(uint16_t(db.data[k]) == uint16_t(ctr % n_bytes));
+            ctr++;
+        }
+    }
+
+    auto t2                 = steady_clock::now();
+    const uint64_t delta    = duration_cast<microseconds>(t2 - t0).count();
+    const uint64_t realTime = (buf_size * n_iter * 1000000lu / 44100);
+
+    if (scale > 0.0f)
+    {
+        const uint64_t expected = realTime / scale;
+        CHECK(delta > expected && delta < expected * 2);
+    }
+    else
+    {
+        // As fast as the consumer, far quicker than real time
+        CHECK(delta < realTime / 10);
+    }
+
+    inputStream_stop(id);
+    CHECK(remove(files[0]) == 0);
+
+    inputStream_setTimeScale(1.0f);
+}
+
 int main()
 {
     test_linear();
@@ -190,5 +251,7 @@ int main()
     test_ring_buffer(128, 10, 256);
     test_ring_buffer(256, 10, 128);
     test_ring_buffer(1234, 10, 768);
+    test_time_scale(4.0f, 40, 768);
+    test_time_scale(0.0f, 2000, 768);
     return 0;
 }
@@ -0,0 +1,160 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <profiling.h>
+
+/**
+ * Statistics and histogram bins of known durations.
+ */
+static bool testStats()
+{
+    const uint32_t tpu = profiling_ticksPerUs();
+
+    // 1us, 5us, 20us, 100ms: bins 0, 1, 2 and the last one
+    profiling_record(PROF_RTX_TASK, 1 * tpu);
+    profiling_record(PROF_RTX_TASK, 5 * tpu);
+    profiling_record(PROF_RTX_TASK, 20 * tpu);
+    profiling_record(PROF_RTX_TASK, 100000 * tpu);
+
+    profStats_t stats;
+    if(profiling_getStats(PROF_RTX_TASK, &stats) == false)
+        return false;
+
+    const cycleStats_t& time = stats.time;
+    if((time.count != 4) || (time.min != tpu) || (time.max != 100000 * tpu) ||
+       (time.total != 100026ULL * tpu) || (time.last != 100000 * tpu))
+    {
+        printf("Error: wrong statistics\n");
+        return false;
+    }
+
+    const uint32_t expected[PROFILING_HIST_BINS] = {1, 1, 1, 0, 0, 0, 0, 1};
+    for(size_t i = 0; i < PROFILING_HIST_BINS; i++)
+    {
+        if(stats.hist[i] != expected[i])
+        {
+            printf("Error: wrong histogram bin %zu: %u\n", i, stats.hist[i]);
+            return false;
+        }
+    }
+
+    // Other probes are not affected
+    profiling_getStats(PROF_STATE_TASK, &stats);
+    if(stats.time.count != 0)
+        return false;
+
+    return profiling_getStats(PROF_NUM_PROBES, &stats) == false;
+}
+
+/**
+ * Statistics are cleared after a reset, both for the readers and for the
+ * following measures.
+ */
+static bool testReset()
+{
+    profiling_reset();
+
+    profStats_t stats;
+    profiling_getStats(PROF_RTX_TASK, &stats);
+    if(stats.time.count != 0)
+        return false;
+
+    profiling_record(PROF_RTX_TASK, 7);
+    profiling_getStats(PROF_RTX_TASK, &stats);
+
+    return (stats.time.count == 1) && (stats.time.min == 7) &&
+           (stats.time.max == 7) && (stats.time.total == 7);
+}
+
+/**
+ * Scoped probe.
+ */
+static bool testScope()
+{
+    {
+        PROFILE_SCOPE(PROF_M17_DEMOD);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    profStats_t stats;
+    profiling_getStats(PROF_M17_DEMOD, &stats);
+
+    return (stats.time.count == 1) &&
+           (stats.time.last >= 2000 * profiling_ticksPerUs());
+}
+
+/**
+ * A reader running concurrently with the updates always gets a consistent
+ * copy of the statistics.
+ */
+static bool testConcurrentRead()
+{
+    std::atomic< bool > done(false);
+    std::thread writer([&done]
+    {
+        for(uint32_t i = 0; i < 1000000; i++)
+            profiling_record(PROF_GFX_RENDER, i & 0xFFFF);
+
+        done = true;
+    });
+
+    bool ok = true;
+    while((done == false) && ok)
+    {
+        profStats_t stats;
+        profiling_getStats(PROF_GFX_RENDER, &stats);
+
+        uint32_t sum = 0;
+        for(size_t i = 0; i < PROFILING_HIST_BINS; i++)
+            sum += stats.hist[i];
+
+        if(sum != stats.time.count)
+        {
+            printf("Error: inconsistent statistics\n");
+            ok = false;
+        }
+    }
+
+    writer.join();
+    return ok;
+}
+
+int main()
+{
+    profiling_init();
+
+    if(testStats() == false)
+        return -1;
+
+    if(testReset() == false)
+        return -1;
+
+    if(testScope() == false)
+        return -1;
+
+    if(testConcurrentRead() == false)
+        return -1;
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <ringbuf.hpp>
+
+using namespace std;
+
+static constexpr size_t NUM_ELEMENTS = 1000000;
+
+/**
+ * Transfer a sequence of numbers between two threads, with the given batch
+ * sizes on the two sides, and check that it is received in order.
+ */
+static bool transfer(const size_t pushBatch, const size_t popBatch,
+                     const bool blocking)
+{
+    static SPSCRingBuffer< uint32_t, 61 > buf;
+    bool ok = true;
+
+    thread producer([&]
+    {
+        vector< uint32_t > batch(pushBatch);
+        uint32_t next = 0;
+        while(next < NUM_ELEMENTS)
+        {
+            size_t num = 0;
+            while((num < pushBatch) && (next + num < NUM_ELEMENTS))
+            {
+                batch[num] = next + num;
+                num++;
+            }
+
+            size_t pushed = buf.pushN(batch.data(), num, blocking);
+            if(blocking && (pushed != num)) ok = false;
+            if(pushed == 0) this_thread::yield();
+            next += pushed;
+        }
+    });
+
+    vector< uint32_t > batch(popBatch);
+    uint32_t expected = 0;
+    while(expected < NUM_ELEMENTS)
+    {
+        size_t num = buf.popN(batch.data(), popBatch, blocking);
+        if(blocking && (num == 0)) ok = false;
+        if(num == 0) this_thread::yield();
+
+        for(size_t i = 0; i < num; i++)
+        {
+            if(batch[i] != expected++) ok = false;
+        }
+    }
+
+    producer.join();
+
+    return ok && buf.empty();
+}
+
+int main()
+{
+    SPSCRingBuffer< int, 4 > buf;
+    int elem;
+
+    // Single thread behaviour, same as RingBuffer
+    if((buf.empty() == false) || (buf.pop(elem, false) == true))
+    {
+        printf("Empty buffer check failed\n");
+        return -1;
+    }
+
+    for(int i = 0; i < 4; i++)
+        buf.push(i, false);
+
+    if((buf.full() == false) || (buf.push(4, false) == true) || (buf.size() != 4))
+    {
+        printf("Full buffer check failed\n");
+        return -1;
+    }
+
+    buf.eraseElement();
+    buf.push(4, false);
+    for(int i = 1; i <= 4; i++)
+    {
+        if((buf.pop(elem, false) == false) || (elem != i))
+        {
+            printf("Wrong element order\n");
+            return -1;
+        }
+    }
+
+    int batch[6] = {0, 1, 2, 3, 4, 5};
+    if((buf.pushN(batch, 6, false) != 4) || (buf.popN(batch, 6, false) != 4) ||
+       (batch[3] != 3) || (buf.empty() == false))
+    {
+        printf("Batch transfer check failed\n");
+        return -1;
+    }
+
+    // Concurrent transfers, with the index wrapping at different positions
+    const size_t sizes[][2] = {{1, 1}, {1, 16}, {16, 1}, {7, 13}, {61, 61}};
+    for(auto& s : sizes)
+    {
+        for(bool blocking : {false, true})
+        {
+            if(transfer(s[0], s[1], blocking) == false)
+            {
+                printf("Concurrent transfer failed, push %zu, pop %zu, %s\n",
+                       s[0], s[1], blocking ? "blocking" : "non blocking");
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+#include <rtx.h>
+
+#define CHECK(x)                                \
+    do                                          \
+    {                                           \
+        if (!(x))                               \
+        {                                       \
+            printf("Failed assertion: %s, line %d\n", #x, __LINE__); \
+            abort();                            \
+        }                                       \
+    } while (0)
+
+using namespace std;
+
+static rtxStatus_t         rtxCfg;
+static atomic< bool >      running(true);
+static atomic< unsigned >  iterations(0);
+
+static void *rtxThread(void *arg)
+{
+    (void) arg;
+
+    while(running)
+    {
+        rtx_task();
+        iterations++;
+    }
+
+    rtx_terminate();
+
+    return NULL;
+}
+
+/**
+ * Wait until the RTX task has completed more than the given number of
+ * iterations, with a timeout.
+ */
+static bool waitIterations(const unsigned count)
+{
+    for(int i = 0; i < 1000; i++)
+    {
+        if(iterations > count)
+            return true;
+
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    return false;
+}
+
+/**
+ * Check that the RTX task stays idle for some time.
+ */
+static bool isIdle()
+{
+    unsigned count = iterations;
+    this_thread::sleep_for(chrono::milliseconds(100));
+
+    return iterations == count;
+}
+
+static void configure(const uint8_t opMode)
+{
+    rtxCfg.opMode      = opMode;
+    rtxCfg.rxFrequency = 430000000;
+    rtxCfg.txFrequency = 430000000;
+    rtxCfg.sqlLevel    = 15;
+
+    rtx_configure(&rtxCfg);
+}
+
+/**
+ * Publish a configuration whose fields are all derived from the same value,
+ * to detect a configuration mixing two different ones.
+ */
+static void configureChannel(const uint32_t channel)
+{
+    rtxStatus_t cfg;
+    memset(&cfg, 0x00, sizeof(cfg));
+
+    cfg.opMode      = OPMODE_NONE;
+    cfg.rxFrequency = 430000000 + (channel * 12500);
+    cfg.txFrequency = 435000000 + (channel * 12500);
+    cfg.txPower     = static_cast< float >(channel);
+    cfg.sqlLevel    = channel & 0x0F;
+    cfg.txTone      = channel & 0x7FFF;
+    snprintf(cfg.source_address, sizeof(cfg.source_address), "%u", channel);
+
+    rtx_configure(&cfg);
+}
+
+static bool isChannel(const rtxStatus_t& status, const uint32_t channel)
+{
+    char addr[10];
+    snprintf(addr, sizeof(addr), "%u", channel);
+
+    return (status.rxFrequency == 430000000 + (channel * 12500)) &&
+           (status.txFrequency == 435000000 + (channel * 12500)) &&
+           (status.txPower     == static_cast< float >(channel)) &&
+           (status.sqlLevel    == (channel & 0x0F))              &&
+           (status.txTone      == (channel & 0x7FFF))            &&
+           (strcmp(status.source_address, addr) == 0);
+}
+
+int main()
+{
+    // The Linux input streams read the baseband from <source>.raw files in
+    // the working directory, which other tests create: run in an empty one,
+    // so that no baseband is ever available.
+    char workDir[] = "/tmp/rtx_events_test_XXXXXX";
+    CHECK(mkdtemp(workDir) != NULL);
+    CHECK(chdir(workDir) == 0);
+
+    memset(&rtxCfg, 0x00, sizeof(rtxCfg));
+    rtx_init();
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, rtxThread, NULL);
+
+    // Without any opMode the RTX task only waits for a new configuration
+    CHECK(isIdle());
+    configure(OPMODE_NONE);
+    CHECK(waitIterations(0));
+    CHECK(isIdle());
+    CHECK(iterations == 1);
+    rtx_notify(RTX_EVT_TICK | RTX_EVT_PTT | RTX_EVT_CODEC);
+    CHECK(isIdle());
+
+    // FM mode: enters RX and then runs at each timer event, ignoring the
+    // events it does not wait for
+    configure(OPMODE_FM);
+    CHECK(waitIterations(1));
+    CHECK(isIdle());
+    CHECK(rtx_getCurrentStatus().opStatus == RX);
+
+    for(int i = 0; i < 10; i++)
+    {
+        unsigned count = iterations;
+        rtx_notify(RTX_EVT_TICK);
+        CHECK(waitIterations(count));
+    }
+
+    CHECK(isIdle());
+    rtx_notify(RTX_EVT_CODEC);
+    CHECK(isIdle());
+
+    // The timer events generated by the periodic task keep the RTX task
+    // running at the timer rate
+    unsigned count = iterations;
+    for(int i = 0; i < (10 * RTX_TICK_PERIOD / 5); i++)
+    {
+        rtx_eventTask();
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+
+    unsigned ticks = iterations - count;
+    CHECK((ticks >= 8) && (ticks <= 12));
+
+    // M17 mode: once reception has started the RTX task sleeps until a block
+    // of baseband samples is ready, no baseband is available here
+    configure(OPMODE_M17);
+    CHECK(waitIterations(count + ticks));
+    CHECK(isIdle());
+    CHECK(rtx_getCurrentStatus().opStatus == RX);
+    rtx_notify(RTX_EVT_TICK | RTX_EVT_CODEC);
+    CHECK(isIdle());
+
+    count = iterations;
+    rtx_notify(RTX_EVT_BASEBAND);
+    CHECK(waitIterations(count));
+    CHECK(isIdle());
+
+    // Back to idle
+    count = iterations;
+    configure(OPMODE_NONE);
+    CHECK(waitIterations(count));
+    CHECK(isIdle());
+
+    // Configurations published concurrently by two threads, while the RTX
+    // task applies them: at the end the latest one is in use
+    std::thread writers[2];
+    for(uint32_t i = 0; i < 2; i++)
+    {
+        writers[i] = std::thread([i]
+        {
+            for(uint32_t j = 0; j < 5000; j++)
+                configureChannel((2 * j) + i);
+        });
+    }
+
+    for(auto& w : writers)
+        w.join();
+
+    count = iterations;
+    configureChannel(12345);
+    CHECK(waitIterations(count));
+    CHECK(isIdle());
+    CHECK(isChannel(rtx_getCurrentStatus(), 12345));
+
+    // Publishing the configuration in use wakes up the RTX task, which
+    // finds nothing to change
+    count = iterations;
+    configureChannel(12345);
+    CHECK(waitIterations(count));
+    CHECK(isIdle());
+    CHECK(isChannel(rtx_getCurrentStatus(), 12345));
+
+    // Terminate
+
+    running = false;
+    rtx_notify(RTX_EVT_CONFIG);
+    pthread_join(thread, NULL);
+
+    rmdir(workDir);
+
+    return 0;
+}
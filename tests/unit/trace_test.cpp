@@ -0,0 +1,238 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <trace.h>
+
+using namespace std;
+
+static constexpr size_t NUM_THREADS = 3;
+
+/**
+ * Dump the trace to memory, returning the records.
+ */
+static vector< traceRecord_t > dump(traceHeader_t& header)
+{
+    vector< uint8_t > data;
+
+    trace_dump([](const void *buf, const size_t len, void *arg)
+    {
+        auto *vec = static_cast< vector< uint8_t > * >(arg);
+        auto *ptr = static_cast< const uint8_t * >(buf);
+        vec->insert(vec->end(), ptr, ptr + len);
+        return true;
+    }, &data);
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    vector< traceRecord_t > records((data.size() - sizeof(header)) / sizeof(traceRecord_t));
+    memcpy(records.data(), data.data() + sizeof(header),
+           records.size() * sizeof(traceRecord_t));
+
+    return records;
+}
+
+/**
+ * Several threads tracing concurrently, writing more records than the size of
+ * the buffers: each buffer must contain the latest records of a single thread,
+ * in order.
+ */
+static bool testConcurrent()
+{
+    static constexpr int32_t NUM_RECORDS = 3 * TRACE_RING_SIZE / 2;
+
+    trace_enable(true);
+
+    // The threads start tracing together, once all of them are running
+    atomic< size_t > started(0);
+    vector< thread > threads;
+    for(size_t i = 0; i < NUM_THREADS; i++)
+    {
+        threads.emplace_back([i, &started]
+        {
+            started++;
+            while(started < NUM_THREADS)
+                this_thread::yield();
+
+            for(int32_t j = 0; j < NUM_RECORDS; j++)
+                TRACE(TRACE_M17_SYMBOL, i, j, -j);
+        });
+    }
+
+    for(auto& t : threads)
+        t.join();
+
+    traceHeader_t header;
+    auto records = dump(header);
+
+    if((header.magic != TRACE_MAGIC) ||
+       (header.recordSize != sizeof(traceRecord_t)) ||
+       (header.numRecords != records.size()) ||
+       (records.size() != NUM_THREADS * (TRACE_RING_SIZE - 1)))
+    {
+        printf("Error: unexpected dump header or size\n");
+        return false;
+    }
+
+    vector< int32_t > next(NUM_THREADS, NUM_RECORDS - TRACE_RING_SIZE + 1);
+    for(auto& r : records)
+    {
+        if((r.event != TRACE_M17_SYMBOL) || (r.arg0 >= (int16_t) NUM_THREADS) ||
+           (r.arg1 != next[r.arg0]) || (r.arg2 != -r.arg1))
+        {
+            printf("Error: bad record %d %d %d\n", r.arg0, r.arg1, r.arg2);
+            return false;
+        }
+
+        next[r.arg0]++;
+    }
+
+    return true;
+}
+
+/**
+ * The buffers of the terminated threads keep their records until the next
+ * clear: once a group of threads using all the buffers has terminated, another
+ * thread can be traced only after tracing has been restarted.
+ */
+static bool testThreadExit()
+{
+    trace_enable(true);
+
+    // All the threads hold their buffer at the same time
+    atomic< size_t > traced(0);
+    vector< thread > threads;
+    for(size_t i = 0; i < TRACE_THREADS; i++)
+    {
+        threads.emplace_back([i, &traced]
+        {
+            TRACE(TRACE_M17_FRAME, i, 0, 0);
+            traced++;
+            while(traced < TRACE_THREADS)
+                this_thread::yield();
+        });
+    }
+
+    for(auto& t : threads)
+        t.join();
+
+    TRACE(TRACE_M17_FRAME, TRACE_THREADS, 0, 0);
+
+    traceHeader_t header;
+    auto records = dump(header);
+
+    if((header.dropped != 1) || (records.size() != TRACE_THREADS))
+    {
+        printf("Error: records of terminated threads overwritten\n");
+        return false;
+    }
+
+    // One record per buffer, each from a different thread
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        if((records[i].thread != i) || (records[i].arg0 == TRACE_THREADS))
+        {
+            printf("Error: unexpected record %d in buffer %d\n",
+                   records[i].arg0, records[i].thread);
+            return false;
+        }
+    }
+
+    trace_enable(true);
+    TRACE(TRACE_M17_FRAME, TRACE_THREADS, 0, 0);
+    records = dump(header);
+
+    if((header.dropped != 0) || (records.size() != 1))
+    {
+        printf("Error: %u records dropped\n", header.dropped);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Tracing stops a given number of records after the trigger event.
+ */
+static bool testTrigger()
+{
+    static constexpr uint32_t POST = 100;
+
+    trace_setTrigger(TRACE_M17_UNLOCK, POST);
+    trace_enable(true);
+
+    for(int32_t i = 0; i < 1000; i++)
+    {
+        TRACE((i == 500) ? TRACE_M17_UNLOCK : TRACE_M17_FRAME, 0, i, 0);
+        if((i == 500) && (trace_isTriggered() == true))
+            return false;
+    }
+
+    if(trace_isTriggered() == false)
+        return false;
+
+    traceHeader_t header;
+    auto records = dump(header);
+    trace_setTrigger(TRACE_NONE, 0);
+
+    if((records.empty() == true) || (records.back().arg1 != 500 + POST) ||
+       (trace_isTriggered() == true))
+    {
+        printf("Error: trigger failed\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Nothing is recorded while tracing is disabled.
+ */
+static bool testDisabled()
+{
+    trace_enable(true);
+    trace_enable(false);
+    TRACE(TRACE_M17_LOCK, 0, 0, 0);
+
+    traceHeader_t header;
+    return dump(header).empty();
+}
+
+int main()
+{
+    if(testConcurrent() == false)
+        return -1;
+
+    if(testThreadExit() == false)
+        return -1;
+
+    if(testTrigger() == false)
+        return -1;
+
+    if(testDisabled() == false)
+        return -1;
+
+    return 0;
+}
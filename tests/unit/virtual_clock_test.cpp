@@ -0,0 +1,277 @@
+/***************************************************************************
+ *   Copyright (C) 2023 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <interfaces/delays.h>
+#include <virtual_clock.h>
+#include <ringbuf.hpp>
+
+#define CHECK(x)                                \
+    do                                          \
+    {                                           \
+        if (!(x))                               \
+        {                                       \
+            puts("Failed assertion: " #x "\n"); \
+            abort();                            \
+        }                                       \
+    } while (0)
+
+using namespace std;
+
+static atomic< size_t > registered;
+
+/**
+ * Start a thread taking part in the virtual clock. The calling thread is
+ * registered too, so that time does not advance until it waits for the
+ * started threads to terminate.
+ */
+template < typename F >
+static thread startThread(F func)
+{
+    vclock_registerThread();
+
+    return thread([func]
+    {
+        vclock_registerThread();
+        registered++;
+        func();
+    });
+}
+
+/**
+ * Wait for the termination of a group of threads, marking the wait so that
+ * the fast forward clock keeps running meanwhile.
+ */
+static void joinAll(vector< thread >& threads)
+{
+    // All the threads have to be registered before the clock can advance
+    while(registered < threads.size())
+        this_thread::yield();
+
+    vclockBlock_t block = {false};
+    vclock_blockBegin(&block);
+    for(auto& t : threads)
+        t.join();
+    vclock_blockEnd(&block);
+
+    registered = 0;
+}
+
+/**
+ * Threads paced as the firmware ones, with getTick() and sleepUntil(): ten
+ * minutes of virtual time have to elapse in much less real time, with each
+ * thread waking up exactly on its deadlines.
+ */
+static void testFastForward()
+{
+    static constexpr long long DURATION = 10 * 60 * 1000;
+
+    vclock_init(VCLOCK_FAST_FORWARD, 1.0f);
+
+    const long long start   = getTick();
+    const long long periods[] = {25, 5, 100};
+    vector< size_t > wakeups(3, 0);
+    vector< bool >   onTime(3, true);
+    vector< thread > threads;
+
+    auto realStart = chrono::steady_clock::now();
+
+    for(size_t i = 0; i < 3; i++)
+    {
+        threads.push_back(startThread([&, i]
+        {
+            long long time = getTick();
+            while((time - start) < DURATION)
+            {
+                time += periods[i];
+                sleepUntil(time);
+
+                if(getTick() != time) onTime[i] = false;
+                wakeups[i]++;
+            }
+        }));
+    }
+
+    joinAll(threads);
+
+    auto realTime = chrono::steady_clock::now() - realStart;
+
+    for(size_t i = 0; i < 3; i++)
+    {
+        CHECK(onTime[i]);
+        CHECK(wakeups[i] == (size_t) (DURATION / periods[i]));
+    }
+
+    CHECK(getTick() == start + DURATION);
+    CHECK(realTime < chrono::seconds(30));
+}
+
+/**
+ * Handoff between a thread sleeping on the clock and one waiting on a
+ * condition variable: time must not advance until the woken thread has
+ * processed the event and waits again.
+ */
+static void testBlockedThreads()
+{
+    static constexpr size_t EVENTS = 1000;
+
+    vclock_init(VCLOCK_FAST_FORWARD, 1.0f);
+
+    mutex              mtx;
+    condition_variable cv;
+    vclockBlock_t      block    = {false};
+    size_t             produced = 0;
+    long long          stamp    = 0;
+    bool               inSync   = true;
+
+    vector< thread > threads;
+
+    threads.push_back(startThread([&]
+    {
+        for(size_t i = 0; i < EVENTS; i++)
+        {
+            sleepFor(0, 20);
+
+            lock_guard< mutex > lock(mtx);
+            produced++;
+            stamp = getTick();
+            vclock_blockEnd(&block);
+            cv.notify_one();
+        }
+    }));
+
+    threads.push_back(startThread([&]
+    {
+        size_t consumed = 0;
+        while(consumed < EVENTS)
+        {
+            unique_lock< mutex > lock(mtx);
+            if(produced == consumed)
+            {
+                vclock_blockBegin(&block);
+                cv.wait(lock, [&] { return produced > consumed; });
+                vclock_blockEnd(&block);
+            }
+
+            consumed++;
+
+            // Each event is seen at the time it has been produced
+            if(getTick() != stamp) inSync = false;
+            lock.unlock();
+
+            // Some processing, taking virtual time
+            delayMs(5);
+        }
+    }));
+
+    joinAll(threads);
+
+    CHECK(inSync);
+    CHECK(produced == EVENTS);
+}
+
+/**
+ * Handoff through the blocking calls of the frame queues, which mark their
+ * waits: the consumer sleeps on the queue while the producer sleeps on the
+ * clock, and each element is received at the time it has been sent.
+ */
+static void testQueueHandoff()
+{
+    static constexpr size_t ELEMENTS = 500;
+
+    vclock_init(VCLOCK_FAST_FORWARD, 1.0f);
+
+    SPSCRingBuffer< long long, 4 > spsc;
+    RingBuffer< long long, 4 >     locked;
+    bool inSync = true;
+
+    vector< thread > threads;
+
+    threads.push_back(startThread([&]
+    {
+        for(size_t i = 0; i < ELEMENTS; i++)
+        {
+            sleepFor(0, 20);
+            spsc.push(getTick(), true);
+            locked.push(getTick(), true);
+        }
+    }));
+
+    threads.push_back(startThread([&]
+    {
+        for(size_t i = 0; i < ELEMENTS; i++)
+        {
+            long long a, b;
+            spsc.pop(a, true);
+            locked.pop(b, true);
+            if((getTick() != a) || (getTick() != b)) inSync = false;
+        }
+    }));
+
+    joinAll(threads);
+
+    CHECK(inSync);
+}
+
+/**
+ * Real time mode, with virtual time running ten times faster.
+ */
+static void testScaledRealTime()
+{
+    vclock_init(VCLOCK_REALTIME, 10.0f);
+    CHECK(vclock_isWallClock() == false);
+
+    auto realStart     = chrono::steady_clock::now();
+    long long start    = getTick();
+    sleepUntil(start + 2000);
+    auto realTime      = chrono::steady_clock::now() - realStart;
+
+    CHECK(getTick() >= start + 2000);
+    CHECK(realTime >= chrono::milliseconds(190));
+    CHECK(realTime <  chrono::milliseconds(400));
+
+    // Speed change, virtual time keeps running from where it was
+    long long before = getTick();
+    vclock_setScale(1.0f);
+    CHECK(vclock_getScale() == 1.0f);
+    CHECK(vclock_isWallClock());
+    CHECK(getTick() >= before);
+    CHECK(getTick() <  before + 100);
+
+    vclock_init(VCLOCK_REALTIME, 1.0f);
+    CHECK(vclock_isWallClock());
+}
+
+int main()
+{
+    testScaledRealTime();
+    testFastForward();
+    testBlockedThreads();
+    testQueueHandoff();
+
+    return 0;
+}